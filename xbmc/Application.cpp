@@ -3615,10 +3615,14 @@ bool CApplication::Cleanup()
 
 void CApplication::Stop(int exitCode)
 {
+  // we may exit without closing the log, so write everything logged from now on right away
+  CLog::StopWriter();
+
   try
   {
     CVariant vExitCode(exitCode);
     CAnnouncementManager::Announce(System, "xbmc", "OnQuit", vExitCode);
+    CAnnouncementManager::Deinitialize();
 
     SaveFileState(true);
 
@@ -5064,6 +5068,21 @@ bool CApplication::OnMessage(CGUIMessage& message)
           CLastfmScrobbler::GetInstance()->AddSong(*tag, CLastFmManager::GetInstance()->IsRadioEnabled());
           CLibrefmScrobbler::GetInstance()->AddSong(*tag, CLastFmManager::GetInstance()->IsRadioEnabled());
         }
+
+        // let the player open the upcoming tracks while this one plays
+        if (m_pPlayer && g_playlistPlayer.GetCurrentPlaylist() != PLAYLIST_NONE)
+        {
+          CFileItemList upcoming;
+          CPlayList& playlist = g_playlistPlayer.GetPlaylist(g_playlistPlayer.GetCurrentPlaylist());
+          for (int i = 1; i <= g_advancedSettings.m_audioPreloadTracks; i++)
+          {
+            int next = g_playlistPlayer.GetNextSong(i);
+            if (next < 0 || next >= playlist.size())
+              break;
+            upcoming.Add(playlist[next]);
+          }
+          m_pPlayer->PreloadFiles(upcoming);
+        }
       }
 
       return true;
@@ -5135,7 +5154,12 @@ bool CApplication::OnMessage(CGUIMessage& message)
         // stop lastfm
         if (CLastFmManager::GetInstance()->IsRadioEnabled())
           CLastFmManager::GetInstance()->StopRadio();
+      }
 
+      // the player keeps codecs and the audio stream open for a next file,
+      // so release it if nothing follows
+      if (message.GetMessage() != GUI_MSG_PLAYBACK_ENDED || !IsPlaying())
+      {
         delete m_pPlayer;
         m_pPlayer = 0;
 
@@ -21,13 +21,101 @@
 #include "BackgroundInfoLoader.h"
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 
+#include <algorithm>
+#include <set>
+
 using namespace std;
 
 #define ITEMS_PER_THREAD 5
 
+struct IsPrioritized
+{
+  IsPrioritized(const set<const CFileItem*> &items) : m_items(items) {}
+  bool operator()(const CFileItemPtr &item) const { return m_items.find(item.get()) != m_items.end(); }
+  const set<const CFileItem*> &m_items;
+};
+
+/*
+ * Shared between a load and its jobs. Once cancelled, jobs that have
+ * not started yet leave without touching the loader, which then only
+ * has to wait for the jobs already running.
+ */
+class CBackgroundLoaderToken
+{
+public:
+  CBackgroundLoaderToken() : m_idle(true, true)
+  {
+    m_cancelled = false;
+    m_running = 0;
+  }
+
+  bool Enter()
+  {
+    CSingleLock lock(m_section);
+    if (m_cancelled)
+      return false;
+    if (m_running++ == 0)
+      m_idle.Reset();
+    return true;
+  }
+
+  void Leave()
+  {
+    CSingleLock lock(m_section);
+    if (--m_running == 0)
+      m_idle.Set();
+  }
+
+  void Cancel()
+  {
+    CSingleLock lock(m_section);
+    m_cancelled = true;
+  }
+
+  void Wait()
+  {
+    m_idle.Wait();
+  }
+
+private:
+  CCriticalSection m_section;
+  CEvent           m_idle;
+  bool             m_cancelled;
+  int              m_running;
+};
+
+class CBackgroundLoaderJob : public CJob
+{
+public:
+  CBackgroundLoaderJob(CBackgroundInfoLoader *loader, const boost::shared_ptr<CBackgroundLoaderToken> &token)
+    : m_loader(loader), m_token(token)
+  {
+  }
+
+  virtual bool DoWork()
+  {
+    if (!m_token->Enter())
+      return false;
+    m_loader->Run();
+    m_token->Leave();
+    return true;
+  }
+
+  virtual const char *GetType() const
+  {
+    return "backgroundinfoloader";
+  }
+
+private:
+  CBackgroundInfoLoader *m_loader;
+  boost::shared_ptr<CBackgroundLoaderToken> m_token;
+};
+
 CBackgroundInfoLoader::CBackgroundInfoLoader(int nThreads)
 {
   m_bStop = true;
@@ -64,6 +152,7 @@ void CBackgroundInfoLoader::Run()
         }
       }
 
+      OnWorkerStart();
       while (!m_bStop)
       {
         CSingleLock lock(m_lock);
@@ -93,11 +182,15 @@ void CBackgroundInfoLoader::Run()
           CLog::Log(LOGERROR, "%s::LoadItem - Unhandled exception for item %s", __FUNCTION__, pItem->GetPath().c_str());
         }
       }
+      OnWorkerFinish();
     }
 
     CSingleLock lock(m_lock);
-    if (m_nActiveThreads == 1)
+    if (m_nActiveThreads == 1 && m_bStartCalled)
+    {
       OnLoaderFinish();
+      m_bStartCalled = false;
+    }
     m_nActiveThreads--;
 
   }
@@ -122,7 +215,6 @@ void CBackgroundInfoLoader::Load(CFileItemList& items)
 
   m_pVecItems = &items;
   m_bStop = false;
-  m_bStartCalled = false;
 
   int nThreads = m_nRequestedThreads;
   if (nThreads == -1)
@@ -131,17 +223,21 @@ void CBackgroundInfoLoader::Load(CFileItemList& items)
   if (nThreads > g_advancedSettings.m_bgInfoLoaderMaxThreads)
     nThreads = g_advancedSettings.m_bgInfoLoaderMaxThreads;
 
+  m_token.reset(new CBackgroundLoaderToken);
   m_nActiveThreads = nThreads;
   for (int i=0; i < nThreads; i++)
-  {
-    CThread *pThread = new CThread(this, "Background Loader");
-    pThread->Create();
-#ifndef _LINUX
-    pThread->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
-#endif
-    m_workers.push_back(pThread);
-  }
+    m_jobs.push_back(CJobManager::GetInstance().AddJob(new CBackgroundLoaderJob(this, m_token), NULL, CJob::PRIORITY_LOW));
+}
 
+void CBackgroundInfoLoader::Prioritize(const CFileItemList& items, int first, int last)
+{
+  set<const CFileItem*> prioritized;
+  for (int i = std::max(first, 0); i <= last && i < items.Size(); i++)
+    prioritized.insert(items[i].get());
+
+  // the remaining items keep their order behind the prioritized ones
+  CSingleLock lock(m_lock);
+  stable_partition(m_vecItems.begin(), m_vecItems.end(), IsPrioritized(prioritized));
 }
 
 void CBackgroundInfoLoader::StopAsync()
@@ -154,13 +250,25 @@ void CBackgroundInfoLoader::StopThread()
 {
   StopAsync();
 
-  for (int i=0; i<(int)m_workers.size(); i++)
+  if (m_token)
   {
-    m_workers[i]->StopThread();
-    delete m_workers[i];
+    // jobs still queued are dropped, running ones finish their item
+    m_token->Cancel();
+    for (vector<unsigned int>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+      CJobManager::GetInstance().CancelJob(*it);
+    m_token->Wait();
+    m_token.reset();
   }
 
-  m_workers.clear();
+  // jobs dropped from the queue never got to finish the load
+  CSingleLock lock(m_lock);
+  if (m_bStartCalled)
+  {
+    OnLoaderFinish();
+    m_bStartCalled = false;
+  }
+
+  m_jobs.clear();
   m_vecItems.clear();
   m_pVecItems = NULL;
   m_nActiveThreads = 0;
@@ -180,4 +288,3 @@ void CBackgroundInfoLoader::SetProgressCallback(IProgressCallback* pCallback)
 {
   m_pProgressCallback = pCallback;
 }
-
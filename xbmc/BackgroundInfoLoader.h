@@ -29,6 +29,7 @@
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
 class CFileItemList;
+class CBackgroundLoaderToken;
 
 class IBackgroundLoaderObserver
 {
@@ -37,6 +38,11 @@ public:
   virtual void OnItemLoaded(CFileItem* pItem) = 0;
 };
 
+/*
+ * Calls LoadItem for the items of a list on the threads of the job manager
+ * rather than threads of its own, so browsing doesn't start and stop
+ * threads for every directory.
+ */
 class CBackgroundInfoLoader : public IRunnable
 {
 public:
@@ -50,6 +56,12 @@ public:
   void SetProgressCallback(IProgressCallback* pCallback);
   virtual bool LoadItem(CFileItem* pItem) { return false; };
 
+  /*
+   * moves the items from first to last of items to the front of the items
+   * still to be loaded, so the items on screen are loaded first
+   */
+  void Prioritize(const CFileItemList& items, int first, int last);
+
   void StopThread(); // will actually stop all worker threads.
   void StopAsync();  // will ask loader to stop as soon as possible, but not block
 
@@ -59,6 +71,11 @@ protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
+  // called on each worker thread before and after it loads items,
+  // to set up state that can't be shared between threads
+  virtual void OnWorkerStart() {};
+  virtual void OnWorkerFinish() {};
+
   CFileItemList *m_pVecItems;
   std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
@@ -71,6 +88,6 @@ protected:
   IBackgroundLoaderObserver* m_pObserver;
   IProgressCallback* m_pProgressCallback;
 
-  std::vector<CThread *> m_workers;
+  boost::shared_ptr<CBackgroundLoaderToken> m_token; // cancels the jobs of the current load
+  std::vector<unsigned int> m_jobs;
 };
-
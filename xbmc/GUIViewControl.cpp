@@ -175,6 +175,18 @@ int CGUIViewControl::GetSelectedItem() const
   return GetSelectedItem(m_visibleViews[m_currentView]);
 }
 
+bool CGUIViewControl::GetVisibleItems(int &first, int &last) const
+{
+  if (!m_fileItems || m_currentView < 0 || m_currentView >= (int)m_visibleViews.size())
+    return false; // no valid current view!
+
+  CGUIBaseContainer *view = (CGUIBaseContainer *)m_visibleViews[m_currentView];
+  view->GetVisibleItems(first, last);
+  if (last >= m_fileItems->Size())
+    last = m_fileItems->Size() - 1;
+  return first <= last;
+}
+
 void CGUIViewControl::SetSelectedItem(int item)
 {
   if (!m_fileItems || item < 0 || item >= m_fileItems->Size())
@@ -43,6 +43,13 @@ public:
   void SetSelectedItem(const CStdString &itemPath);
 
   int GetSelectedItem() const;
+
+  /*! \brief Get the range of items that are on screen in the current view
+   \param first [out] index of the first item on screen
+   \param last [out] index of the last item on screen
+   \return true if any items are on screen, false otherwise
+   */
+  bool GetVisibleItems(int &first, int &last) const;
   void SetFocused();
 
   bool HasControl(int controlID) const;
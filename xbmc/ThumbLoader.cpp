@@ -38,12 +38,23 @@
 #include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "music/infoscanner/MusicInfoScanner.h"
 #include "music/Artist.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/ThreadLocal.h"
+#include "utils/CPUInfo.h"
 
 using namespace XFILE;
 using namespace std;
 using namespace VIDEO;
 using namespace MUSIC_INFO;
 
+#define THUMB_STATS_IDLE     5000 // ms without thumbs before a new batch starts
+#define THUMB_STATS_INTERVAL 25   // thumbs between progress messages
+
+// texture database connection of the loader worker on this thread
+static XbmcThreads::ThreadLocal<CTextureDatabase> g_textureDatabase;
+
 CThumbLoader::CThumbLoader(int nThreads) :
   CBackgroundInfoLoader(nThreads)
 {
@@ -53,8 +64,32 @@ CThumbLoader::~CThumbLoader()
 {
 }
 
+void CThumbLoader::OnWorkerStart()
+{
+  CTextureDatabase *db = new CTextureDatabase;
+  if (db->Open())
+    g_textureDatabase.set(db);
+  else
+    delete db;
+}
+
+void CThumbLoader::OnWorkerFinish()
+{
+  CTextureDatabase *db = g_textureDatabase.get();
+  if (db)
+  {
+    g_textureDatabase.set(NULL);
+    db->Close();
+    delete db;
+  }
+}
+
 CStdString CThumbLoader::GetCachedImage(const CFileItem &item, const CStdString &type)
 {
+  CTextureDatabase *worker = g_textureDatabase.get();
+  if (worker)
+    return worker->GetTextureForPath(item.GetPath(), type);
+
   CTextureDatabase db;
   if (db.Open())
     return db.GetTextureForPath(item.GetPath(), type);
@@ -63,6 +98,13 @@ CStdString CThumbLoader::GetCachedImage(const CFileItem &item, const CStdString
 
 void CThumbLoader::SetCachedImage(const CFileItem &item, const CStdString &type, const CStdString &image)
 {
+  CTextureDatabase *worker = g_textureDatabase.get();
+  if (worker)
+  {
+    worker->SetTextureForPath(item.GetPath(), type, image);
+    return;
+  }
+
   CTextureDatabase db;
   if (db.Open())
     db.SetTextureForPath(item.GetPath(), type, image);
@@ -74,6 +116,9 @@ CThumbExtractor::CThumbExtractor(const CFileItem& item, const CStdString& listpa
   m_target = target;
   m_thumb = thumb;
   m_item = item;
+  m_encode = true;
+  m_picture = NULL;
+  m_decodeTime = 0;
 
   m_path = item.GetPath();
 
@@ -86,6 +131,7 @@ CThumbExtractor::CThumbExtractor(const CFileItem& item, const CStdString& listpa
 
 CThumbExtractor::~CThumbExtractor()
 {
+  delete m_picture;
 }
 
 bool CThumbExtractor::operator==(const CJob* job) const
@@ -99,6 +145,21 @@ bool CThumbExtractor::operator==(const CJob* job) const
   return false;
 }
 
+bool CThumbExtractor::CacheThumb(const CDVDThumbPicture &picture, const CStdString &target, CFileItem &item)
+{
+  // construct the thumb cache file
+  CTextureDetails details;
+  details.file = CTextureCache::GetCacheFile(target) + ".jpg";
+  if (!CDVDFileInfo::CacheThumb(picture, details))
+    return false;
+
+  CTextureCache::Get().AddCachedTexture(target, details);
+  item.SetProperty("HasAutoThumb", true);
+  item.SetProperty("AutoThumbImage", target);
+  item.SetThumbnailImage(CTextureCache::GetCachedPath(details.file));
+  return true;
+}
+
 bool CThumbExtractor::DoWork()
 {
   if (URIUtils::IsLiveTV(m_path)
@@ -119,16 +180,16 @@ bool CThumbExtractor::DoWork()
   if (m_thumb)
   {
     CLog::Log(LOGDEBUG,"%s - trying to extract thumb from video file %s", __FUNCTION__, m_path.c_str());
-    // construct the thumb cache file
-    CTextureDetails details;
-    details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_path, details, &m_item.GetVideoInfoTag()->m_streamDetails);
-    if(result)
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_picture = new CDVDThumbPicture;
+    result = CDVDFileInfo::DecodeThumb(m_path, *m_picture, &m_item.GetVideoInfoTag()->m_streamDetails);
+    m_decodeTime = XbmcThreads::SystemClockMillis() - start;
+    if (!result || m_encode)
     {
-      CTextureCache::Get().AddCachedTexture(m_target, details);
-      m_item.SetProperty("HasAutoThumb", true);
-      m_item.SetProperty("AutoThumbImage", m_target);
-      m_item.SetThumbnailImage(CTextureCache::GetCachedPath(details.file));
+      // a failed decode leaves the empty thumb behind
+      result = CacheThumb(*m_picture, m_target, m_item);
+      delete m_picture;
+      m_picture = NULL;
     }
   }
   else if (m_item.HasVideoInfoTag() && !m_item.GetVideoInfoTag()->HasStreamDetails())
@@ -140,8 +201,52 @@ bool CThumbExtractor::DoWork()
   return result;
 }
 
+CThumbEncoder::CThumbEncoder(CThumbExtractor& extractor)
+{
+  m_target = extractor.m_target;
+  m_listpath = extractor.m_listpath;
+  m_item = extractor.m_item;
+  m_picture = extractor.m_picture;
+  m_decodeTime = extractor.m_decodeTime;
+  m_encodeTime = 0;
+
+  extractor.m_picture = NULL;
+}
+
+CThumbEncoder::~CThumbEncoder()
+{
+  delete m_picture;
+}
+
+bool CThumbEncoder::DoWork()
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  bool result = CThumbExtractor::CacheThumb(*m_picture, m_target, m_item);
+  m_encodeTime = XbmcThreads::SystemClockMillis() - start;
+  return result;
+}
+
+static unsigned int GetThumbExtractThreads()
+{
+  if (g_advancedSettings.m_videoThumbExtractThreads > 0)
+    return g_advancedSettings.m_videoThumbExtractThreads;
+  // the job manager runs at most three low priority jobs, leave one for the encoder
+  return g_cpuInfo.getCPUCount() > 1 ? 2 : 1;
+}
+
+CVideoThumbLoader::CEncodeQueue::CEncodeQueue(CVideoThumbLoader *loader, unsigned int jobsAtOnce) :
+  CJobQueue(false, jobsAtOnce), m_loader(loader)
+{
+}
+
+void CVideoThumbLoader::CEncodeQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  m_loader->OnThumbEncoded(success, (CThumbEncoder*)job);
+  CJobQueue::OnJobComplete(jobID, success, job);
+}
+
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(1), CJobQueue(true), m_pStreamDetailsObs(NULL)
+  CThumbLoader(1), CJobQueue(true, GetThumbExtractThreads()), m_pStreamDetailsObs(NULL), m_encodeQueue(this, 1)
 {
   m_database = new CVideoDatabase();
 }
@@ -149,6 +254,10 @@ CVideoThumbLoader::CVideoThumbLoader() :
 CVideoThumbLoader::~CVideoThumbLoader()
 {
   StopThread();
+  // no more frames for the encoder before it goes away
+  CancelJobs();
+  m_encodeQueue.CancelJobs();
+  CDVDFileInfo::FlushThumbCodecs();
   delete m_database;
 }
 
@@ -165,6 +274,8 @@ void CVideoThumbLoader::OnLoaderStart()
 void CVideoThumbLoader::OnLoaderFinish()
 {
   m_database->Close();
+  // the decoders still in use are kept until the next thumb
+  CDVDFileInfo::FlushThumbCodecs();
 }
 
 static void SetupRarOptions(CFileItem& item, const CStdString& path)
@@ -267,6 +378,7 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
           SetupRarOptions(item,path);
 
         CThumbExtractor* extract = new CThumbExtractor(item, path, true, thumbURL);
+        extract->m_encode = false;
         AddJob(extract);
 
         m_database->Close();
@@ -427,22 +539,70 @@ CStdString CVideoThumbLoader::GetEmbeddedThumbURL(const CFileItem &item)
 
 void CVideoThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
-  if (success)
+  CThumbExtractor* loader = (CThumbExtractor*)job;
+  if (success && loader->m_picture)
+  {
+    // hand the frame over to the encoder, the extractor slot is free for the next file
+    m_encodeQueue.AddJob(new CThumbEncoder(*loader));
+  }
+  else
   {
-    CThumbExtractor* loader = (CThumbExtractor*)job;
-    loader->m_item.SetPath(loader->m_listpath);
-    CVideoInfoTag* info = loader->m_item.GetVideoInfoTag();
-    if (m_pStreamDetailsObs)
-      m_pStreamDetailsObs->OnStreamDetails(info->m_streamDetails, info->m_strFileNameAndPath, info->m_iFileId);
-    if (m_pObserver)
-      m_pObserver->OnItemLoaded(&loader->m_item);
-    CFileItemPtr pItem(new CFileItem(loader->m_item));
-    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
-    g_windowManager.SendThreadMessage(msg);
+    if (loader->m_thumb)
+      UpdateStats(success, loader->m_decodeTime, 0);
+    if (success)
+      UpdateItem(loader->m_item, loader->m_listpath);
   }
   CJobQueue::OnJobComplete(jobID, success, job);
 }
 
+void CVideoThumbLoader::OnThumbEncoded(bool success, CThumbEncoder *encoder)
+{
+  UpdateStats(success, encoder->m_decodeTime, encoder->m_encodeTime);
+  if (success)
+    UpdateItem(encoder->m_item, encoder->m_listpath);
+}
+
+void CVideoThumbLoader::UpdateItem(CFileItem &item, const CStdString &listpath)
+{
+  item.SetPath(listpath);
+  CVideoInfoTag* info = item.GetVideoInfoTag();
+  if (m_pStreamDetailsObs)
+    m_pStreamDetailsObs->OnStreamDetails(info->m_streamDetails, info->m_strFileNameAndPath, info->m_iFileId);
+  if (m_pObserver)
+    m_pObserver->OnItemLoaded(&item);
+  CFileItemPtr pItem(new CFileItem(item));
+  CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
+  g_windowManager.SendThreadMessage(msg);
+}
+
+void CVideoThumbLoader::UpdateStats(bool success, unsigned int decodeTime, unsigned int encodeTime)
+{
+  CSingleLock lock(m_statsSection);
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (m_stats.last == 0 || now - m_stats.last > THUMB_STATS_IDLE)
+  {
+    m_stats.Reset();
+    m_stats.start = now - decodeTime - encodeTime;
+  }
+  m_stats.last = now;
+
+  if (success)
+    m_stats.extracted++;
+  else
+    m_stats.failed++;
+  m_stats.decodeTime += decodeTime;
+  m_stats.encodeTime += encodeTime;
+
+  unsigned int count = m_stats.extracted + m_stats.failed;
+  if (count % THUMB_STATS_INTERVAL == 0)
+  {
+    unsigned int elapsed = std::max(now - m_stats.start, 1u);
+    CLog::Log(LOGNOTICE, "%s - %u thumbs generated, %u failed in %u ms (%.1f/s), per file %u ms decoding, %u ms encoding", __FUNCTION__,
+              m_stats.extracted, m_stats.failed, elapsed, count * 1000.0 / elapsed,
+              m_stats.decodeTime / count, m_stats.encodeTime / std::max(m_stats.extracted, 1u));
+  }
+}
+
 CProgramThumbLoader::CProgramThumbLoader()
 {
 }
@@ -27,6 +27,7 @@
 #define kJobTypeMediaFlags "mediaflags"
 
 class CStreamDetails;
+class CDVDThumbPicture;
 class IStreamDetailsObserver;
 class CVideoDatabase;
 class CMusicDatabase;
@@ -57,11 +58,77 @@ public:
 
   virtual bool operator==(const CJob* job) const;
 
+  /*!
+   \brief Scales and caches a decoded frame as the thumb target and sets it on item.
+   */
+  static bool CacheThumb(const CDVDThumbPicture &picture, const CStdString &target, CFileItem &item);
+
   CStdString m_path; ///< path of video to extract thumb from
   CStdString m_target; ///< thumbpath
   CStdString m_listpath; ///< path used in fileitem list
   CFileItem  m_item;
   bool       m_thumb; ///< extract thumb?
+  bool       m_encode; ///< cache the thumb right away, else leave the frame for a CThumbEncoder
+  CDVDThumbPicture* m_picture; ///< decoded frame, waiting for a CThumbEncoder
+  unsigned int m_decodeTime; ///< ms spent opening and decoding
+};
+
+/*!
+ \ingroup thumbs,jobs
+ \brief Thumb encoder job class
+
+ Second stage of the thumb generation. Scales the frame a CThumbExtractor decoded
+ and caches it, so the extractor can go on with the next file meanwhile.
+
+ \sa CThumbExtractor and CJob
+ */
+class CThumbEncoder : public CJob
+{
+public:
+  CThumbEncoder(CThumbExtractor& extractor);
+  virtual ~CThumbEncoder();
+
+  /*!
+   \brief Work function that scales and caches the thumb.
+   */
+  virtual bool DoWork();
+
+  virtual const char* GetType() const
+  {
+    return kJobTypeMediaFlags;
+  }
+
+  CStdString m_target; ///< thumbpath
+  CStdString m_listpath; ///< path used in fileitem list
+  CFileItem  m_item;
+  CDVDThumbPicture* m_picture; ///< frame to cache, taken over from the extractor
+  unsigned int m_decodeTime; ///< ms the extractor spent opening and decoding
+  unsigned int m_encodeTime; ///< ms spent scaling and encoding
+};
+
+/*!
+ \brief Counters of the thumb generation of a CVideoThumbLoader
+
+ A batch starts with the first thumb after generation was idle for a few seconds.
+ The loader logs them as progress and throughput of the batch.
+ */
+class CThumbExtractStats
+{
+public:
+  CThumbExtractStats() { Reset(); }
+  void Reset()
+  {
+    extracted = failed = 0;
+    decodeTime = encodeTime = 0;
+    start = last = 0;
+  }
+
+  unsigned int extracted;  ///< thumbs cached in this batch
+  unsigned int failed;     ///< files no thumb could be generated from
+  unsigned int decodeTime; ///< ms spent opening and decoding, summed over all files
+  unsigned int encodeTime; ///< ms spent scaling and encoding, summed over all files
+  unsigned int start;      ///< time the batch started
+  unsigned int last;       ///< time the last thumb was done
 };
 
 class CThumbLoader : public CBackgroundInfoLoader
@@ -91,6 +158,13 @@ public:
    \param image the URL of the image
    */
   static void SetCachedImage(const CFileItem &item, const CStdString &type, const CStdString &image);
+
+protected:
+  /*! \brief Opens a texture database connection for the worker thread, used by
+   GetCachedImage and SetCachedImage instead of opening one per item
+   */
+  virtual void OnWorkerStart();
+  virtual void OnWorkerFinish();
 };
 
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
@@ -136,8 +210,27 @@ protected:
   virtual void OnLoaderStart();
   virtual void OnLoaderFinish();
 
+  /*! \brief Runs the CThumbEncoder jobs and hands them back to the loader once done
+   */
+  class CEncodeQueue : public CJobQueue
+  {
+  public:
+    CEncodeQueue(CVideoThumbLoader *loader, unsigned int jobsAtOnce);
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+  private:
+    CVideoThumbLoader *m_loader;
+  };
+  friend class CEncodeQueue;
+
+  void OnThumbEncoded(bool success, CThumbEncoder *encoder);
+  void UpdateItem(CFileItem &item, const CStdString &listpath);
+  void UpdateStats(bool success, unsigned int decodeTime, unsigned int encodeTime);
+
   IStreamDetailsObserver *m_pStreamDetailsObs;
   CVideoDatabase *m_database;
+  CEncodeQueue m_encodeQueue;
+  CCriticalSection m_statsSection;
+  CThumbExtractStats m_stats;
 };
 
 class CProgramThumbLoader : public CThumbLoader
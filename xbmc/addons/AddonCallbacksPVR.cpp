@@ -168,9 +168,9 @@ void CAddonCallbacksPVR::PVRTransferChannelEntry(void *addonData, const ADDON_HA
     return;
   }
 
-  /* transfer this entry to the internal channels group */
+  /* transfer this entry to the internal channels group. the group is sorted once all channels were transfered */
   CPVRChannel transferChannel(*channel, client->GetID());
-  xbmcChannels->UpdateFromClient(transferChannel);
+  xbmcChannels->UpdateFromClient(transferChannel, 0, false);
 }
 
 void CAddonCallbacksPVR::PVRTransferRecordingEntry(void *addonData, const ADDON_HANDLE handle, const PVR_RECORDING *recording)
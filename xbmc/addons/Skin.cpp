@@ -187,14 +187,28 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.ClearIncludes();
   m_includes.LoadIncludes(includesPath);
+
+  m_includesStamp.Format("%s-%s", ID().c_str(), Version().c_str());
+  const std::vector<CStdString> &files = m_includes.GetFiles();
+  for (std::vector<CStdString>::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    struct __stat64 info;
+    if (CFile::Stat(*it, &info) == 0)
+      m_includesStamp.AppendFormat("-%"PRId64"-%"PRId64, (int64_t)info.st_mtime, (int64_t)info.st_size);
+  }
+}
+
+bool CSkinInfo::LoadIncludeFile(const CStdString &includeFile)
+{
+  return m_includes.LoadIncludes(includeFile);
 }
 
-void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */)
+void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */, std::set<CStdString>* includeFiles /* = NULL */)
 {
   if(xmlIncludeConditions)
     xmlIncludeConditions->clear();
 
-  m_includes.ResolveIncludes(node, xmlIncludeConditions);
+  m_includes.ResolveIncludes(node, xmlIncludeConditions, includeFiles);
 }
 
 int CSkinInfo::GetStartWindow() const
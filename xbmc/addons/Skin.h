@@ -91,7 +91,7 @@ public:
    */
   static bool TranslateResolution(const CStdString &name, RESOLUTION_INFO &res);
 
-  void ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL);
+  void ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL, std::set<CStdString>* includeFiles = NULL);
 
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
@@ -110,6 +110,18 @@ public:
   static double GetMinVersion();
   void LoadIncludes();
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
+
+  /*! \brief Get a string that changes whenever the skin or one of its include files changes
+   Used to tell whether windows that were stored with their includes resolved are still valid.
+   \return the id and version of the skin and the modification times and sizes of the include files
+   */
+  const CStdString& GetIncludesStamp() const { return m_includesStamp; };
+
+  /*! \brief Load an include file that isn't loaded from includes.xml, like ResolveIncludes() does for <include file="...">
+   \param includeFile path of the include file
+   \return true if the file is loaded, false otherwise
+   */
+  bool LoadIncludeFile(const CStdString &includeFile);
 protected:
   /*! \brief Given a resolution, retrieve the corresponding directory name
    \param res RESOLUTION to translate
@@ -134,6 +146,7 @@ protected:
 
   float m_effectsSlowDown;
   CGUIIncludes m_includes;
+  CStdString m_includesStamp;
   CStdString m_currentAspect;
 
   std::vector<CStartupWindow> m_startupWindows;
@@ -68,7 +68,26 @@ public:
   bool    video_only; /* player is not allowed to play audio streams, video streams only */
 };
 
+class CPlayerStartTimes
+{
+public:
+  CPlayerStartTimes()
+  {
+    inputopen = 0;
+    probe = 0;
+    streaminfo = 0;
+    firstpacket = 0;
+    faststart = false;
+  }
+  unsigned int inputopen;   /* ms to open the input stream */
+  unsigned int probe;       /* ms to detect the format and read the header */
+  unsigned int streaminfo;  /* ms to find the stream parameters */
+  unsigned int firstpacket; /* ms from the demuxer being ready to the first packet */
+  bool         faststart;   /* probing was limited to the known stream layout */
+};
+
 class CFileItem;
+class CFileItemList;
 class CRect;
 
 class IPlayer
@@ -81,6 +100,8 @@ public:
   virtual void UnRegisterAudioCallback() {};
   virtual bool OpenFile(const CFileItem& file, const CPlayerOptions& options){ return false;}
   virtual bool QueueNextFile(const CFileItem &file) { return false; }
+  /*! \brief hint the files that are likely to be queued next, players may open them ahead of time */
+  virtual void PreloadFiles(const CFileItemList &files) {}
   virtual void OnNothingToQueueNotify() {}
   virtual bool CloseFile(){ return true;}
   virtual bool IsPlaying() const { return false;}
@@ -158,6 +179,7 @@ public:
   virtual int GetPictureWidth(){ return 0;}
   virtual int GetPictureHeight(){ return 0;}
   virtual bool GetStreamDetails(CStreamDetails &details){ return false;}
+  virtual bool GetStartTimes(CPlayerStartTimes &times){ return false;}
   virtual void ToFFRW(int iSpeed = 0){};
   // Skip to next track/item inside the current media (if supported).
   virtual bool SkipNext(){return false;}
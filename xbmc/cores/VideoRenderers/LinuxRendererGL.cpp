@@ -45,6 +45,7 @@
 #include "utils/GLUtils.h"
 #include "RenderCapture.h"
 #include "RenderFormats.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoPicturePool.h"
 
 #ifdef HAVE_LIBVDPAU
 #include "cores/dvdplayer/DVDCodecs/Video/VDPAU.h"
@@ -126,6 +127,7 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
   memset(&image , 0, sizeof(image));
   memset(&pbo   , 0, sizeof(pbo));
   flipindex = 0;
+  picture = NULL;
 #ifdef HAVE_LIBVDPAU
   vdpau = NULL;
 #endif
@@ -133,6 +135,7 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
 
 CLinuxRendererGL::YUVBUFFER::~YUVBUFFER()
 {
+  SAFE_RELEASE(picture);
 #ifdef HAVE_LIBVA
   delete &vaapi;
 #endif
@@ -337,6 +340,9 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
       CLog::Log(LOGWARNING, "%s - Timeout waiting for texture %d", __FUNCTION__, source);
 
     im.flags |= IMAGE_FLAG_WRITING;
+
+    /* the caller will write new content, drop any held decoder buffer */
+    SAFE_RELEASE(m_buffers[source].picture);
   }
 
   // copy the image - should be operator of YV12Image
@@ -490,10 +496,25 @@ void CLinuxRendererGL::LoadPlane( YUVPLANE& plane, int type, unsigned flipindex
   plane.flipindex = flipindex;
 }
 
+YV12Image* CLinuxRendererGL::GetUploadImage(YUVBUFFER& buf, YV12Image& ref)
+{
+  if(!buf.picture)
+    return &buf.image;
+
+  ref = buf.image;
+  for(int p = 0; p < 3; p++)
+  {
+    ref.plane[p]  = buf.picture->data[p];
+    ref.stride[p] = buf.picture->iLineSize[p];
+  }
+  return &ref;
+}
+
 void CLinuxRendererGL::UploadYV12Texture(int source)
 {
   YUVBUFFER& buf    =  m_buffers[source];
-  YV12Image* im     = &buf.image;
+  YV12Image  ref;
+  YV12Image* im     =  GetUploadImage(buf, ref);
   YUVFIELDS& fields =  buf.fields;
 
   if (!(im->flags&IMAGE_FLAG_READY))
@@ -1748,6 +1769,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YUVFIELDS &fields = m_buffers[index].fields;
   GLuint    *pbo    = m_buffers[index].pbo;
 
+  SAFE_RELEASE(m_buffers[index].picture);
+
   if( fields[FIELD_FULL][0].id == 0 ) return;
 
   /* finish up all textures, and delete them */
@@ -3015,7 +3038,8 @@ void CLinuxRendererGL::SetupRGBBuffer()
 void CLinuxRendererGL::UploadRGBTexture(int source)
 {
   YUVBUFFER& buf    =  m_buffers[source];
-  YV12Image* im     = &buf.image;
+  YV12Image  ref;
+  YV12Image* im     =  GetUploadImage(buf, ref);
   YUVFIELDS& fields =  buf.fields;
 
   if (!(im->flags&IMAGE_FLAG_READY))
@@ -3382,6 +3406,22 @@ void CLinuxRendererGL::AddProcessor(CVDPAU* vdpau)
 }
 #endif
 
+bool CLinuxRendererGL::AddProcessor(CDVDVideoPictureBuffer* buffer)
+{
+  /* with pbo's the copy into the mapped buffer is the upload itself */
+  if(m_pboUsed || m_format != RENDER_FMT_YUV420P)
+    return false;
+
+  if(m_textureUpload != &CLinuxRendererGL::UploadYV12Texture
+  && m_textureUpload != &CLinuxRendererGL::UploadRGBTexture)
+    return false;
+
+  YUVBUFFER &buf = m_buffers[NextYV12Texture()];
+  SAFE_RELEASE(buf.picture);
+  buf.picture = buffer->Acquire();
+  return true;
+}
+
 #ifdef HAVE_LIBVA
 void CLinuxRendererGL::AddProcessor(VAAPI::CHolder& holder)
 {
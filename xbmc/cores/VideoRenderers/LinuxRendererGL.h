@@ -40,6 +40,7 @@ class CRenderCapture;
 
 class CVDPAU;
 class CBaseTexture;
+class CDVDVideoPictureBuffer;
 namespace Shaders { class BaseYUV2RGBShader; }
 namespace Shaders { class BaseVideoFilterShader; }
 namespace VAAPI   { struct CHolder; }
@@ -148,6 +149,7 @@ public:
 #ifdef TARGET_DARWIN
   virtual void         AddProcessor(struct __CVBuffer *cvBufferRef);
 #endif
+  virtual bool         AddProcessor(CDVDVideoPictureBuffer* buffer);
 
   virtual void RenderUpdate(bool clear, DWORD flags = 0, DWORD alpha = 255);
 
@@ -270,6 +272,7 @@ protected:
     YV12Image image;
     unsigned  flipindex; /* used to decide if this has been uploaded */
     GLuint    pbo[MAX_PLANES];
+    CDVDVideoPictureBuffer* picture; /* decoder buffer uploaded in place of image planes */
 
 #ifdef HAVE_LIBVDPAU
     CVDPAU*   vdpau;
@@ -288,6 +291,8 @@ protected:
   // field index 0 is full image, 1 is odd scanlines, 2 is even scanlines
   YUVBUFFERS m_buffers;
 
+  YV12Image* GetUploadImage(YUVBUFFER& buf, YV12Image& ref);
+
   void LoadPlane( YUVPLANE& plane, int type, unsigned flipindex
                 , unsigned width,  unsigned height
                 , int stride, int bpp, void* data, GLuint* pbo = NULL );
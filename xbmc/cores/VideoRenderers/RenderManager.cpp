@@ -27,6 +27,7 @@
 #include "video/VideoReferenceClock.h"
 #include "utils/MathUtils.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
 #include "Application.h"
@@ -103,6 +104,11 @@ CXBMCRenderManager::CXBMCRenderManager()
   m_bReconfigured = false;
   m_hasCaptures = false;
   m_displayLatency = 0.0f;
+  m_copyBytes = 0;
+  m_copyStart = 0;
+  m_copyRate = 0.0;
+  m_directPictures = 0;
+  m_copiedPictures = 0;
 }
 
 CXBMCRenderManager::~CXBMCRenderManager()
@@ -338,6 +344,15 @@ unsigned int CXBMCRenderManager::PreInit()
 
   UpdateDisplayLatency();
 
+  {
+    CSingleLock statsLock(m_statsSection);
+    m_copyBytes      = 0;
+    m_copyStart      = 0;
+    m_copyRate       = 0.0;
+    m_directPictures = 0;
+    m_copiedPictures = 0;
+  }
+
   return m_pRenderer->PreInit();
 }
 
@@ -809,20 +824,33 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   if(index < 0)
     return index;
 
+  unsigned int pixels = pic.iWidth * pic.iHeight;
+
   if(pic.format == RENDER_FMT_YUV420P
   || pic.format == RENDER_FMT_YUV420P10
   || pic.format == RENDER_FMT_YUV420P16)
   {
-    CDVDCodecUtils::CopyPicture(&image, &pic);
+#ifdef HAS_GL
+    /* let the renderer hold on to the decoder buffer instead of copying */
+    if(pic.buffer && m_pRenderer->AddProcessor(pic.buffer))
+      UpdateCopyStats(0, true);
+    else
+#endif
+    {
+      CDVDCodecUtils::CopyPicture(&image, &pic);
+      UpdateCopyStats(pixels * image.bpp * 3 / 2, false);
+    }
   }
   else if(pic.format == RENDER_FMT_NV12)
   {
     CDVDCodecUtils::CopyNV12Picture(&image, &pic);
+    UpdateCopyStats(pixels * 3 / 2, false);
   }
   else if(pic.format == RENDER_FMT_YUYV422
        || pic.format == RENDER_FMT_UYVY422)
   {
     CDVDCodecUtils::CopyYUV422PackedPicture(&image, &pic);
+    UpdateCopyStats(pixels * 2, false);
   }
   else if(pic.format == RENDER_FMT_DXVA)
   {
@@ -849,6 +877,37 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   return index;
 }
 
+void CXBMCRenderManager::UpdateCopyStats(unsigned int bytes, bool direct)
+{
+  CSingleLock lock(m_statsSection);
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if(m_copyStart == 0)
+    m_copyStart = now;
+
+  m_copyBytes += bytes;
+  if(direct)
+    m_directPictures++;
+  else
+    m_copiedPictures++;
+
+  /* only update the rate once every 2 seconds */
+  unsigned int elapsed = now - m_copyStart;
+  if(elapsed >= 2000)
+  {
+    m_copyRate  = (double)m_copyBytes * 1000.0 / elapsed;
+    m_copyBytes = 0;
+    m_copyStart = now;
+  }
+}
+
+void CXBMCRenderManager::GetCopyStats(double& copyrate, unsigned int& direct, unsigned int& copied)
+{
+  CSingleLock lock(m_statsSection);
+  copyrate = m_copyRate;
+  direct   = m_directPictures;
+  copied   = m_copiedPictures;
+}
+
 bool CXBMCRenderManager::Supports(ERENDERFEATURE feature)
 {
   CSharedLock lock(m_sharedSection);
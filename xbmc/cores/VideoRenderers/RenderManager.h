@@ -70,6 +70,13 @@ public:
 
   int AddVideoPicture(DVDVideoPicture& picture);
 
+  /*! \brief Statistics of how pictures reach the renderer
+   \param copyrate bytes per second copied from decoder pictures into render buffers
+   \param direct number of pictures taken over from the decoder without a copy since playback start
+   \param copied number of pictures copied since playback start
+   */
+  void GetCopyStats(double& copyrate, unsigned int& direct, unsigned int& copied);
+
   void FlipPage(volatile bool& bStop, double timestamp = 0.0, int source = -1, EFIELDSYNC sync = FS_NONE);
   unsigned int PreInit();
   void UnInit();
@@ -169,6 +176,15 @@ protected:
   double m_displayLatency;
   void UpdateDisplayLatency();
 
+  void UpdateCopyStats(unsigned int bytes, bool direct);
+
+  CCriticalSection m_statsSection;
+  uint64_t     m_copyBytes;
+  unsigned int m_copyStart;
+  double       m_copyRate;
+  unsigned int m_directPictures;
+  unsigned int m_copiedPictures;
+
   double     m_presenttime;
   double     m_presentcorr;
   double     m_presenterr;
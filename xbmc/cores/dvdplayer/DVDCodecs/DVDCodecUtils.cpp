@@ -23,8 +23,137 @@
 #include "cores/VideoRenderers/RenderManager.h"
 #include "utils/log.h"
 #include "utils/fastmemcpy.h"
+#include "utils/CPUInfo.h"
 #include "DllSwScale.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+static void InterleaveUV_C(uint8_t *d_uv, const uint8_t *s_u, const uint8_t *s_v, int width)
+{
+  for (int x = 0; x < width; x++)
+  {
+    *d_uv++ = *s_u++;
+    *d_uv++ = *s_v++;
+  }
+}
+
+static void PackYUV422_C(uint8_t *d, const uint8_t *s_y, const uint8_t *s_u, const uint8_t *s_v, int width, bool uyvy)
+{
+  if (uyvy)
+  {
+    for (int x = 0; x < width / 2; x++)
+    {
+      *d++ = *s_u++;
+      *d++ = *s_y++;
+      *d++ = *s_v++;
+      *d++ = *s_y++;
+    }
+  }
+  else
+  {
+    for (int x = 0; x < width / 2; x++)
+    {
+      *d++ = *s_y++;
+      *d++ = *s_u++;
+      *d++ = *s_y++;
+      *d++ = *s_v++;
+    }
+  }
+}
+
+#if defined(__SSE2__)
+static void InterleaveUV_SSE2(uint8_t *d_uv, const uint8_t *s_u, const uint8_t *s_v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i u = _mm_loadu_si128((const __m128i*)(s_u + x));
+    __m128i v = _mm_loadu_si128((const __m128i*)(s_v + x));
+    _mm_storeu_si128((__m128i*)(d_uv + 2 * x),      _mm_unpacklo_epi8(u, v));
+    _mm_storeu_si128((__m128i*)(d_uv + 2 * x + 16), _mm_unpackhi_epi8(u, v));
+  }
+  InterleaveUV_C(d_uv + 2 * x, s_u + x, s_v + x, width - x);
+}
+
+static void PackYUV422_SSE2(uint8_t *d, const uint8_t *s_y, const uint8_t *s_u, const uint8_t *s_v, int width, bool uyvy)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m128i y0 = _mm_loadu_si128((const __m128i*)(s_y + x));
+    __m128i y1 = _mm_loadu_si128((const __m128i*)(s_y + x + 16));
+    __m128i u  = _mm_loadu_si128((const __m128i*)(s_u + x / 2));
+    __m128i v  = _mm_loadu_si128((const __m128i*)(s_v + x / 2));
+    __m128i uv0 = _mm_unpacklo_epi8(u, v);
+    __m128i uv1 = _mm_unpackhi_epi8(u, v);
+    __m128i *out = (__m128i*)(d + 2 * x);
+    if (uyvy)
+    {
+      _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(uv0, y0));
+      _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(uv0, y0));
+      _mm_storeu_si128(out + 2, _mm_unpacklo_epi8(uv1, y1));
+      _mm_storeu_si128(out + 3, _mm_unpackhi_epi8(uv1, y1));
+    }
+    else
+    {
+      _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(y0, uv0));
+      _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(y0, uv0));
+      _mm_storeu_si128(out + 2, _mm_unpacklo_epi8(y1, uv1));
+      _mm_storeu_si128(out + 3, _mm_unpackhi_epi8(y1, uv1));
+    }
+  }
+  PackYUV422_C(d + 2 * x, s_y + x, s_u + x / 2, s_v + x / 2, width - x, uyvy);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+static void InterleaveUV_NEON(uint8_t *d_uv, const uint8_t *s_u, const uint8_t *s_v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    uint8x16x2_t uv;
+    uv.val[0] = vld1q_u8(s_u + x);
+    uv.val[1] = vld1q_u8(s_v + x);
+    vst2q_u8(d_uv + 2 * x, uv);
+  }
+  InterleaveUV_C(d_uv + 2 * x, s_u + x, s_v + x, width - x);
+}
+
+static void PackYUV422_NEON(uint8_t *d, const uint8_t *s_y, const uint8_t *s_u, const uint8_t *s_v, int width, bool uyvy)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    uint8x8x2_t y = vld2_u8(s_y + x);
+    uint8x8_t   u = vld1_u8(s_u + x / 2);
+    uint8x8_t   v = vld1_u8(s_v + x / 2);
+    uint8x8x4_t out;
+    if (uyvy)
+    {
+      out.val[0] = u;
+      out.val[1] = y.val[0];
+      out.val[2] = v;
+      out.val[3] = y.val[1];
+    }
+    else
+    {
+      out.val[0] = y.val[0];
+      out.val[1] = u;
+      out.val[2] = y.val[1];
+      out.val[3] = v;
+    }
+    vst4_u8(d + 2 * x, out);
+  }
+  PackYUV422_C(d + 2 * x, s_y + x, s_u + x / 2, s_v + x / 2, width - x, uyvy);
+}
+#endif
+
 // allocate a new picture (PIX_FMT_YUV420P)
 DVDVideoPicture* CDVDCodecUtils::AllocatePicture(int iWidth, int iHeight)
 {
@@ -195,15 +324,13 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToNV12Picture(DVDVideoPicture *pSrc)
       }
 
       //copy chroma
+      int cpu = g_cpuInfo.GetCPUFeatures();
       uint8_t *s_u, *s_v, *d_uv;
       for (int y = 0; y < (int)pSrc->iHeight/2; y++) {
         s_u = pSrc->data[1] + (y * pSrc->iLineSize[1]);
         s_v = pSrc->data[2] + (y * pSrc->iLineSize[2]);
         d_uv = pPicture->data[1] + (y * pPicture->iLineSize[1]);
-        for (int x = 0; x < (int)pSrc->iWidth/2; x++) {
-          *d_uv++ = *s_u++;
-          *d_uv++ = *s_v++;
-        }
+        InterleaveUV(d_uv, s_u, s_v, pSrc->iWidth/2, cpu);
       }
       
     }
@@ -240,32 +367,16 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
       pPicture->iLineSize[3] = 0;
       pPicture->format = format;
 
-      //if this is going to be used for anything else than testing the renderer
-      //the library should not be loaded on every function call
-      DllSwScale  dllSwScale;
-      if (!dllSwScale.Load())
-      {
-        CLog::Log(LOGERROR,"CDVDCodecUtils::ConvertToYUY2Picture - failed to load rescale libraries!");
-      }
-      else
+      // every chroma row is shared by two luma rows, same as the
+      // unscaled path of swscale
+      int cpu = g_cpuInfo.GetCPUFeatures();
+      for (int y = 0; y < (int)pSrc->iHeight; y++)
       {
-        // Perform the scaling.
-        uint8_t* src[] =       { pSrc->data[0],          pSrc->data[1],      pSrc->data[2],      NULL };
-        int      srcStride[] = { pSrc->iLineSize[0],     pSrc->iLineSize[1], pSrc->iLineSize[2], 0    };
-        uint8_t* dst[] =       { pPicture->data[0],      NULL,               NULL,               NULL };
-        int      dstStride[] = { pPicture->iLineSize[0], 0,                  0,                  0    };
-
-        int dstformat;
-        if (format == RENDER_FMT_UYVY422)
-          dstformat = PIX_FMT_UYVY422;
-        else
-          dstformat = PIX_FMT_YUYV422;
-
-        struct SwsContext *ctx = dllSwScale.sws_getContext(pSrc->iWidth, pSrc->iHeight, PIX_FMT_YUV420P,
-                                                           pPicture->iWidth, pPicture->iHeight, dstformat,
-                                                           SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-        dllSwScale.sws_scale(ctx, src, srcStride, 0, pSrc->iHeight, dst, dstStride);
-        dllSwScale.sws_freeContext(ctx);
+        PackYUV422(pPicture->data[0] + y * pPicture->iLineSize[0],
+                   pSrc->data[0] + y * pSrc->iLineSize[0],
+                   pSrc->data[1] + (y >> 1) * pSrc->iLineSize[1],
+                   pSrc->data[2] + (y >> 1) * pSrc->iLineSize[2],
+                   pSrc->iWidth, format, cpu);
       }
     }
     else
@@ -481,3 +592,30 @@ int CDVDCodecUtils::PixfmtFromEFormat(ERenderFormat fmt)
   }
   return PIX_FMT_NONE;
 }
+
+void CDVDCodecUtils::InterleaveUV(uint8_t *d_uv, const uint8_t *s_u, const uint8_t *s_v, int width, int cpu)
+{
+#if defined(__SSE2__)
+  if (cpu & CPU_FEATURE_SSE2)
+    return InterleaveUV_SSE2(d_uv, s_u, s_v, width);
+#endif
+#if defined(__ARM_NEON__)
+  if (cpu & CPU_FEATURE_NEON)
+    return InterleaveUV_NEON(d_uv, s_u, s_v, width);
+#endif
+  InterleaveUV_C(d_uv, s_u, s_v, width);
+}
+
+void CDVDCodecUtils::PackYUV422(uint8_t *d, const uint8_t *s_y, const uint8_t *s_u, const uint8_t *s_v, int width, ERenderFormat format, int cpu)
+{
+  bool uyvy = (format == RENDER_FMT_UYVY422);
+#if defined(__SSE2__)
+  if (cpu & CPU_FEATURE_SSE2)
+    return PackYUV422_SSE2(d, s_y, s_u, s_v, width, uyvy);
+#endif
+#if defined(__ARM_NEON__)
+  if (cpu & CPU_FEATURE_NEON)
+    return PackYUV422_NEON(d, s_y, s_u, s_v, width, uyvy);
+#endif
+  PackYUV422_C(d, s_y, s_u, s_v, width, uyvy);
+}
@@ -45,5 +45,14 @@ public:
 
   static ERenderFormat EFormatFromPixfmt(int fmt);
   static int           PixfmtFromEFormat(ERenderFormat format);
+
+  /*
+   * Row kernels behind the NV12 and packed 4:2:2 conversions. cpu holds
+   * the CPU_FEATURE_* flags to pick the implementation with, pass 0 for
+   * the plain C version. width is in chroma samples for InterleaveUV and
+   * in luma samples for PackYUV422.
+   */
+  static void InterleaveUV(uint8_t *d_uv, const uint8_t *s_u, const uint8_t *s_v, int width, int cpu);
+  static void PackYUV422(uint8_t *d, const uint8_t *s_y, const uint8_t *s_u, const uint8_t *s_v, int width, ERenderFormat format, int cpu);
 };
 
@@ -35,6 +35,7 @@
 namespace DXVA { class CSurfaceContext; }
 namespace VAAPI { struct CHolder; }
 class CVDPAU;
+class CDVDVideoPictureBuffer;
 class COpenMax;
 class COpenMaxVideo;
 struct OpenMaxVideoBuffer;
@@ -71,6 +72,8 @@ struct DVDVideoPicture
     };
   };
 
+  CDVDVideoPictureBuffer* buffer; // refcounted storage behind data[] when the decoder rendered directly into it, else NULL
+
   unsigned int iFlags;
 
   double       iRepeatPicture;
@@ -237,4 +240,33 @@ public:
   {
     return 0;
   }
+
+  /*
+   * How many packets the codec may consume before it
+   * starts returning pictures, for example due to
+   * frame threading. The player should not treat these
+   * as dropped pictures.
+   */
+  virtual unsigned GetFrameDelay()
+  {
+    return 0;
+  }
+
+  /*
+   * Called at end of stream. Following Decode(NULL, 0)
+   * calls return the pictures the codec still holds back
+   * until it returns VC_BUFFER without a picture.
+   */
+  virtual void Drain()
+  {
+  }
+
+  /*
+   * If the codec can be reset and kept open for a following
+   * stream with the same hints instead of being reopened
+   */
+  virtual bool CanReuse()
+  {
+    return false;
+  }
 };
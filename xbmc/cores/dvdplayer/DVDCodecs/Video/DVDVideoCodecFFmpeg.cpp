@@ -28,6 +28,7 @@
 #include "DVDClock.h"
 #include "DVDCodecs/DVDCodecs.h"
 #include "DVDCodecs/DVDCodecUtils.h"
+#include "DVDVideoPicturePool.h"
 #if defined(_LINUX) || defined(_WIN32)
 #include "utils/CPUInfo.h"
 #endif
@@ -120,6 +121,128 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 }
 
+/* hardware decoders that are set up from get_format and then install
+ * their own get_buffer/release_buffer callbacks on the context */
+static bool HardwareFormatsEnabled()
+{
+#ifdef HAS_DX
+  if(g_guiSettings.GetBool("videoplayer.usedxva2"))
+    return true;
+#endif
+#ifdef HAVE_LIBVA
+  if(g_guiSettings.GetBool("videoplayer.usevaapi"))
+    return true;
+#endif
+  return false;
+}
+
+int CDVDVideoCodecFFmpeg::GetBuffer(AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  /* only planar 4:2:0 can be handed to the renderer as is */
+  if(avctx->pix_fmt != PIX_FMT_YUV420P
+  && avctx->pix_fmt != PIX_FMT_YUVJ420P)
+    return ctx->m_dllAvCodec.avcodec_default_get_buffer(avctx, pic);
+
+  if(avctx->width <= 0 || avctx->height <= 0)
+    return -1;
+
+  int w = avctx->width;
+  int h = avctx->height;
+  int stride_align[AV_NUM_DATA_POINTERS];
+  ctx->m_dllAvCodec.avcodec_align_dimensions2(avctx, &w, &h, stride_align);
+
+  int edge = 0;
+  if(!(avctx->flags & CODEC_FLAG_EMU_EDGE))
+    edge = ctx->m_dllAvCodec.avcodec_get_edge_width();
+
+  /* luma stride a multiple of 64 keeps the chroma strides aligned too,
+   * the extra 64 bytes leave room for the aligned start of each line */
+  int linesize[3];
+  int lines[3];
+  linesize[0] = FFALIGN(w + edge * 2, 64) + (edge ? 64 : 0);
+  linesize[1] = linesize[0] / 2;
+  linesize[2] = linesize[0] / 2;
+  lines[0]    = h + edge * 2;
+  lines[1]    = lines[0] / 2;
+  lines[2]    = lines[0] / 2;
+
+  size_t planesize[3];
+  size_t size = 0;
+  for(int i = 0; i < 3; i++)
+  {
+    planesize[i] = FFALIGN((size_t)linesize[i] * lines[i], 64);
+    size += planesize[i];
+  }
+
+  CDVDVideoPictureBuffer* buffer = ctx->m_pPicturePool->Get(size);
+  if(!buffer)
+    return -1;
+
+  BYTE* base = buffer->Base();
+  for(int i = 0; i < 3; i++)
+  {
+    int shift = i ? 1 : 0;
+    buffer->iLineSize[i] = linesize[i];
+    buffer->data[i]      = base;
+    if(edge)
+      buffer->data[i]   += FFALIGN((linesize[i] * edge >> shift) + (edge >> shift), stride_align[i]);
+    base += planesize[i];
+  }
+
+  for(int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+  {
+    pic->base[i]     = i < 3 ? buffer->data[i]      : NULL;
+    pic->data[i]     = i < 3 ? buffer->data[i]      : NULL;
+    pic->linesize[i] = i < 3 ? buffer->iLineSize[i] : 0;
+  }
+  pic->extended_data = pic->data;
+  pic->type          = FF_BUFFER_TYPE_USER;
+  pic->opaque        = buffer;
+#if !defined(FF_API_AVFRAME_AGE) || FF_API_AVFRAME_AGE
+  /* a recycled buffer holds some unrelated older picture, decoders
+   * that reuse unchanged areas of a reget buffer must redraw it all */
+  pic->age           = INT_MAX;
+#endif
+
+  if(avctx->pkt)
+  {
+    pic->pkt_pts = avctx->pkt->pts;
+    pic->pkt_pos = avctx->pkt->pos;
+  }
+  else
+  {
+    pic->pkt_pts = AV_NOPTS_VALUE;
+    pic->pkt_pos = -1;
+  }
+  pic->reordered_opaque    = avctx->reordered_opaque;
+  pic->sample_aspect_ratio = avctx->sample_aspect_ratio;
+  pic->width               = avctx->width;
+  pic->height              = avctx->height;
+  pic->format              = avctx->pix_fmt;
+  return 0;
+}
+
+void CDVDVideoCodecFFmpeg::ReleaseBuffer(AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  if(pic->type != FF_BUFFER_TYPE_USER)
+  {
+    ctx->m_dllAvCodec.avcodec_default_release_buffer(avctx, pic);
+    return;
+  }
+
+  CDVDVideoPictureBuffer* buffer = (CDVDVideoPictureBuffer*)pic->opaque;
+  for(int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+    pic->data[i] = NULL;
+  pic->opaque = NULL;
+
+  if(buffer)
+    buffer->Release();
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
@@ -142,6 +265,9 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
   m_iLastKeyframe = 0;
   m_dts = DVD_NOPTS_VALUE;
   m_started = false;
+  m_iFrameDelay = 0;
+  m_bDraining = false;
+  m_pPicturePool = NULL;
 }
 
 CDVDVideoCodecFFmpeg::~CDVDVideoCodecFFmpeg()
@@ -245,7 +371,7 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
-  /* Only allow slice threading, since frame threading is more
+  /* Only allow slice threading by default, since frame threading is more
    * sensitive to changes in frame sizes, and it causes crashes
    * during HW accell */
   m_pCodecContext->thread_type = FF_THREAD_SLICE;
@@ -297,12 +423,44 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
     || pCodec->id == CODEC_ID_MPEG4 ))
     m_pCodecContext->thread_count = num_threads;
 
+  /* frame threading for pure software decoding, hardware decoders may be
+   * created from get_format which would then run on a decoding thread */
+  bool frame_threading = g_advancedSettings.m_videoFrameThreading
+                      && num_threads > 1 && !hints.software && m_pHardware == NULL
+                      && !HardwareFormatsEnabled();
+  if(frame_threading && (pCodec->capabilities & CODEC_CAP_FRAME_THREADS))
+  {
+    m_bSoftware = true;
+    m_pCodecContext->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    m_pCodecContext->thread_count = num_threads;
+  }
+
+  /* decode into refcounted buffers the renderer can hold on to instead
+   * of copying, unless a hardware decoder could replace get_buffer later */
+  if(!hints.software && m_pHardware == NULL
+  && (m_bSoftware || !HardwareFormatsEnabled())
+  && (pCodec->capabilities & CODEC_CAP_DR1))
+  {
+    m_pPicturePool = new CDVDVideoPicturePool();
+    m_pCodecContext->get_buffer     = GetBuffer;
+    m_pCodecContext->release_buffer = ReleaseBuffer;
+    m_pCodecContext->thread_safe_callbacks = 1;
+  }
+
   if (m_dllAvCodec.avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
     CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Unable to open codec");
     return false;
   }
 
+  if(m_pCodecContext->active_thread_type & FF_THREAD_FRAME)
+  {
+    m_iFrameDelay = m_pCodecContext->thread_count - 1;
+    CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() Using frame threading with %d threads", m_pCodecContext->thread_count);
+  }
+  else
+    m_iFrameDelay = 0;
+
   m_pFrame = m_dllAvCodec.avcodec_alloc_frame();
   if (!m_pFrame) return false;
 
@@ -329,6 +487,9 @@ void CDVDVideoCodecFFmpeg::Dispose()
   }
   SAFE_RELEASE(m_pHardware);
 
+  /* buffers still held by the renderer keep the pool alive */
+  SAFE_RELEASE(m_pPicturePool);
+
   FilterClose();
 
   m_dllAvCodec.Unload();
@@ -453,10 +614,17 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
     int result = 0;
     if(pData == NULL)
       result = FilterProcess(NULL);
+    if(m_bDraining && (result & VC_PICTURE))
+      result &= ~VC_BUFFER;
     if(result)
       return result;
   }
 
+  /* an empty packet would switch the frame threads into draining
+   * mode, which is only valid at end of stream */
+  if(pData == NULL && m_iFrameDelay > 0 && !m_bDraining)
+    return VC_BUFFER;
+
   m_dts = dts;
   m_pCodecContext->reordered_opaque = pts_dtoi(pts);
 
@@ -464,6 +632,10 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   m_dllAvCodec.av_init_packet(&avpkt);
   avpkt.data = pData;
   avpkt.size = iSize;
+  /* frames come out of a frame threaded decoder several packets later,
+   * let ffmpeg carry the dts along with the frame */
+  if(m_iFrameDelay > 0)
+    avpkt.dts = pts_dtoi(dts);
   /* We lie, but this flag is only used by pngdec.c.
    * Setting it correctly would allow CorePNG decoding. */
   avpkt.flags = AV_PKT_FLAG_KEY;
@@ -479,7 +651,16 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   }
 
   if (!iGotPicture)
+  {
+    /* all held back pictures are out, make the decoder
+     * accept packets again should the stream continue */
+    if(m_bDraining)
+    {
+      m_bDraining = false;
+      m_dllAvCodec.avcodec_flush_buffers(m_pCodecContext);
+    }
     return VC_BUFFER;
+  }
 
   if(m_pFrame->key_frame)
   {
@@ -534,12 +715,17 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   if(result & VC_FLUSHED)
     Reset();
 
+  /* keep the player asking for pictures until the decoder is empty */
+  if(m_bDraining && (result & VC_PICTURE))
+    result &= ~VC_BUFFER;
+
   return result;
 }
 
 void CDVDVideoCodecFFmpeg::Reset()
 {
   m_started = false;
+  m_bDraining = false;
   m_iLastKeyframe = m_pCodecContext->has_b_frames;
   m_dllAvCodec.avcodec_flush_buffers(m_pCodecContext);
 
@@ -631,7 +817,10 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
     pDvdVideoPicture->qscale_type = DVP_QSCALE_UNKNOWN;
   }
 
-  pDvdVideoPicture->dts = m_dts;
+  if(m_iFrameDelay > 0)
+    pDvdVideoPicture->dts = pts_itod(m_pFrame->pkt_dts);
+  else
+    pDvdVideoPicture->dts = m_dts;
   m_dts = DVD_NOPTS_VALUE;
   if (m_pFrame->reordered_opaque)
     pDvdVideoPicture->pts = pts_itod(m_pFrame->reordered_opaque);
@@ -659,6 +848,15 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
       pDvdVideoPicture->iLineSize[i] = m_pFrame->linesize[i];
   }
 
+  /* hand over our buffer if the picture wasn't replaced by the filters */
+  pDvdVideoPicture->buffer = NULL;
+  if(m_pFrame->type == FF_BUFFER_TYPE_USER && m_pFrame->opaque && !m_pBufferRef)
+  {
+    CDVDVideoPictureBuffer* buffer = (CDVDVideoPictureBuffer*)m_pFrame->opaque;
+    if(buffer->data[0] == m_pFrame->data[0])
+      pDvdVideoPicture->buffer = buffer;
+  }
+
   pDvdVideoPicture->iFlags |= pDvdVideoPicture->data[0] ? 0 : DVP_FLAG_DROPPED;
   pDvdVideoPicture->extended_format = 0;
 
@@ -853,6 +1051,17 @@ int CDVDVideoCodecFFmpeg::FilterProcess(AVFrame* frame)
   return VC_BUFFER;
 }
 
+unsigned CDVDVideoCodecFFmpeg::GetFrameDelay()
+{
+  return m_iFrameDelay;
+}
+
+void CDVDVideoCodecFFmpeg::Drain()
+{
+  if(m_pHardware == NULL)
+    m_bDraining = true;
+}
+
 unsigned CDVDVideoCodecFFmpeg::GetConvergeCount()
 {
   if(m_pHardware)
@@ -30,6 +30,7 @@
 
 class CVDPAU;
 class CCriticalSection;
+class CDVDVideoPicturePool;
 
 class CDVDVideoCodecFFmpeg : public CDVDVideoCodec
 {
@@ -60,6 +61,9 @@ public:
   virtual unsigned int SetFilters(unsigned int filters);
   virtual const char* GetName() { return m_name.c_str(); }; // m_name is never changed after open
   virtual unsigned GetConvergeCount();
+  virtual unsigned GetFrameDelay();
+  virtual void Drain();
+  virtual bool CanReuse() { return m_pHardware == NULL; }
 
   bool               IsHardwareAllowed()                     { return !m_bSoftware; }
   IHardwareDecoder * GetHardware()                           { return m_pHardware; };
@@ -72,6 +76,8 @@ public:
 
 protected:
   static enum PixelFormat GetFormat(struct AVCodecContext * avctx, const PixelFormat * fmt);
+  static int  GetBuffer(AVCodecContext *avctx, AVFrame *pic);
+  static void ReleaseBuffer(AVCodecContext *avctx, AVFrame *pic);
 
   int  FilterOpen(const CStdString& filters, bool scale);
   void FilterClose();
@@ -118,5 +124,8 @@ protected:
   int m_iLastKeyframe;
   double m_dts;
   bool   m_started;
+  int    m_iFrameDelay;
+  bool   m_bDraining;
+  CDVDVideoPicturePool* m_pPicturePool;
   std::vector<PixelFormat> m_formats;
 };
@@ -0,0 +1,120 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDVideoPicturePool.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+/* ffmpeg may read a little past the end of a plane */
+#define PICTURE_BUFFER_PADDING 64
+#define PICTURE_BUFFER_ALIGN   64
+
+CDVDVideoPictureBuffer::CDVDVideoPictureBuffer(CDVDVideoPicturePool* pool, size_t size)
+  : m_pool(pool)
+{
+  memset(data, 0, sizeof(data));
+  memset(iLineSize, 0, sizeof(iLineSize));
+  this->size = size;
+  m_base = (BYTE*)_aligned_malloc(size + PICTURE_BUFFER_PADDING, PICTURE_BUFFER_ALIGN);
+}
+
+CDVDVideoPictureBuffer::~CDVDVideoPictureBuffer()
+{
+  if (m_base)
+    _aligned_free(m_base);
+}
+
+long CDVDVideoPictureBuffer::Release()
+{
+  long count = AtomicDecrement(&m_refs);
+  assert(count >= 0);
+  if (count == 0)
+    m_pool->Return(this);
+  return count;
+}
+
+CDVDVideoPicturePool::CDVDVideoPicturePool()
+{
+  m_allocated = 0;
+}
+
+CDVDVideoPicturePool::~CDVDVideoPicturePool()
+{
+  for (std::vector<CDVDVideoPictureBuffer*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
+}
+
+CDVDVideoPictureBuffer* CDVDVideoPicturePool::Get(size_t size)
+{
+  CDVDVideoPictureBuffer* buffer = NULL;
+  {
+    CSingleLock lock(m_section);
+    while (!m_free.empty() && !buffer)
+    {
+      buffer = m_free.back();
+      m_free.pop_back();
+
+      /* picture size changed, drop buffers of the old size */
+      if (buffer->size != size)
+      {
+        delete buffer;
+        buffer = NULL;
+        m_allocated--;
+      }
+    }
+  }
+
+  if (!buffer)
+  {
+    buffer = new CDVDVideoPictureBuffer(this, size);
+    if (!buffer->m_base)
+    {
+      CLog::Log(LOGERROR, "CDVDVideoPicturePool::Get - unable to allocate %u bytes", (unsigned int)size);
+      delete buffer;
+      return NULL;
+    }
+
+    CSingleLock lock(m_section);
+    m_allocated++;
+  }
+
+  memset(buffer->data, 0, sizeof(buffer->data));
+  memset(buffer->iLineSize, 0, sizeof(buffer->iLineSize));
+  buffer->m_refs = 1;
+
+  /* every buffer handed out keeps the pool alive */
+  Acquire();
+  return buffer;
+}
+
+unsigned int CDVDVideoPicturePool::GetAllocated()
+{
+  CSingleLock lock(m_section);
+  return m_allocated;
+}
+
+void CDVDVideoPicturePool::Return(CDVDVideoPictureBuffer* buffer)
+{
+  {
+    CSingleLock lock(m_section);
+    m_free.push_back(buffer);
+  }
+  Release();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "DVDResource.h"
+#include "threads/CriticalSection.h"
+
+#include <vector>
+
+class CDVDVideoPicturePool;
+
+/*
+ * A block of picture memory handed out by CDVDVideoPicturePool.
+ * The decoder holds one reference while it uses the buffer as a
+ * frame, the renderer may hold another until the picture has been
+ * presented. The buffer goes back to its pool once the last
+ * reference is released.
+ */
+class CDVDVideoPictureBuffer : public IDVDResourceCounted<CDVDVideoPictureBuffer>
+{
+public:
+  virtual ~CDVDVideoPictureBuffer();
+  virtual long Release();
+
+  BYTE*  Base() { return m_base; }
+
+  BYTE*  data[4];
+  int    iLineSize[4];
+  size_t size;
+
+protected:
+  friend class CDVDVideoPicturePool;
+
+  CDVDVideoPictureBuffer(CDVDVideoPicturePool* pool, size_t size);
+
+  CDVDVideoPicturePool* m_pool;
+  BYTE*                 m_base;
+};
+
+class CDVDVideoPicturePool : public IDVDResourceCounted<CDVDVideoPicturePool>
+{
+public:
+  CDVDVideoPicturePool();
+  virtual ~CDVDVideoPicturePool();
+
+  /*
+   * returns a buffer of at least size bytes with a single
+   * reference held, or NULL if the allocation failed
+   */
+  CDVDVideoPictureBuffer* Get(size_t size);
+
+  unsigned int GetAllocated();
+
+protected:
+  friend class CDVDVideoPictureBuffer;
+  void Return(CDVDVideoPictureBuffer* buffer);
+
+  CCriticalSection                     m_section;
+  std::vector<CDVDVideoPictureBuffer*> m_free;
+  unsigned int                         m_allocated;
+};
@@ -46,6 +46,8 @@
 #include "threads/Thread.h"
 #include "threads/SystemClock.h"
 #include "utils/TimeUtils.h"
+#include "utils/StreamDetails.h"
+#include "video/VideoInfoTag.h"
 
 void CDemuxStreamAudioFFmpeg::GetStreamInfo(std::string& strInfo)
 {
@@ -214,6 +216,12 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_bAVI = false;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
+  m_bFastStart = false;
+  m_probeTime = 0;
+  m_streamInfoTime = 0;
+  m_bKeyframeIndex = false;
+  m_bPacketIndex = false;
+  m_iIndexStream = -1;
 }
 
 CDVDDemuxFFmpeg::~CDVDDemuxFFmpeg()
@@ -255,6 +263,19 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // if the video database knows the stream layout of this file from an
+  // earlier playback, stream info only has to probe until those streams
+  // are found
+  const CStreamDetails* details = NULL;
+  const CFileItem& item = m_pInput->GetFileItem();
+  if (g_advancedSettings.m_videoFastStart
+  &&  item.HasVideoInfoTag() && item.GetVideoInfoTag()->HasStreamDetails()
+  && !m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
+    details = &item.GetVideoInfoTag()->m_streamDetails;
+  m_bFastStart = details != NULL;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -322,7 +343,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       // want to probe for spdif (DTS or IEC 61937) compressed audio
       // specifically, or in case the file is a wav which may contain DTS or
       // IEC 61937 (e.g. ac3-in-wav) and we want to check for those formats.
-      if (trySPDIFonly || (iformat && strcmp(iformat->name, "wav") == 0))
+      // A wav that played as plain pcm before does not need the check.
+      bool knownPCM = details && details->GetAudioCodec().Left(3).Equals("pcm");
+      if (trySPDIFonly || (iformat && strcmp(iformat->name, "wav") == 0 && !knownPCM))
       {
         AVProbeData pd;
         BYTE probe_buffer[FFMPEG_FILE_BUFFER_SIZE + AVPROBE_PADDING_SIZE];
@@ -423,6 +446,8 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     }
   }
 
+  m_probeTime = XbmcThreads::SystemClockMillis() - start;
+
   // set the interrupt callback, appeared in libavformat 53.15.0
   m_pFormatContext->interrupt_callback = int_cb;
 
@@ -441,8 +466,26 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       m_pFormatContext->max_analyze_duration = 500000;
 
 
+    unsigned int probesize = m_pFormatContext->probesize;
+    int          analyzeduration = m_pFormatContext->max_analyze_duration;
+    if (m_bFastStart)
+    {
+      m_pFormatContext->probesize = FFMPEG_FASTSTART_PROBESIZE;
+      m_pFormatContext->max_analyze_duration = std::min(analyzeduration, FFMPEG_FASTSTART_ANALYZEDURATION);
+    }
+
+    start = XbmcThreads::SystemClockMillis();
     CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
     int iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
+    if (m_bFastStart && (iErr < 0 || !HasStreams(*details)))
+    {
+      // the file changed since it was last played, probe it fully
+      CLog::Log(LOGDEBUG, "%s - known streams not found, probing with defaults", __FUNCTION__);
+      m_bFastStart = false;
+      m_pFormatContext->probesize = probesize;
+      m_pFormatContext->max_analyze_duration = analyzeduration;
+      iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
+    }
     if (iErr < 0)
     {
       CLog::Log(LOGWARNING,"could not find codec parameters for %s", strFile.c_str());
@@ -456,8 +499,11 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
         return false;
       }
     }
+    m_streamInfoTime = XbmcThreads::SystemClockMillis() - start;
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
   }
+  CLog::Log(LOGNOTICE, "%s - probe %u ms, stream info %u ms%s", __FUNCTION__,
+            m_probeTime, m_streamInfoTime, m_bFastStart ? " (fast start)" : "");
   // reset any timeout
   m_timeout.SetInfinite();
 
@@ -495,9 +541,110 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       AddStream(i);
   }
 
+  // keep an index of the keyframes if the file has none of its own. formats
+  // that seek themselves fill their index as they read, for the others the
+  // packet positions are the seek points.
+  m_keyframes.Clear();
+  m_iIndexStream   = m_dllAvFormat.av_find_default_stream_index(m_pFormatContext);
+  m_bKeyframeIndex = m_iIndexStream >= 0
+                  && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE)
+                  && m_ioContext && m_ioContext->seekable
+                  && !HasUsableIndex();
+  m_bPacketIndex   = m_pFormatContext->iformat->read_seek == NULL
+                  && !(m_pFormatContext->iformat->flags & AVFMT_NO_BYTE_SEEK);
+
   return true;
 }
 
+bool CDVDDemuxFFmpeg::HasUsableIndex()
+{
+  AVStream *stream = m_pFormatContext->streams[m_iIndexStream];
+  if (stream->nb_index_entries < 2)
+    return false;
+
+  if (m_pFormatContext->duration == (int64_t)AV_NOPTS_VALUE)
+    return true;
+
+  // some formats only index what was read while probing, the
+  // index is of no use unless it reaches the end of the file
+  AVIndexEntry *last = &stream->index_entries[stream->nb_index_entries - 1];
+  double time     = ConvertTimestamp(last->timestamp, stream->time_base.den, stream->time_base.num);
+  double duration = (double)m_pFormatContext->duration * DVD_TIME_BASE / AV_TIME_BASE;
+  return time != DVD_NOPTS_VALUE && time + DVD_SEC_TO_TIME(60) >= duration;
+}
+
+void CDVDDemuxFFmpeg::SetKeyframeIndex(const CDVDKeyframeIndex& index)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bKeyframeIndex)
+    return;
+
+  m_keyframes = index;
+  if (m_bPacketIndex)
+    return;
+
+  // hand the keyframes to the format, it seeks on its own index
+  AVStream *stream = m_pFormatContext->streams[m_iIndexStream];
+  double starttime = 0.0;
+  if (m_pFormatContext->start_time != (int64_t)AV_NOPTS_VALUE)
+    starttime = (double)m_pFormatContext->start_time / AV_TIME_BASE;
+
+  for (size_t i = 0; i < index.Size(); i++)
+  {
+    double  seconds   = (double)index[i].time / 1000 + starttime;
+    int64_t timestamp = (int64_t)(seconds * stream->time_base.den / stream->time_base.num);
+    m_dllAvFormat.av_add_index_entry(stream, index[i].pos, timestamp, 0, 0, AVINDEX_KEYFRAME);
+  }
+}
+
+bool CDVDDemuxFFmpeg::GetKeyframeIndex(CDVDKeyframeIndex& index)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bKeyframeIndex)
+    return false;
+
+  if (!m_bPacketIndex)
+  {
+    AVStream *stream = m_pFormatContext->streams[m_iIndexStream];
+    for (int i = 0; i < stream->nb_index_entries; i++)
+    {
+      AVIndexEntry *entry = &stream->index_entries[i];
+      if (!(entry->flags & AVINDEX_KEYFRAME))
+        continue;
+
+      double time = ConvertTimestamp(entry->timestamp, stream->time_base.den, stream->time_base.num);
+      if (time != DVD_NOPTS_VALUE)
+        m_keyframes.Add((int64_t)(time * 1000 / DVD_TIME_BASE), entry->pos);
+    }
+  }
+
+  index = m_keyframes;
+  return m_keyframes.IsChanged();
+}
+
+bool CDVDDemuxFFmpeg::HasStreams(const CStreamDetails &details)
+{
+  int video = 0;
+  int audio = 0;
+  int subtitle = 0;
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    if (codec->codec_id == CODEC_ID_NONE)
+      continue;
+
+    if (codec->codec_type == AVMEDIA_TYPE_VIDEO && codec->width > 0 && codec->height > 0)
+      video++;
+    else if (codec->codec_type == AVMEDIA_TYPE_AUDIO && codec->channels > 0 && codec->sample_rate > 0)
+      audio++;
+    else if (codec->codec_type == AVMEDIA_TYPE_SUBTITLE)
+      subtitle++;
+  }
+  return video    >= details.GetVideoStreamCount()
+      && audio    >= details.GetAudioStreamCount()
+      && subtitle >= details.GetSubtitleStreamCount();
+}
+
 void CDVDDemuxFFmpeg::Dispose()
 {
   g_demuxer.set(this);
@@ -744,6 +891,14 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
         if (pPacket->dts != DVD_NOPTS_VALUE && (pPacket->dts > m_iCurrentPts || m_iCurrentPts == DVD_NOPTS_VALUE))
           m_iCurrentPts = pPacket->dts;
 
+        if (m_bKeyframeIndex && m_bPacketIndex && pkt.stream_index == m_iIndexStream
+        && (pkt.flags & AV_PKT_FLAG_KEY) && pkt.pos >= 0)
+        {
+          double ts = pPacket->dts != DVD_NOPTS_VALUE ? pPacket->dts : pPacket->pts;
+          if (ts != DVD_NOPTS_VALUE)
+            m_keyframes.Add((int64_t)(ts * 1000 / DVD_TIME_BASE), pkt.pos);
+        }
+
 
         // check if stream has passed full duration, needed for live streams
         if(pkt.dts != (int64_t)AV_NOPTS_VALUE)
@@ -845,10 +1000,21 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   int ret;
   {
     CSingleLock lock(m_critSection);
-    ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
+    CDVDKeyframeIndex::SEntry keyframe;
+    if (m_bKeyframeIndex && m_bPacketIndex && m_keyframes.Find(time, backwords, keyframe))
+    {
+      // the index knows where the keyframe is, no need to search for it
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, keyframe.pos, AVSEEK_FLAG_BYTE);
+      if(ret >= 0)
+        m_iCurrentPts = DVD_MSEC_TO_TIME(keyframe.time);
+    }
+    else
+    {
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
 
-    if(ret >= 0)
-      UpdateCurrentPTS();
+      if(ret >= 0)
+        UpdateCurrentPTS();
+    }
   }
 
   if(m_iCurrentPts == DVD_NOPTS_VALUE)
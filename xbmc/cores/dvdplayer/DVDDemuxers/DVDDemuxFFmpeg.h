@@ -21,6 +21,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDKeyframeIndex.h"
 #include "DllAvFormat.h"
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
@@ -29,6 +30,7 @@
 #include "threads/SystemClock.h"
 
 class CDVDDemuxFFmpeg;
+class CStreamDetails;
 
 class CDemuxStreamVideoFFmpeg
   : public CDemuxStreamVideo
@@ -80,6 +82,9 @@ public:
 #define FFMPEG_FILE_BUFFER_SIZE   32768 // default reading size for ffmpeg
 #define FFMPEG_DVDNAV_BUFFER_SIZE 2048  // for dvd's
 
+#define FFMPEG_FASTSTART_PROBESIZE        1000000 // bytes, when the stream layout is known
+#define FFMPEG_FASTSTART_ANALYZEDURATION  500000  // AV_TIME_BASE units
+
 class CDVDDemuxFFmpeg : public CDVDDemux
 {
 public:
@@ -110,6 +115,19 @@ public:
 
   bool Aborted();
 
+  /* time spent in the phases of Open, in ms */
+  unsigned int GetProbeTime() const      { return m_probeTime; }
+  unsigned int GetStreamInfoTime() const { return m_streamInfoTime; }
+  bool         IsFastStart() const       { return m_bFastStart; }
+
+  /*
+   * keyframe index for files that have no usable index of their own.
+   * GetKeyframeIndex returns false if there is nothing new to store.
+   */
+  bool UsesKeyframeIndex() const { return m_bKeyframeIndex; }
+  void SetKeyframeIndex(const CDVDKeyframeIndex& index);
+  bool GetKeyframeIndex(CDVDKeyframeIndex& index);
+
   AVFormatContext* m_pFormatContext;
 
 protected:
@@ -122,6 +140,8 @@ protected:
 
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
+  bool HasStreams(const CStreamDetails &details);
+  bool HasUsableIndex();
 
   CCriticalSection m_critSection;
   #define MAX_STREAMS 100
@@ -140,6 +160,15 @@ protected:
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
+  bool         m_bFastStart;
+  unsigned int m_probeTime;
+  unsigned int m_streamInfoTime;
+
+  bool               m_bKeyframeIndex;  // we keep an index for this file
+  bool               m_bPacketIndex;    // from packet positions, else the format builds it
+  int                m_iIndexStream;
+  CDVDKeyframeIndex  m_keyframes;
+
   CDVDInputStream* m_pInput;
 };
 
@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "DVDKeyframeIndex.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+#define KEYFRAME_INDEX_SPACING  2000   // ms
+#define KEYFRAME_INDEX_MAXGAP   12000  // ms, larger gaps are not covered by the index
+#define KEYFRAME_INDEX_MAX      4000   // entries
+
+static bool EntryBefore(const CDVDKeyframeIndex::SEntry& entry, int64_t time)
+{
+  return entry.time < time;
+}
+
+static bool TimeBefore(int64_t time, const CDVDKeyframeIndex::SEntry& entry)
+{
+  return time < entry.time;
+}
+
+CDVDKeyframeIndex::CDVDKeyframeIndex()
+{
+  m_changed = false;
+}
+
+void CDVDKeyframeIndex::Clear()
+{
+  m_entries.clear();
+  m_changed = false;
+}
+
+void CDVDKeyframeIndex::Add(int64_t time, int64_t pos)
+{
+  if (time < 0 || pos < 0 || m_entries.size() >= KEYFRAME_INDEX_MAX)
+    return;
+
+  std::vector<SEntry>::iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), time, EntryBefore);
+  if (it != m_entries.end() && it->time < time + KEYFRAME_INDEX_SPACING)
+    return;
+  if (it != m_entries.begin() && (it - 1)->time > time - KEYFRAME_INDEX_SPACING)
+    return;
+
+  SEntry entry;
+  entry.time = time;
+  entry.pos  = pos;
+  m_entries.insert(it, entry);
+  m_changed = true;
+}
+
+bool CDVDKeyframeIndex::Find(int64_t time, bool backward, SEntry& entry) const
+{
+  // the keyframes around time must both be known, otherwise
+  // playback never went past time and there may be others
+  std::vector<SEntry>::const_iterator next = std::upper_bound(m_entries.begin(), m_entries.end(), time, TimeBefore);
+  if (next == m_entries.begin())
+    return false;
+
+  std::vector<SEntry>::const_iterator prev = next - 1;
+  if (prev->time == time)
+  {
+    entry = *prev;
+    return true;
+  }
+
+  if (next == m_entries.end() || next->time - prev->time > KEYFRAME_INDEX_MAXGAP)
+    return false;
+
+  entry = backward ? *prev : *next;
+  return true;
+}
+
+CStdString CDVDKeyframeIndex::Serialize() const
+{
+  // entries are stored as the difference to the previous one
+  CStdString data;
+  int64_t time = 0;
+  int64_t pos  = 0;
+  for (std::vector<SEntry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    data.AppendFormat("%"PRId64",%"PRId64";", it->time - time, it->pos - pos);
+    time = it->time;
+    pos  = it->pos;
+  }
+  return data;
+}
+
+bool CDVDKeyframeIndex::Deserialize(const CStdString& data)
+{
+  Clear();
+
+  SEntry entry;
+  entry.time = 0;
+  entry.pos  = 0;
+  const char* ptr = data.c_str();
+  while (*ptr)
+  {
+    char* end;
+    int64_t time = strtoll(ptr, &end, 10);
+    if (end == ptr || *end != ',')
+      break;
+    ptr = end + 1;
+    int64_t pos = strtoll(ptr, &end, 10);
+    if (end == ptr || *end != ';')
+      break;
+    ptr = end + 1;
+
+    if (!m_entries.empty() && time <= 0)
+      break;
+    entry.time += time;
+    entry.pos  += pos;
+    m_entries.push_back(entry);
+  }
+
+  if (*ptr)
+  {
+    m_entries.clear();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StdString.h"
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Byte positions of the keyframes of a file, indexed by time in ms.
+ * The index is collected while the file plays and kept in the video
+ * database, so later seeks in files without a usable index of their
+ * own can go straight to a keyframe.
+ */
+class CDVDKeyframeIndex
+{
+public:
+  struct SEntry
+  {
+    int64_t time; // ms
+    int64_t pos;  // byte offset
+  };
+
+  CDVDKeyframeIndex();
+
+  void   Clear();
+  bool   IsEmpty() const                          { return m_entries.empty(); }
+  size_t Size() const                             { return m_entries.size(); }
+  const  SEntry& operator[](size_t index) const   { return m_entries[index]; }
+  bool   IsChanged() const                        { return m_changed; }
+
+  /*
+   * adds a keyframe, keyframes closer than two seconds to one
+   * that is already in the index are not stored
+   */
+  void Add(int64_t time, int64_t pos);
+
+  /*
+   * finds the last keyframe at or before time when backward is set,
+   * the first keyframe at or after time otherwise. fails if the index
+   * has a gap around time.
+   */
+  bool Find(int64_t time, bool backward, SEntry& entry) const;
+
+  CStdString Serialize() const;
+  bool       Deserialize(const CStdString& data);
+
+protected:
+  std::vector<SEntry> m_entries;
+  bool                m_changed;
+};
@@ -41,6 +41,7 @@
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
 #include "DVDCodecs/DVDCodecs.h"
+#include "DVDCodecs/DVDCodecUtils.h"
 #include "DVDCodecs/DVDFactoryCodec.h"
 #include "DVDCodecs/Video/DVDVideoCodec.h"
 #include "DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
@@ -49,6 +50,10 @@
 #include "DllSwScale.h"
 #include "filesystem/File.h"
 #include "TextureCache.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+#include <vector>
 
 
 bool CDVDFileInfo::GetFileDuration(const CStdString &path, int& duration)
@@ -89,7 +94,124 @@ int DegreeToOrientation(int degrees)
   }
 }
 
+CDVDThumbPicture::CDVDThumbPicture()
+{
+  picture     = NULL;
+  aspect      = 0.0;
+  orientation = 0;
+}
+
+CDVDThumbPicture::~CDVDThumbPicture()
+{
+  if (picture)
+    CDVDCodecUtils::FreePicture(picture);
+}
+
+/* decoders of finished thumb extractions, kept to decode the next file
+ * with the same stream parameters instead of opening a new decoder */
+#define THUMB_CODECS_MAX     4
+#define THUMB_CODECS_TIMEOUT 10000 // ms
+
+struct SThumbCodec
+{
+  CDVDStreamInfo* hint;
+  CDVDVideoCodec* codec;
+  unsigned int    time;
+};
+
+static CCriticalSection         g_thumbCodecSection;
+static std::vector<SThumbCodec> g_thumbCodecs;
+
+static void FreeThumbCodec(const SThumbCodec &entry)
+{
+  delete entry.codec;
+  delete entry.hint;
+}
+
+static CDVDVideoCodec* GetThumbCodec(CDVDStreamInfo &hint)
+{
+  CDVDVideoCodec* pVideoCodec = NULL;
+  std::vector<SThumbCodec> expired;
+  {
+    CSingleLock lock(g_thumbCodecSection);
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    std::vector<SThumbCodec>::iterator it = g_thumbCodecs.begin();
+    while (it != g_thumbCodecs.end())
+    {
+      if (!pVideoCodec && it->hint->Equal(hint, true))
+      {
+        pVideoCodec = it->codec;
+        delete it->hint;
+        it = g_thumbCodecs.erase(it);
+      }
+      else if (now - it->time > THUMB_CODECS_TIMEOUT)
+      {
+        expired.push_back(*it);
+        it = g_thumbCodecs.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+  for_each(expired.begin(), expired.end(), FreeThumbCodec);
+
+  if (pVideoCodec)
+  {
+    pVideoCodec->Reset();
+    return pVideoCodec;
+  }
+
+  if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
+  {
+    // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
+    CDVDCodecOptions dvdOptions;
+    return CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+  }
+  return CDVDFactoryCodec::CreateVideoCodec( hint );
+}
+
+static void ReleaseThumbCodec(CDVDVideoCodec* pVideoCodec, const CDVDStreamInfo &hint)
+{
+  SThumbCodec entry;
+  entry.hint  = new CDVDStreamInfo(hint, true);
+  entry.codec = pVideoCodec;
+  entry.time  = XbmcThreads::SystemClockMillis();
+
+  CSingleLock lock(g_thumbCodecSection);
+  g_thumbCodecs.push_back(entry);
+  if (g_thumbCodecs.size() > THUMB_CODECS_MAX)
+  {
+    entry = g_thumbCodecs.front();
+    g_thumbCodecs.erase(g_thumbCodecs.begin());
+    lock.Leave();
+    FreeThumbCodec(entry);
+  }
+}
+
+void CDVDFileInfo::FlushThumbCodecs()
+{
+  std::vector<SThumbCodec> codecs;
+  {
+    CSingleLock lock(g_thumbCodecSection);
+    codecs.swap(g_thumbCodecs);
+  }
+  for_each(codecs.begin(), codecs.end(), FreeThumbCodec);
+}
+
 bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails)
+{
+  unsigned int nTime = XbmcThreads::SystemClockMillis();
+
+  CDVDThumbPicture thumb;
+  DecodeThumb(strPath, thumb, pStreamDetails);
+  bool bOk = CacheThumb(thumb, details);
+
+  unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s>", __FUNCTION__, nTotalTime, strPath.c_str());
+  return bOk;
+}
+
+bool CDVDFileInfo::DecodeThumb(const CStdString &strPath, CDVDThumbPicture &thumb, CStreamDetails *pStreamDetails)
 {
   unsigned int nTime = XbmcThreads::SystemClockMillis();
   CDVDInputStream *pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, strPath, "");
@@ -157,22 +279,10 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
-
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
-    {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
-    }
-    else
-    {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
-    }
-
+    CDVDVideoCodec *pVideoCodec = GetThumbCodec(hint);
     if (pVideoCodec)
     {
       int nTotalLen = pDemuxer->GetStreamLength();
@@ -223,38 +333,20 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
         if (iDecoderState & VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
         {
+          // the picture is only valid until the next decode, keep a copy
+          // so the decoder can go on with the next file
+          thumb.picture = CDVDCodecUtils::AllocatePicture((picture.iWidth + 1) & ~1, (picture.iHeight + 1) & ~1);
+          if (thumb.picture)
           {
-            unsigned int nWidth = g_advancedSettings.GetThumbSize();
-            double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
-            if(hint.forced_aspect && hint.aspect != 0)
-              aspect = hint.aspect;
-            unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
-
-            DllSwScale dllSwScale;
-            dllSwScale.Load();
-
-            BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
-            struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
-                  PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-            uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
-            int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
-            uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-            int     dstStride[] = { nWidth*4, 0, 0, 0 };
-
-            if (context)
-            {
-              int orientation = DegreeToOrientation(hint.orientation);
-              dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              dllSwScale.sws_freeContext(context);
-
-              details.width = nWidth;
-              details.height = nHeight;
-              CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
-              bOk = true;
-            }
+            thumb.picture->iWidth  = picture.iWidth;
+            thumb.picture->iHeight = picture.iHeight;
+            CDVDCodecUtils::CopyPicture(thumb.picture, &picture);
 
-            dllSwScale.Unload();
-            delete [] pOutBuf;
+            thumb.aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
+            if(hint.forced_aspect && hint.aspect != 0)
+              thumb.aspect = hint.aspect;
+            thumb.orientation = DegreeToOrientation(hint.orientation);
+            bOk = true;
           }
         }
         else
@@ -262,7 +354,11 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
           CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, strPath.c_str(), packetsTried);
         }
       }
-      delete pVideoCodec;
+
+      if (bOk)
+        ReleaseThumbCodec(pVideoCodec, hint);
+      else
+        delete pVideoCodec;
     }
   }
 
@@ -271,6 +367,47 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
   delete pInputStream;
 
+  unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to decode thumb from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, strPath.c_str(), packetsTried);
+  return bOk;
+}
+
+bool CDVDFileInfo::CacheThumb(const CDVDThumbPicture &thumb, CTextureDetails &details)
+{
+  bool bOk = false;
+
+  if (thumb.picture)
+  {
+    const DVDVideoPicture &picture = *thumb.picture;
+    unsigned int nWidth = g_advancedSettings.GetThumbSize();
+    unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / thumb.aspect);
+
+    DllSwScale dllSwScale;
+    dllSwScale.Load();
+
+    BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
+    struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
+          PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+    uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
+    int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
+    uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
+    int     dstStride[] = { nWidth*4, 0, 0, 0 };
+
+    if (context)
+    {
+      dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+      dllSwScale.sws_freeContext(context);
+
+      details.width = nWidth;
+      details.height = nHeight;
+      CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, thumb.orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
+      bOk = true;
+    }
+
+    dllSwScale.Unload();
+    delete [] pOutBuf;
+  }
+
   if(!bOk)
   {
     XFILE::CFile file;
@@ -278,8 +415,6 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
       file.Close();
   }
 
-  unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, strPath.c_str(), packetsTried);
   return bOk;
 }
 
@@ -26,6 +26,23 @@ class CDVDDemux;
 class CStreamDetails;
 class CDVDInputStream;
 class CTextureDetails;
+struct DVDVideoPicture;
+
+// A frame decoded by CDVDFileInfo::DecodeThumb, waiting to be scaled and cached
+class CDVDThumbPicture
+{
+public:
+  CDVDThumbPicture();
+  ~CDVDThumbPicture();
+
+  DVDVideoPicture* picture;
+  double           aspect;
+  int              orientation;
+
+private:
+  CDVDThumbPicture(const CDVDThumbPicture&);
+  CDVDThumbPicture& operator=(const CDVDThumbPicture&);
+};
 
 class CDVDFileInfo
 {
@@ -33,6 +50,15 @@ public:
   // Extract a thumbnail immage from the media at strPath, optionally populating a streamdetails class with the data
   static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails);
 
+  // The two stages of ExtractThumb, so they can run on different threads.
+  // DecodeThumb opens the media and decodes a frame into thumb, CacheThumb scales it and stores it as
+  // details.file, or stores an empty file if thumb holds no frame.
+  static bool DecodeThumb(const CStdString &strPath, CDVDThumbPicture &thumb, CStreamDetails *pStreamDetails);
+  static bool CacheThumb(const CDVDThumbPicture &thumb, CTextureDetails &details);
+
+  // Frees the decoders DecodeThumb keeps around for the next file with the same stream parameters
+  static void FlushThumbCodecs();
+
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
   static bool DemuxerToStreamDetails(CDVDInputStream* pInputStream, CDVDDemux *pDemux, CStreamDetails &details, const CStdString &path = "");
@@ -159,6 +159,7 @@ public:
   virtual BitstreamStats GetBitstreamStats() const { return m_stats; }
 
   void SetFileItem(const CFileItem& item);
+  const CFileItem& GetFileItem() const { return m_item; }
 
 protected:
   DVDStreamType m_streamType;
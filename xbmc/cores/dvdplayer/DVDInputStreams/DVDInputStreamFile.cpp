@@ -30,6 +30,7 @@ CDVDInputStreamFile::CDVDInputStreamFile() : CDVDInputStream(DVDSTREAM_TYPE_FILE
 {
   m_pFile = NULL;
   m_eof = true;
+  m_bNoCache = false;
 }
 
 CDVDInputStreamFile::~CDVDInputStreamFile()
@@ -51,8 +52,12 @@ bool CDVDInputStreamFile::Open(const char* strFile, const std::string& content)
   if (!m_pFile)
     return false;
 
+  unsigned int flags = READ_TRUNCATED | READ_BITRATE | READ_CHUNKED;
+  if (m_bNoCache)
+    flags |= READ_NO_CACHE;
+
   // open file in binary mode
-  if (!m_pFile->Open(strFile, READ_TRUNCATED | READ_BITRATE | READ_CHUNKED))
+  if (!m_pFile->Open(strFile, flags))
   {
     delete m_pFile;
     m_pFile = NULL;
@@ -62,6 +67,9 @@ bool CDVDInputStreamFile::Open(const char* strFile, const std::string& content)
   if (m_pFile->GetImplemenation() && (content.empty() || content == "application/octet-stream"))
     m_content = m_pFile->GetImplemenation()->GetContent();
 
+  // demuxing reads forward, let local files read ahead further
+  m_pFile->IoControl(IOCTRL_SEQUENTIAL_ACCESS, NULL);
+
   m_eof = true;
   return true;
 }
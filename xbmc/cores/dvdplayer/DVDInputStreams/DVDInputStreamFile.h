@@ -39,7 +39,12 @@ public:
   virtual void SetReadRate(unsigned rate);
   virtual bool GetCacheStatus(XFILE::SCacheStatus *status);
 
+  /* read internet streams without the file cache, which keeps downloading while the stream
+     isn't read. has to be set before Open() */
+  void SetNoCache(bool bNoCache) { m_bNoCache = bNoCache; }
+
 protected:
   XFILE::CFile* m_pFile;
   bool m_eof;
+  bool m_bNoCache;
 };
@@ -19,7 +19,10 @@
  */
 
 #include "DVDFactoryInputStream.h"
+#include "DVDInputStreamFile.h"
 #include "DVDInputStreamPVRManager.h"
+#include "DVDTimeshiftBuffer.h"
+#include "FileItem.h"
 #include "filesystem/PVRFile.h"
 #include "URL.h"
 #include "pvr/PVRManager.h"
@@ -28,11 +31,73 @@
 #include "utils/StringUtils.h"
 #include "pvr/addons/PVRClients.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+
+#include <algorithm>
 
 using namespace XFILE;
 using namespace PVR;
 
+/************************************************************************
+ * Description: Opens the stream of a channel in the background, so
+ *              switching to that channel doesn't have to wait for it
+ *              to connect. The stream isn't cached, a cache would keep
+ *              downloading the channel until it's watched and playback
+ *              would start from that old data instead of live
+ */
+class CDVDInputStreamPreopenJob : public CJob
+{
+public:
+  CDVDInputStreamPreopenJob(IDVDPlayer* pPlayer, const std::string &strStreamURL, const std::string &content) :
+    m_pPlayer(pPlayer),
+    m_strStreamURL(strStreamURL),
+    m_content(content),
+    m_stream(NULL) {}
+
+  virtual ~CDVDInputStreamPreopenJob()
+  {
+    /* the stream wasn't claimed */
+    if (m_stream)
+    {
+      m_stream->Close();
+      delete m_stream;
+    }
+  }
+
+  virtual const char *GetType() const { return "pvr-preopen-stream"; }
+
+  virtual bool DoWork()
+  {
+    m_stream = CDVDFactoryInputStream::CreateInputStream(m_pPlayer, m_strStreamURL, m_content);
+    if (m_stream && m_stream->IsStreamType(DVDSTREAM_TYPE_FILE))
+      static_cast<CDVDInputStreamFile*>(m_stream)->SetNoCache(true);
+    if (m_stream && !m_stream->Open(m_strStreamURL.c_str(), m_content))
+    {
+      CLog::Log(LOGDEBUG, "CDVDInputStreamPreopenJob - unable to open [%s] in advance", m_strStreamURL.c_str());
+      delete m_stream;
+      m_stream = NULL;
+    }
+
+    return m_stream != NULL;
+  }
+
+  CDVDInputStream* TakeStream()
+  {
+    CDVDInputStream* stream = m_stream;
+    m_stream = NULL;
+    return stream;
+  }
+
+private:
+  IDVDPlayer*      m_pPlayer;
+  std::string      m_strStreamURL;
+  std::string      m_content;
+  CDVDInputStream* m_stream;
+};
+
 /************************************************************************
  * Description: Class constructor, initialize member variables
  *              public class is CDVDInputStream
@@ -44,6 +109,7 @@ CDVDInputStreamPVRManager::CDVDInputStreamPVRManager(IDVDPlayer* pPlayer) : CDVD
   m_pRecordable     = NULL;
   m_pLiveTV         = NULL;
   m_pOtherStream    = NULL;
+  m_pTimeshift      = NULL;
   m_eof             = true;
   m_bReopened       = false;
   m_iScanTimeout    = 0;
@@ -72,6 +138,8 @@ bool CDVDInputStreamPVRManager::IsEOF()
 
   if (m_pOtherStream)
     return m_pOtherStream->IsEOF();
+  else if (m_pTimeshift)
+    return m_pTimeshift->IsEOF();
   else
     return !m_pFile || m_eof;
 }
@@ -108,7 +176,12 @@ bool CDVDInputStreamPVRManager::Open(const char* strFile, const std::string& con
    * handler.
    */
   std::string transFile = XFILE::CPVRFile::TranslatePVRFilename(strFile);
-  if(transFile.substr(0, 6) != "pvr://")
+  if(transFile.substr(0, 6) != "pvr://" && (m_pOtherStream = TakePreopenedStream(strFile)) != NULL)
+  {
+    CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager::Open - using the stream that was opened in advance for [%s]", transFile.c_str());
+    m_pOtherStream->SetFileItem(m_item);
+  }
+  else if(transFile.substr(0, 6) != "pvr://")
   {
     m_pOtherStream = CDVDFactoryInputStream::CreateInputStream(m_pPlayer, transFile, content);
     if (!m_pOtherStream)
@@ -131,23 +204,53 @@ bool CDVDInputStreamPVRManager::Open(const char* strFile, const std::string& con
       return false;
     }
   }
+  else if (g_advancedSettings.m_iPVRTimeshiftBufferSize >= 0 &&
+      (transFile.substr(0, 18) == "pvr://channels/tv/" || transFile.substr(0, 21) == "pvr://channels/radio/"))
+  {
+    /* read live streams through a local buffer, so short stalls of the backend don't stop playback.
+       streams the backend can seek in are timeshifted by the backend, positions and length are its own */
+    if (m_pFile->IoControl(IOCTRL_SEEK_POSSIBLE, NULL) > 0)
+      CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager::Open - the backend supports seeking, not using a timeshift buffer");
+    else
+    {
+      m_pTimeshift = new CDVDTimeshiftBuffer(m_pFile, (unsigned int) g_advancedSettings.m_iPVRTimeshiftBufferSize * 1024 * 1024);
+      if (!m_pTimeshift->Open())
+      {
+        CLog::Log(LOGWARNING, "CDVDInputStreamPVRManager::Open - unable to create a timeshift buffer, reading from the backend directly");
+        delete m_pTimeshift;
+        m_pTimeshift = NULL;
+      }
+    }
+  }
 
   ResetScanTimeout((unsigned int) g_guiSettings.GetInt("pvrplayback.scantime") * 1000);
   m_content = content;
   CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager::Open - stream opened: %s", transFile.c_str());
 
+  if (std::string(strFile).substr(0, 15) == "pvr://channels/")
+    UpdatePreopenedStreams();
+
   return true;
 }
 
 // close file and reset everyting
 void CDVDInputStreamPVRManager::Close()
 {
+  ClosePreopenedStreams();
+
   if (m_pOtherStream)
   {
     m_pOtherStream->Close();
     delete m_pOtherStream;
   }
 
+  /* stop buffering before the stream it reads from is closed */
+  if (m_pTimeshift)
+  {
+    m_pTimeshift->Close();
+    delete m_pTimeshift;
+  }
+
   if (m_pFile)
   {
     m_pFile->Close();
@@ -161,6 +264,7 @@ void CDVDInputStreamPVRManager::Close()
   m_pLiveTV         = NULL;
   m_pRecordable     = NULL;
   m_pOtherStream    = NULL;
+  m_pTimeshift      = NULL;
   m_eof             = true;
 
   CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager::Close - stream closed");
@@ -174,6 +278,16 @@ int CDVDInputStreamPVRManager::Read(BYTE* buf, int buf_size)
   {
     return m_pOtherStream->Read(buf, buf_size);
   }
+  else if (m_pTimeshift)
+  {
+    int ret = m_pTimeshift->Read(buf, buf_size);
+
+    /* a read that timed out doesn't end the stream, the backend may just be slow */
+    if (ret <= 0)
+      m_eof = m_pTimeshift->IsEOF();
+
+    return ret;
+  }
   else
   {
     unsigned int ret = m_pFile->Read(buf, buf_size);
@@ -190,13 +304,24 @@ int64_t CDVDInputStreamPVRManager::Seek(int64_t offset, int whence)
   if (!m_pFile)
     return -1;
 
+  /* the timeshift buffer counts positions from the start of the stream and only keeps its
+     last part, so seeks are limited to it. it's only used if the backend can't seek */
   if (whence == SEEK_POSSIBLE)
-    return m_pFile->IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
+    return m_pTimeshift ? 0 : m_pFile->IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
 
   if (m_pOtherStream)
   {
     return m_pOtherStream->Seek(offset, whence);
   }
+  else if (m_pTimeshift)
+  {
+    int64_t ret = m_pTimeshift->Seek(offset, whence);
+
+    /* if we succeed, we are not eof anymore */
+    if( ret >= 0 ) m_eof = false;
+
+    return ret;
+  }
   else
   {
     int64_t ret = m_pFile->Seek(offset, whence);
@@ -214,10 +339,22 @@ int64_t CDVDInputStreamPVRManager::GetLength()
 
   if (m_pOtherStream)
     return m_pOtherStream->GetLength();
+  else if (m_pTimeshift)
+    return -1;
   else
     return m_pFile->GetLength();
 }
 
+bool CDVDInputStreamPVRManager::GetCacheStatus(XFILE::SCacheStatus *status)
+{
+  if (m_pOtherStream)
+    return m_pOtherStream->GetCacheStatus(status);
+  else if (m_pTimeshift)
+    return m_pTimeshift->GetCacheStatus(status);
+
+  return false;
+}
+
 int CDVDInputStreamPVRManager::GetTotalTime()
 {
   if (m_pLiveTV)
@@ -244,7 +381,15 @@ bool CDVDInputStreamPVRManager::NextChannel(bool preview/* = false*/)
       return CloseAndOpen(item->GetPath().c_str());
   }
   else if (m_pLiveTV)
-    return m_pLiveTV->NextChannel(preview);
+  {
+    if (preview)
+      return m_pLiveTV->NextChannel(preview);
+
+    StopTimeshift();
+    bool bReturn = m_pLiveTV->NextChannel(preview);
+    RestartTimeshift();
+    return bReturn;
+  }
   return false;
 }
 
@@ -260,7 +405,15 @@ bool CDVDInputStreamPVRManager::PrevChannel(bool preview/* = false*/)
       return CloseAndOpen(item->GetPath().c_str());
   }
   else if (m_pLiveTV)
-    return m_pLiveTV->PrevChannel(preview);
+  {
+    if (preview)
+      return m_pLiveTV->PrevChannel(preview);
+
+    StopTimeshift();
+    bool bReturn = m_pLiveTV->PrevChannel(preview);
+    RestartTimeshift();
+    return bReturn;
+  }
   return false;
 }
 
@@ -276,7 +429,12 @@ bool CDVDInputStreamPVRManager::SelectChannelByNumber(unsigned int iChannelNumbe
       return CloseAndOpen(item->GetPath().c_str());
   }
   else if (m_pLiveTV)
-    return m_pLiveTV->SelectChannel(iChannelNumber);
+  {
+    StopTimeshift();
+    bool bReturn = m_pLiveTV->SelectChannel(iChannelNumber);
+    RestartTimeshift();
+    return bReturn;
+  }
 
   return false;
 }
@@ -291,12 +449,42 @@ bool CDVDInputStreamPVRManager::SelectChannel(const CPVRChannel &channel)
   }
   else if (m_pLiveTV)
   {
-    return m_pLiveTV->SelectChannel(channel.ChannelNumber());
+    StopTimeshift();
+    bool bReturn = m_pLiveTV->SelectChannel(channel.ChannelNumber());
+    RestartTimeshift();
+    return bReturn;
   }
 
   return false;
 }
 
+void CDVDInputStreamPVRManager::StopTimeshift(void)
+{
+  if (m_pTimeshift)
+    m_pTimeshift->Close();
+}
+
+void CDVDInputStreamPVRManager::RestartTimeshift(void)
+{
+  if (!m_pTimeshift)
+    return;
+
+  /* the new channel is timeshifted by the backend, read from it directly */
+  if (m_pFile->IoControl(IOCTRL_SEEK_POSSIBLE, NULL) > 0)
+  {
+    CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager::RestartTimeshift - the backend supports seeking, not using a timeshift buffer");
+    delete m_pTimeshift;
+    m_pTimeshift = NULL;
+  }
+  /* reopening drops everything that was buffered of the old channel */
+  else if (!m_pTimeshift->Open())
+  {
+    CLog::Log(LOGWARNING, "CDVDInputStreamPVRManager::RestartTimeshift - unable to reopen the timeshift buffer, reading from the backend directly");
+    delete m_pTimeshift;
+    m_pTimeshift = NULL;
+  }
+}
+
 bool CDVDInputStreamPVRManager::GetSelectedChannel(CPVRChannelPtr& channel) const
 {
   return g_PVRManager.GetCurrentChannel(channel);
@@ -361,8 +549,20 @@ CStdString CDVDInputStreamPVRManager::GetInputFormat()
 
 bool CDVDInputStreamPVRManager::CloseAndOpen(const char* strFile)
 {
+  /* keep the streams that were opened in advance, the new channel may be one of them */
+  std::vector<SPreopenedStream> preopenedStreams;
+  {
+    CSingleLock lock(m_preopenSection);
+    preopenedStreams.swap(m_preopenedStreams);
+  }
+
   Close();
 
+  {
+    CSingleLock lock(m_preopenSection);
+    m_preopenedStreams.swap(preopenedStreams);
+  }
+
   if (Open(strFile, m_content))
   {
     m_bReopened = true;
@@ -378,3 +578,145 @@ bool CDVDInputStreamPVRManager::SupportsChannelSwitch(void) const
   return g_PVRClients->GetPlayingClient(client) &&
          client->HandlesInputStream();
 }
+
+bool CDVDInputStreamPVRManager::CanPreopenStream(const std::string &strStreamURL)
+{
+  /* only http streams connect when they're opened. ffmpeg handles rtp, rtsp, udp, mms and
+     hls streams and only connects once the demuxer is opened, so opening them in advance
+     doesn't save anything */
+  CFileItem item(strStreamURL, false);
+  return (StringUtils::StartsWith(strStreamURL, "http://") || StringUtils::StartsWith(strStreamURL, "https://")) &&
+         !item.IsType(".m3u8");
+}
+
+void CDVDInputStreamPVRManager::UpdatePreopenedStreams(void)
+{
+  /* collect the channels next to the playing one in the selected group */
+  std::vector<CFileItemPtr> channels;
+  CPVRChannelPtr playingChannel;
+  if (g_advancedSettings.m_iPVRPreopenChannels > 0 && g_PVRManager.GetCurrentChannel(playingChannel))
+  {
+    CPVRChannelGroupPtr group = g_PVRChannelGroups->Get(playingChannel->IsRadio())->GetSelectedGroup();
+    CFileItemPtr up(new CFileItem(*playingChannel));
+    CFileItemPtr down(up);
+    for (int iPtr = 0; group && iPtr < g_advancedSettings.m_iPVRPreopenChannels; iPtr++)
+    {
+      if (up && up->HasPVRChannelInfoTag())
+      {
+        up = group->GetByChannelUp(*up);
+        channels.push_back(up);
+      }
+      if (down && down->HasPVRChannelInfoTag())
+      {
+        down = group->GetByChannelDown(*down);
+        channels.push_back(down);
+      }
+    }
+  }
+
+  std::vector<std::string> paths;
+  std::vector<std::string> streamURLs;
+  for (unsigned int iChannelPtr = 0; iChannelPtr < channels.size(); iChannelPtr++)
+  {
+    if (!channels.at(iChannelPtr) || !channels.at(iChannelPtr)->HasPVRChannelInfoTag())
+      continue;
+
+    /* streams that are read through a client can't be opened next to the playing one */
+    const CPVRChannel *channel = channels.at(iChannelPtr)->GetPVRChannelInfoTag();
+    std::string strStreamURL = channel->StreamURL();
+    if (*channel == *playingChannel || !CanPreopenStream(strStreamURL))
+      continue;
+
+    std::string strPath = channels.at(iChannelPtr)->GetPath();
+    if (std::find(paths.begin(), paths.end(), strPath) == paths.end())
+    {
+      paths.push_back(strPath);
+      streamURLs.push_back(strStreamURL);
+    }
+  }
+
+  CSingleLock lock(m_preopenSection);
+
+  /* close the streams of channels that aren't next to the playing one anymore */
+  for (std::vector<SPreopenedStream>::iterator it = m_preopenedStreams.begin(); it != m_preopenedStreams.end();)
+  {
+    if (std::find(paths.begin(), paths.end(), it->strPath) != paths.end())
+    {
+      ++it;
+      continue;
+    }
+
+    if (it->iJobId > 0)
+      CJobManager::GetInstance().CancelJob(it->iJobId);
+    if (it->stream)
+    {
+      it->stream->Close();
+      delete it->stream;
+    }
+    it = m_preopenedStreams.erase(it);
+  }
+
+  /* and open the missing ones */
+  for (unsigned int iPathPtr = 0; iPathPtr < paths.size(); iPathPtr++)
+  {
+    bool bFound(false);
+    for (std::vector<SPreopenedStream>::const_iterator it = m_preopenedStreams.begin(); !bFound && it != m_preopenedStreams.end(); ++it)
+      bFound = it->strPath == paths.at(iPathPtr);
+    if (bFound)
+      continue;
+
+    SPreopenedStream preopened = { paths.at(iPathPtr), 0, NULL };
+    preopened.iJobId = CJobManager::GetInstance().AddJob(new CDVDInputStreamPreopenJob(m_pPlayer, streamURLs.at(iPathPtr), m_content), this);
+    m_preopenedStreams.push_back(preopened);
+    CLog::Log(LOGDEBUG, "CDVDInputStreamPVRManager - %s - opening [%s] in advance", __FUNCTION__, paths.at(iPathPtr).c_str());
+  }
+}
+
+void CDVDInputStreamPVRManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_preopenSection);
+  for (std::vector<SPreopenedStream>::iterator it = m_preopenedStreams.begin(); it != m_preopenedStreams.end(); ++it)
+  {
+    if (it->iJobId == jobID)
+    {
+      it->iJobId = 0;
+      if (success)
+        it->stream = static_cast<CDVDInputStreamPreopenJob*>(job)->TakeStream();
+      break;
+    }
+  }
+}
+
+CDVDInputStream* CDVDInputStreamPVRManager::TakePreopenedStream(const std::string &strPath)
+{
+  CSingleLock lock(m_preopenSection);
+  for (std::vector<SPreopenedStream>::iterator it = m_preopenedStreams.begin(); it != m_preopenedStreams.end(); ++it)
+  {
+    if (it->strPath == strPath)
+    {
+      CDVDInputStream* stream = it->stream;
+      if (stream)
+        m_preopenedStreams.erase(it);
+      return stream;
+    }
+  }
+
+  return NULL;
+}
+
+void CDVDInputStreamPVRManager::ClosePreopenedStreams(void)
+{
+  CSingleLock lock(m_preopenSection);
+  for (std::vector<SPreopenedStream>::iterator it = m_preopenedStreams.begin(); it != m_preopenedStreams.end(); ++it)
+  {
+    /* a stream that is still being opened is closed by its job */
+    if (it->iJobId > 0)
+      CJobManager::GetInstance().CancelJob(it->iJobId);
+    if (it->stream)
+    {
+      it->stream->Close();
+      delete it->stream;
+    }
+  }
+  m_preopenedStreams.clear();
+}
@@ -26,6 +26,10 @@
 
 #include "DVDInputStream.h"
 #include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+
+#include <vector>
 
 namespace XFILE {
 class IFile;
@@ -34,11 +38,13 @@ class IRecordable;
 }
 
 class IDVDPlayer;
+class CDVDTimeshiftBuffer;
 
 class CDVDInputStreamPVRManager
   : public CDVDInputStream
   , public CDVDInputStream::IChannel
   , public CDVDInputStream::IDisplayTime
+  , public IJobCallback
 {
 public:
   CDVDInputStreamPVRManager(IDVDPlayer* pPlayer);
@@ -50,6 +56,7 @@ public:
   virtual bool Pause(double dTime) { return false; }
   virtual bool IsEOF();
   virtual int64_t GetLength();
+  virtual bool GetCacheStatus(XFILE::SCacheStatus *status);
 
   virtual ENextStream NextStream();
 
@@ -83,19 +90,63 @@ public:
   CDVDInputStream* GetOtherStream();
 
   void ResetScanTimeout(unsigned int iTimeoutMs);
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 protected:
   bool CloseAndOpen(const char* strFile);
   bool SupportsChannelSwitch(void) const;
 
+  /*!
+   * @brief Stop the timeshift buffer before the client switches the channel of the open stream,
+   * since the buffer reads from the stream on its own thread.
+   */
+  void StopTimeshift(void);
+
+  /*!
+   * @brief Restart the timeshift buffer after a channel switch. Nothing of the old channel is kept.
+   * The buffer is dropped if the backend can seek in the new channel.
+   */
+  void RestartTimeshift(void);
+
+  /*!
+   * @brief Open the streams of the channels next to the playing one in the background.
+   * Only channels that are streamed from an URL are opened, since a client can only stream one channel at a time.
+   */
+  void UpdatePreopenedStreams(void);
+
+  /*!
+   * @return True if opening the stream in advance saves time when switching to it, false otherwise.
+   */
+  static bool CanPreopenStream(const std::string &strStreamURL);
+
+  /*!
+   * @brief Get the stream of a channel that was opened in advance.
+   * @param strPath The path of the channel.
+   * @return The opened stream, owned by the caller, or NULL if it wasn't opened in advance.
+   */
+  CDVDInputStream* TakePreopenedStream(const std::string &strPath);
+
+  void ClosePreopenedStreams(void);
+
+  struct SPreopenedStream
+  {
+    std::string      strPath; /*!< the pvr:// path of the channel */
+    unsigned int     iJobId;  /*!< the job that opens the stream, 0 once it finished */
+    CDVDInputStream* stream;  /*!< the opened stream or NULL */
+  };
+
   IDVDPlayer*               m_pPlayer;
   CDVDInputStream*          m_pOtherStream;
   XFILE::IFile*             m_pFile;
   XFILE::ILiveTVInterface*  m_pLiveTV;
   XFILE::IRecordable*       m_pRecordable;
+  CDVDTimeshiftBuffer*      m_pTimeshift;
   bool                      m_eof;
   std::string               m_strContent;
   bool                      m_bReopened;
   unsigned int              m_iScanTimeout;
+  std::vector<SPreopenedStream> m_preopenedStreams;
+  CCriticalSection          m_preopenSection;
 };
 
 
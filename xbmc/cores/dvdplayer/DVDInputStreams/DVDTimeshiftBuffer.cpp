@@ -0,0 +1,253 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDTimeshiftBuffer.h"
+#include "filesystem/IFile.h"
+#include "filesystem/CacheStrategy.h"
+#include "filesystem/CircularCache.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace XFILE;
+
+#define TIMESHIFT_READ_CHUNK_SIZE (64*1024)
+#define TIMESHIFT_READ_TIMEOUT    10000
+
+CDVDTimeshiftBuffer::CDVDTimeshiftBuffer(IFile *source, unsigned int iSize) :
+    CThread("CDVDTimeshiftBuffer"),
+    m_source(source),
+    m_cache(NULL),
+    m_iSize(iSize),
+    m_iReadPos(0),
+    m_iWritePos(0),
+    m_iStartTime(0),
+    m_iWaitTime(0),
+    m_iStalls(0),
+    m_bFull(false),
+    m_bSourceEnded(false)
+{
+}
+
+CDVDTimeshiftBuffer::~CDVDTimeshiftBuffer()
+{
+  Close();
+}
+
+bool CDVDTimeshiftBuffer::Open(void)
+{
+  Close();
+
+  if (!m_source)
+    return false;
+
+  /* keep a quarter of the buffer behind the read position, like CFileCache does */
+  if (m_iSize > 0)
+    m_cache = new CCircularCache(m_iSize, std::max<unsigned int>(m_iSize / 4, 1024 * 1024));
+  else
+    m_cache = new CSimpleFileCache();
+
+  if (m_cache->Open() != CACHE_RC_OK)
+  {
+    CLog::Log(LOGERROR, "CDVDTimeshiftBuffer::Open - failed to allocate a buffer of %u bytes", m_iSize);
+    delete m_cache;
+    m_cache = NULL;
+    return false;
+  }
+
+  m_iReadPos     = 0;
+  m_iWritePos    = 0;
+  m_iStartTime   = XbmcThreads::SystemClockMillis();
+  m_iWaitTime    = 0;
+  m_iStalls      = 0;
+  m_bFull        = false;
+  m_bSourceEnded = false;
+
+  CLog::Log(LOGDEBUG, "CDVDTimeshiftBuffer::Open - buffering %s", m_iSize > 0 ? "in memory" : "in a temporary file");
+  Create();
+
+  return true;
+}
+
+void CDVDTimeshiftBuffer::Close(void)
+{
+  m_bStop = true;
+  if (m_cache)
+    m_cache->m_space.Set();
+  StopThread();
+
+  if (!m_cache)
+    return;
+
+  CLog::Log(LOGDEBUG, "CDVDTimeshiftBuffer::Close - read %"PRId64" bytes from the source at %u bytes/s, %u reads had to wait for the source",
+      m_iWritePos, GetReadRate(), m_iStalls);
+
+  m_cache->Close();
+  delete m_cache;
+  m_cache = NULL;
+}
+
+void CDVDTimeshiftBuffer::Process(void)
+{
+  std::vector<char> buffer(TIMESHIFT_READ_CHUNK_SIZE);
+
+  while (!m_bStop)
+  {
+    int iRead = (int) m_source->Read(&buffer[0], buffer.size());
+    if (iRead <= 0)
+    {
+      /* non completing reads aren't supported by the source, so this is the end of the stream */
+      CLog::Log(LOGDEBUG, "CDVDTimeshiftBuffer::Process - end of the source stream");
+      break;
+    }
+
+    int iTotalWrite = 0;
+    while (!m_bStop && iTotalWrite < iRead)
+    {
+      int iWrite = m_cache->WriteToCache(&buffer[iTotalWrite], iRead - iTotalWrite);
+      if (iWrite < 0)
+      {
+        CLog::Log(LOGERROR, "CDVDTimeshiftBuffer::Process - error writing to the buffer");
+        m_bStop = true;
+        break;
+      }
+      else if (iWrite == 0)
+      {
+        /* the player is paused or slower than the source. wait until it read some data */
+        unsigned int iWaitStart = XbmcThreads::SystemClockMillis();
+        m_bFull = true;
+        m_cache->m_space.WaitMSec(5);
+
+        CSingleLock lock(m_critSection);
+        m_iWaitTime += XbmcThreads::SystemClockMillis() - iWaitStart;
+      }
+      else
+      {
+        m_bFull = false;
+        iTotalWrite += iWrite;
+      }
+    }
+
+    CSingleLock lock(m_critSection);
+    m_iWritePos += iTotalWrite;
+  }
+}
+
+void CDVDTimeshiftBuffer::OnExit(void)
+{
+  m_bSourceEnded = true;
+
+  /* wake up a reader that is waiting for data */
+  if (m_cache)
+    m_cache->EndOfInput();
+}
+
+int CDVDTimeshiftBuffer::Read(BYTE *buf, int buf_size)
+{
+  if (!m_cache)
+    return 0;
+
+  int iRead = m_cache->ReadFromCache((char *) buf, buf_size);
+  if (iRead == CACHE_RC_WOULD_BLOCK)
+  {
+    /* the buffer ran dry, wait for the source */
+    m_iStalls++;
+    if (m_cache->WaitForData(1, TIMESHIFT_READ_TIMEOUT) > 0)
+      iRead = m_cache->ReadFromCache((char *) buf, buf_size);
+    else
+      CLog::Log(LOGWARNING, "CDVDTimeshiftBuffer::Read - no data received from the source in %d ms", TIMESHIFT_READ_TIMEOUT);
+  }
+
+  if (iRead <= 0)
+    return 0;
+
+  CSingleLock lock(m_critSection);
+  m_iReadPos += iRead;
+
+  return iRead;
+}
+
+int64_t CDVDTimeshiftBuffer::Seek(int64_t offset, int whence)
+{
+  if (!m_cache)
+    return -1;
+
+  CSingleLock lock(m_critSection);
+
+  int64_t iTarget;
+  if (whence == SEEK_SET)
+    iTarget = offset;
+  else if (whence == SEEK_CUR)
+    iTarget = m_iReadPos + offset;
+  else
+    return -1;
+
+  if (iTarget == m_iReadPos)
+    return m_iReadPos;
+
+  /* the source can't seek, so only what's in the buffer can be reached */
+  if (m_cache->Seek(iTarget) != iTarget)
+  {
+    CLog::Log(LOGDEBUG, "CDVDTimeshiftBuffer::Seek - position %"PRId64" isn't buffered", iTarget);
+    return -1;
+  }
+
+  m_iReadPos = iTarget;
+
+  return m_iReadPos;
+}
+
+int64_t CDVDTimeshiftBuffer::GetPosition(void)
+{
+  CSingleLock lock(m_critSection);
+  return m_iReadPos;
+}
+
+bool CDVDTimeshiftBuffer::IsEOF(void)
+{
+  return !m_cache || (m_bSourceEnded && m_cache->WaitForData(0, 0) <= 0);
+}
+
+unsigned int CDVDTimeshiftBuffer::GetReadRate(void) const
+{
+  unsigned int iElapsed = XbmcThreads::SystemClockMillis() - m_iStartTime;
+  if (iElapsed <= m_iWaitTime)
+    return 0;
+
+  /* time spent waiting for the player doesn't count against the source */
+  return (unsigned int) (1000 * m_iWritePos / (iElapsed - m_iWaitTime));
+}
+
+bool CDVDTimeshiftBuffer::GetCacheStatus(SCacheStatus *status)
+{
+  if (!m_cache)
+    return false;
+
+  CSingleLock lock(m_critSection);
+  status->forward = m_cache->WaitForData(0, 0);
+  status->maxrate = 0;
+  status->currate = GetReadRate();
+  status->full    = m_bFull;
+
+  return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "filesystem/IFileTypes.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+namespace XFILE
+{
+  class IFile;
+  class CCacheStrategy;
+}
+
+/*!
+ * Local buffer for a live stream.
+ *
+ * A background thread keeps reading from the source into a memory ring
+ * buffer or a temporary file, so the player reads from local storage and
+ * keeps going while the source stalls for a moment. Data that was already
+ * read stays available until it is overwritten, so the player can seek
+ * back within the buffer. While playback is paused the buffer keeps
+ * filling until it is full.
+ */
+class CDVDTimeshiftBuffer : private CThread
+{
+public:
+  /*!
+   * @param source The stream to buffer. It has to be open and stay open until Close() was called.
+   * @param iSize The size of the memory buffer in bytes or 0 to buffer in a temporary file.
+   */
+  CDVDTimeshiftBuffer(XFILE::IFile *source, unsigned int iSize);
+  virtual ~CDVDTimeshiftBuffer();
+
+  /*!
+   * @brief Allocate the buffer and start reading from the source.
+   * @return True if the buffer was opened, false otherwise.
+   */
+  bool Open(void);
+
+  /*!
+   * @brief Stop reading from the source and release the buffer.
+   */
+  void Close(void);
+
+  /*!
+   * @brief Read from the buffer. Waits for the source if nothing is buffered.
+   * @return The amount of bytes read or 0 if no data arrived in time or the source ended.
+   */
+  int Read(BYTE *buf, int buf_size);
+
+  /*!
+   * @brief Seek within the buffered data. SEEK_END isn't supported, since the end of a live stream isn't known.
+   * @return The new position or -1 if the position isn't buffered.
+   */
+  int64_t Seek(int64_t offset, int whence);
+
+  /*!
+   * @return The read position in the stream.
+   */
+  int64_t GetPosition(void);
+
+  /*!
+   * @return True if the source ended and everything was read from the buffer.
+   */
+  bool IsEOF(void);
+
+  /*!
+   * @brief Get the buffer fill ahead of the read position and the average read rate from the source.
+   * @return True if the status was filled in, false if the buffer isn't open.
+   */
+  bool GetCacheStatus(XFILE::SCacheStatus *status);
+
+protected:
+  virtual void Process(void);
+  virtual void OnExit(void);
+
+  unsigned int GetReadRate(void) const;
+
+  XFILE::IFile          *m_source;       /*!< the stream that is buffered */
+  XFILE::CCacheStrategy *m_cache;        /*!< the ring buffer or temporary file */
+  unsigned int           m_iSize;        /*!< size of the memory buffer in bytes, 0 for a temporary file */
+  int64_t                m_iReadPos;     /*!< position of the player in the stream */
+  int64_t                m_iWritePos;    /*!< amount of bytes read from the source */
+  unsigned int           m_iStartTime;   /*!< time the source was opened */
+  unsigned int           m_iWaitTime;    /*!< time spent waiting for space in a full buffer */
+  unsigned int           m_iStalls;      /*!< amount of reads that had to wait for the source */
+  bool                   m_bFull;        /*!< true if the buffer is full */
+  bool                   m_bSourceEnded; /*!< true if the source didn't return any more data */
+  CCriticalSection       m_critSection;
+};
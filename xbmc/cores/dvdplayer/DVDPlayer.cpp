@@ -68,6 +68,7 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/StreamDetails.h"
+#include "video/VideoDatabase.h"
 #include "pvr/PVRManager.h"
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/windows/GUIWindowPVR.h"
@@ -410,12 +411,14 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
   m_pInputStream = NULL;
 
   m_dvd.Clear();
+  m_ChannelSwitchStats.Clear();
   m_State.Clear();
   m_EdlAutoSkipMarkers.Clear();
   m_UpdateApplication = 0;
 
   m_bAbortRequest = false;
   m_errorCount = 0;
+  m_iFirstPacketStart = 0;
   m_offset_pts = 0.0;
   m_playSpeed = DVD_PLAYSPEED_NORMAL;
   m_caching = CACHESTATE_DONE;
@@ -577,8 +580,24 @@ retry:
     return false;
   }
   else
-    m_pInputStream->SetFileItem(m_item);
+  {
+    // the demuxer can start faster when it knows the stream layout, look it
+    // up in the video database if the item was not played from the library
+    CFileItem item(m_item);
+    if (g_advancedSettings.m_videoFastStart && item.IsVideo()
+    && !(item.HasVideoInfoTag() && item.GetVideoInfoTag()->HasStreamDetails()))
+    {
+      CVideoDatabase db;
+      if (db.Open())
+      {
+        db.GetStreamDetailsForFile(item.GetPath(), item.GetVideoInfoTag()->m_streamDetails);
+        db.Close();
+      }
+    }
+    m_pInputStream->SetFileItem(item);
+  }
 
+  unsigned int start = XbmcThreads::SystemClockMillis();
   if (!m_pInputStream->Open(m_filename.c_str(), m_mimetype))
   {
       if(m_pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD))
@@ -598,6 +617,11 @@ retry:
     return false;
   }
 
+  { CSingleLock lock(m_StateSection);
+    m_StartTimes = CPlayerStartTimes();
+    m_StartTimes.inputopen = XbmcThreads::SystemClockMillis() - start;
+  }
+
   // find any available external subtitles for non dvd files
   if (!m_pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD)
   &&  !m_pInputStream->IsStreamType(DVDSTREAM_TYPE_PVRMANAGER)
@@ -640,6 +664,7 @@ retry:
   m_dvd.Clear();
   m_errorCount = 0;
   m_iChannelEntryTimeOut = 0;
+  m_ChannelSwitchStats.Clear();
 
   return true;
 }
@@ -694,6 +719,45 @@ bool CDVDPlayer::OpenDemuxStream()
   return true;
 }
 
+void CDVDPlayer::LoadKeyframeIndex()
+{
+  CDVDDemuxFFmpeg* pDemuxer = dynamic_cast<CDVDDemuxFFmpeg*>(m_pDemuxer);
+  if (!pDemuxer || !pDemuxer->UsesKeyframeIndex() || !m_item.IsVideo() || m_PlayerOptions.identify)
+    return;
+
+  CVideoDatabase db;
+  if (!db.Open())
+    return;
+
+  CStdString data;
+  CDVDKeyframeIndex index;
+  if (db.GetKeyframeIndex(m_filename, data) && index.Deserialize(data))
+  {
+    CLog::Log(LOGDEBUG, "%s - loaded %u keyframes", __FUNCTION__, (unsigned int)index.Size());
+    pDemuxer->SetKeyframeIndex(index);
+  }
+  db.Close();
+}
+
+void CDVDPlayer::SaveKeyframeIndex()
+{
+  CDVDDemuxFFmpeg* pDemuxer = dynamic_cast<CDVDDemuxFFmpeg*>(m_pDemuxer);
+  if (!pDemuxer || !m_item.IsVideo() || m_PlayerOptions.identify)
+    return;
+
+  CDVDKeyframeIndex index;
+  if (!pDemuxer->GetKeyframeIndex(index))
+    return;
+
+  CVideoDatabase db;
+  if (db.Open())
+  {
+    CLog::Log(LOGDEBUG, "%s - storing %u keyframes", __FUNCTION__, (unsigned int)index.Size());
+    db.SetKeyframeIndex(m_filename, index.Serialize());
+    db.Close();
+  }
+}
+
 void CDVDPlayer::OpenDefaultStreams()
 {
   // bypass for DVDs. The DVD Navigator has already dictated which streams to open.
@@ -953,11 +1017,27 @@ void CDVDPlayer::Process()
     return;
   }
 
+  CDVDDemuxFFmpeg* pDemuxer = dynamic_cast<CDVDDemuxFFmpeg*>(m_pDemuxer);
+  if (pDemuxer)
+  {
+    CSingleLock lock(m_StateSection);
+    m_StartTimes.probe      = pDemuxer->GetProbeTime();
+    m_StartTimes.streaminfo = pDemuxer->GetStreamInfoTime();
+    m_StartTimes.faststart  = pDemuxer->IsFastStart();
+  }
+  m_iFirstPacketStart = XbmcThreads::SystemClockMillis();
+
+  LoadKeyframeIndex();
+
   // allow renderer to switch to fullscreen if requested
   m_dvdPlayerVideo.EnableFullscreen(m_PlayerOptions.fullscreen);
 
   OpenDefaultStreams();
 
+  // codecs kept from the previous file that did not match any stream
+  m_dvdPlayerAudio.ReleaseKeptCodec();
+  m_dvdPlayerVideo.ReleaseKeptCodec();
+
   // look for any EDL files
   m_Edl.Clear();
   m_EdlAutoSkipMarkers.Clear();
@@ -1111,6 +1191,15 @@ void CDVDPlayer::Process()
     DemuxPacket* pPacket = NULL;
     CDemuxStream *pStream = NULL;
     ReadPacket(pPacket, pStream);
+    if (pPacket && m_iFirstPacketStart)
+    {
+      CSingleLock lock(m_StateSection);
+      m_StartTimes.firstpacket = XbmcThreads::SystemClockMillis() - m_iFirstPacketStart;
+      m_iFirstPacketStart = 0;
+      CLog::Log(LOGNOTICE, "CDVDPlayer::Process - start times: input open %u ms, probe %u ms, stream info %u ms, first packet %u ms%s",
+                m_StartTimes.inputopen, m_StartTimes.probe, m_StartTimes.streaminfo,
+                m_StartTimes.firstpacket, m_StartTimes.faststart ? " (fast start)" : "");
+    }
     if (pPacket && !pStream)
     {
       /* probably a empty packet, just free it and move on */
@@ -1248,6 +1337,28 @@ bool CDVDPlayer::CheckDelayedChannelEntry(void)
   return bReturn;
 }
 
+void CDVDPlayer::StartChannelSwitch(void)
+{
+  m_ChannelSwitchStats.start = XbmcThreads::SystemClockMillis();
+}
+
+void CDVDPlayer::FinishChannelSwitch(void)
+{
+  if (m_ChannelSwitchStats.start == 0)
+    return;
+
+  /* the switch is done once the first picture, or the first audio for radio, was played */
+  unsigned int iLatency = XbmcThreads::SystemClockMillis() - m_ChannelSwitchStats.start;
+  unsigned int iBucket = 0;
+  for (unsigned int iLimit = 250; iBucket < 5 && iLatency >= iLimit; iLimit *= 2)
+    iBucket++;
+
+  m_ChannelSwitchStats.count[iBucket]++;
+  m_ChannelSwitchStats.start = 0;
+
+  CLog::Log(LOGDEBUG, "CDVDPlayer::FinishChannelSwitch - channel switch took %u ms", iLatency);
+}
+
 void CDVDPlayer::ProcessPacket(CDemuxStream* pStream, DemuxPacket* pPacket)
 {
     /* process packet if it belongs to selected stream. for dvd's don't allow automatic opening of streams*/
@@ -1928,17 +2039,23 @@ void CDVDPlayer::OnExit()
     // set event to inform openfile something went wrong in case openfile is still waiting for this event
     SetCaching(CACHESTATE_DONE);
 
-    // close each stream
+    // codecs kept from the previous file are still around if this one
+    // failed to open before its streams were
+    m_dvdPlayerAudio.ReleaseKeptCodec();
+    m_dvdPlayerVideo.ReleaseKeptCodec();
+
+    // close each stream, when the file played to its end the codecs
+    // are kept in case the next file uses the same ones
     if (!m_bAbortRequest) CLog::Log(LOGNOTICE, "DVDPlayer: eof, waiting for queues to empty");
     if (m_CurrentAudio.id >= 0)
     {
       CLog::Log(LOGNOTICE, "DVDPlayer: closing audio stream");
-      CloseAudioStream(!m_bAbortRequest);
+      CloseAudioStream(!m_bAbortRequest, !m_bAbortRequest);
     }
     if (m_CurrentVideo.id >= 0)
     {
       CLog::Log(LOGNOTICE, "DVDPlayer: closing video stream");
-      CloseVideoStream(!m_bAbortRequest);
+      CloseVideoStream(!m_bAbortRequest, !m_bAbortRequest);
     }
     if (m_CurrentSubtitle.id >= 0)
     {
@@ -1953,6 +2070,7 @@ void CDVDPlayer::OnExit()
     // destroy the demuxer
     if (m_pDemuxer)
     {
+      SaveKeyframeIndex();
       CLog::Log(LOGNOTICE, "CDVDPlayer::OnExit() deleting demuxer");
       delete m_pDemuxer;
     }
@@ -1973,6 +2091,11 @@ void CDVDPlayer::OnExit()
     }
     m_pInputStream = NULL;
 
+    const unsigned int *count = m_ChannelSwitchStats.count;
+    if (count[0] + count[1] + count[2] + count[3] + count[4] + count[5] > 0)
+      CLog::Log(LOGNOTICE, "CDVDPlayer::OnExit() channel switches: <250ms: %u, <500ms: %u, <1s: %u, <2s: %u, <4s: %u, >=4s: %u",
+          count[0], count[1], count[2], count[3], count[4], count[5]);
+
     // clean up all selection streams
     m_SelectionStreams.Clear(STREAM_NONE, STREAM_SOURCE_NONE);
 
@@ -2204,6 +2327,7 @@ void CDVDPlayer::HandleMessages()
       else if (pMsg->IsType(CDVDMsg::PLAYER_CHANNEL_SELECT_NUMBER) && m_messenger.GetPacketCount(CDVDMsg::PLAYER_CHANNEL_SELECT_NUMBER) == 0)
       {
         FlushBuffers(false);
+        StartChannelSwitch();
         CDVDInputStream::IChannel* input = dynamic_cast<CDVDInputStream::IChannel*>(m_pInputStream);
         if(input && input->SelectChannelByNumber(static_cast<CDVDMsgInt*>(pMsg)->m_value))
         {
@@ -2217,6 +2341,7 @@ void CDVDPlayer::HandleMessages()
       else if (pMsg->IsType(CDVDMsg::PLAYER_CHANNEL_SELECT) && m_messenger.GetPacketCount(CDVDMsg::PLAYER_CHANNEL_SELECT) == 0)
       {
         FlushBuffers(false);
+        StartChannelSwitch();
         CDVDInputStream::IChannel* input = dynamic_cast<CDVDInputStream::IChannel*>(m_pInputStream);
         if(input && input->SelectChannel(static_cast<CDVDMsgType <CPVRChannel> *>(pMsg)->m_value))
         {
@@ -2239,6 +2364,7 @@ void CDVDPlayer::HandleMessages()
           {
             g_infoManager.SetDisplayAfterSeek(100000);
             FlushBuffers(false);
+            StartChannelSwitch();
           }
 
           if(pMsg->IsType(CDVDMsg::PLAYER_CHANNEL_NEXT))
@@ -2278,6 +2404,9 @@ void CDVDPlayer::HandleMessages()
         if(player == DVDPLAYER_VIDEO)
           m_CurrentVideo.started = true;
         CLog::Log(LOGDEBUG, "CDVDPlayer::HandleMessages - player started %d", player);
+
+        if(player == DVDPLAYER_VIDEO || m_CurrentVideo.id < 0)
+          FinishChannelSwitch();
       }
     }
     catch (...)
@@ -3042,7 +3171,7 @@ bool CDVDPlayer::OpenTeletextStream(int iStream, int source)
   return true;
 }
 
-bool CDVDPlayer::CloseAudioStream(bool bWaitForBuffers)
+bool CDVDPlayer::CloseAudioStream(bool bWaitForBuffers, bool bKeepCodec)
 {
   if (m_CurrentAudio.id < 0)
     return false;
@@ -3052,13 +3181,13 @@ bool CDVDPlayer::CloseAudioStream(bool bWaitForBuffers)
   if(bWaitForBuffers)
     SetCaching(CACHESTATE_DONE);
 
-  m_dvdPlayerAudio.CloseStream(bWaitForBuffers);
+  m_dvdPlayerAudio.CloseStream(bWaitForBuffers, bKeepCodec);
 
   m_CurrentAudio.Clear();
   return true;
 }
 
-bool CDVDPlayer::CloseVideoStream(bool bWaitForBuffers)
+bool CDVDPlayer::CloseVideoStream(bool bWaitForBuffers, bool bKeepCodec)
 {
   if (m_CurrentVideo.id < 0)
     return false;
@@ -3068,7 +3197,7 @@ bool CDVDPlayer::CloseVideoStream(bool bWaitForBuffers)
   if(bWaitForBuffers)
     SetCaching(CACHESTATE_DONE);
 
-  m_dvdPlayerVideo.CloseStream(bWaitForBuffers);
+  m_dvdPlayerVideo.CloseStream(bWaitForBuffers, bKeepCodec);
 
   m_CurrentVideo.Clear();
   return true;
@@ -3993,6 +4122,13 @@ bool CDVDPlayer::GetStreamDetails(CStreamDetails &details)
     return false;
 }
 
+bool CDVDPlayer::GetStartTimes(CPlayerStartTimes &times)
+{
+  CSingleLock lock(m_StateSection);
+  times = m_StartTimes;
+  return true;
+}
+
 CStdString CDVDPlayer::GetPlayingTitle()
 {
   /* Currently we support only Title Name from Teletext line 30 */
@@ -240,6 +240,7 @@ public:
   virtual int GetPictureWidth();
   virtual int GetPictureHeight();
   virtual bool GetStreamDetails(CStreamDetails &details);
+  virtual bool GetStartTimes(CPlayerStartTimes &times);
 
   virtual bool GetCurrentSubtitle(CStdString& strSubtitle);
 
@@ -281,8 +282,8 @@ protected:
   bool OpenVideoStream(int iStream, int source);
   bool OpenSubtitleStream(int iStream, int source);
   bool OpenTeletextStream(int iStream, int source);
-  bool CloseAudioStream(bool bWaitForBuffers);
-  bool CloseVideoStream(bool bWaitForBuffers);
+  bool CloseAudioStream(bool bWaitForBuffers, bool bKeepCodec = false);
+  bool CloseVideoStream(bool bWaitForBuffers, bool bKeepCodec = false);
   bool CloseSubtitleStream(bool bKeepOverlays);
   bool CloseTeletextStream(bool bWaitForBuffers);
 
@@ -330,11 +331,16 @@ protected:
   bool IsValidStream(CCurrentStream& stream);
   bool IsBetterStream(CCurrentStream& current, CDemuxStream* stream);
   bool CheckDelayedChannelEntry(void);
+  void StartChannelSwitch(void);
+  void FinishChannelSwitch(void);
 
   bool OpenInputStream();
   bool OpenDemuxStream();
   void OpenDefaultStreams();
 
+  void LoadKeyframeIndex();
+  void SaveKeyframeIndex();
+
   void UpdateApplication(double timeout);
   void UpdatePlayState(double timeout);
   double m_UpdateApplication;
@@ -347,6 +353,18 @@ protected:
   CFileItem    m_item;
   unsigned int m_iChannelEntryTimeOut;
 
+  struct SChannelSwitchStats
+  {
+    void Clear()
+    {
+      start = 0;
+      memset(count, 0, sizeof(count));
+    }
+
+    unsigned int start;    // time the pending channel switch was requested, 0 if there is none
+    unsigned int count[6]; // switches that took less than 250ms, 500ms, 1s, 2s, 4s and longer
+  } m_ChannelSwitchStats;
+
 
   CCurrentStream m_CurrentAudio;
   CCurrentStream m_CurrentVideo;
@@ -449,6 +467,9 @@ protected:
   } m_State;
   CCriticalSection m_StateSection;
 
+  CPlayerStartTimes m_StartTimes;   // protected by m_StateSection
+  unsigned int      m_iFirstPacketStart;
+
   CEvent m_ready;
   CCriticalSection m_critStreamSection; // need to have this lock when switching streams (audio / video)
 
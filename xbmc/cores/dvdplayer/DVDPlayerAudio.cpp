@@ -161,6 +161,8 @@ CDVDPlayerAudio::CDVDPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent)
 {
   m_pClock = pClock;
   m_pAudioCodec = NULL;
+  m_pKeptCodec = NULL;
+  m_keptPassthrough = false;
   m_audioClock = 0;
   m_droptime = 0;
   m_speed = DVD_PLAYSPEED_NORMAL;
@@ -196,14 +198,28 @@ CDVDPlayerAudio::~CDVDPlayerAudio()
 
   // close the stream, and don't wait for the audio to be finished
   // CloseStream(true);
+  ReleaseKeptCodec();
 }
 
 bool CDVDPlayerAudio::OpenStream( CDVDStreamInfo &hints )
 {
   bool passthrough = AUDIO_IS_BITSTREAM(g_guiSettings.GetInt("audiooutput.mode"));
 
-  CLog::Log(LOGNOTICE, "Finding audio codec for: %i", hints.codec);
-  CDVDAudioCodec* codec = CDVDFactoryCodec::CreateAudioCodec(hints, passthrough);
+  CDVDAudioCodec* codec = NULL;
+  if( m_pKeptCodec && m_keptPassthrough == passthrough && m_keptHints.Equal(hints, true) )
+  {
+    CLog::Log(LOGNOTICE, "Reusing audio codec for: %i", hints.codec);
+    codec = m_pKeptCodec;
+    codec->Reset();
+    m_pKeptCodec = NULL;
+  }
+  ReleaseKeptCodec();
+
+  if( !codec )
+  {
+    CLog::Log(LOGNOTICE, "Finding audio codec for: %i", hints.codec);
+    codec = CDVDFactoryCodec::CreateAudioCodec(hints, passthrough);
+  }
   if( !codec )
   {
     CLog::Log(LOGERROR, "Unsupported audio codec");
@@ -228,6 +244,7 @@ void CDVDPlayerAudio::OpenStream( CDVDStreamInfo &hints, CDVDAudioCodec* codec )
   m_pAudioCodec = codec;
 
   /* store our stream hints */
+  m_hints = hints;
   m_streaminfo = hints;
 
   /* update codec information from what codec gave ut */
@@ -263,7 +280,7 @@ void CDVDPlayerAudio::OpenStream( CDVDStreamInfo &hints, CDVDAudioCodec* codec )
   m_maxspeedadjust = g_guiSettings.GetFloat("videoplayer.maxspeedadjust");
 }
 
-void CDVDPlayerAudio::CloseStream(bool bWaitForBuffers)
+void CDVDPlayerAudio::CloseStream(bool bWaitForBuffers, bool bKeepCodec)
 {
   bool bWait = bWaitForBuffers && m_speed > 0 && !CAEFactory::IsSuspended();
 
@@ -279,18 +296,33 @@ void CDVDPlayerAudio::CloseStream(bool bWaitForBuffers)
   StopThread(); // will set this->m_bStop to true
 
   // destroy audio device
-  CLog::Log(LOGNOTICE, "Closing audio device");
   if (bWait)
   {
     m_bStop = false;
     m_dvdAudio.Drain();
     m_bStop = true;
   }
-  m_dvdAudio.Destroy();
 
   // uninit queue
   m_messageQueue.End();
 
+  // keep the codec and the audio device open in case the next stream matches
+  if (m_pAudioCodec && bKeepCodec)
+  {
+    CLog::Log(LOGNOTICE, "Keeping audio device and codec for the next stream");
+    m_dvdAudio.Flush();
+    ReleaseKeptCodec();
+    m_pKeptCodec = m_pAudioCodec;
+    m_keptHints = m_hints;
+    m_keptPassthrough = AUDIO_IS_BITSTREAM(g_guiSettings.GetInt("audiooutput.mode"));
+    m_pAudioCodec = NULL;
+  }
+  else
+  {
+    CLog::Log(LOGNOTICE, "Closing audio device");
+    m_dvdAudio.Destroy();
+  }
+
   CLog::Log(LOGNOTICE, "Deleting audio codec");
   if (m_pAudioCodec)
   {
@@ -303,6 +335,18 @@ void CDVDPlayerAudio::CloseStream(bool bWaitForBuffers)
   m_ptsOutput.Flush();
 }
 
+void CDVDPlayerAudio::ReleaseKeptCodec()
+{
+  if (m_pKeptCodec)
+  {
+    CLog::Log(LOGNOTICE, "Closing kept audio device and codec");
+    m_dvdAudio.Destroy();
+    m_pKeptCodec->Dispose();
+    delete m_pKeptCodec;
+    m_pKeptCodec = NULL;
+  }
+}
+
 // decode one audio frame and returns its uncompressed size
 int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
 {
@@ -98,7 +98,8 @@ public:
 
   bool OpenStream(CDVDStreamInfo &hints);
   void OpenStream(CDVDStreamInfo &hints, CDVDAudioCodec* codec);
-  void CloseStream(bool bWaitForBuffers);
+  void CloseStream(bool bWaitForBuffers, bool bKeepCodec = false);
+  void ReleaseKeptCodec();
 
   void RegisterAudioCallback(IAudioCallback* pCallback) { m_dvdAudio.RegisterAudioCallback(pCallback); }
   void UnRegisterAudioCallback()                        { m_dvdAudio.UnRegisterAudioCallback(); }
@@ -191,6 +192,12 @@ protected:
   CDVDAudio m_dvdAudio; // audio output device
   CDVDClock* m_pClock; // dvd master clock
   CDVDAudioCodec* m_pAudioCodec; // audio codec
+  CDVDStreamInfo  m_hints;       // hints the audio codec was opened with
+
+  // codec of the previous stream, kept for reuse together with the audio device
+  CDVDAudioCodec* m_pKeptCodec;
+  CDVDStreamInfo  m_keptHints;
+  bool            m_keptPassthrough;
   BitstreamStats m_audioStats;
 
   int     m_speed;
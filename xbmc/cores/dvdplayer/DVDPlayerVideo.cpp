@@ -130,6 +130,7 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
   m_pOverlayContainer = pOverlayContainer;
   m_pTempOverlayPicture = NULL;
   m_pVideoCodec = NULL;
+  m_pKeptCodec = NULL;
   m_pOverlayCodecCC = NULL;
   m_speed = DVD_PLAYSPEED_NORMAL;
 
@@ -143,6 +144,7 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
   m_iDroppedRequest = 0;
   m_fForcedAspectRatio = 0;
   m_iNrOfPicturesNotToSkip = 0;
+  m_iPacketsSinceReset = 0;
   m_messageQueue.SetMaxDataSize(40 * 1024 * 1024);
   m_messageQueue.SetMaxTimeSize(8.0);
   g_dvdPerformanceCounter.EnableVideoQueue(&m_messageQueue);
@@ -169,6 +171,7 @@ CDVDPlayerVideo::~CDVDPlayerVideo()
   StopThread();
   g_dvdPerformanceCounter.DisableVideoQueue();
   g_VideoReferenceClock.StopThread();
+  ReleaseKeptCodec();
 }
 
 double CDVDPlayerVideo::GetOutputDelay()
@@ -195,8 +198,21 @@ bool CDVDPlayerVideo::OpenStream( CDVDStreamInfo &hint )
 #endif
 
 
-  CLog::Log(LOGNOTICE, "Creating video codec with codec id: %i", hint.codec);
-  CDVDVideoCodec* codec = CDVDFactoryCodec::CreateVideoCodec(hint, surfaces, formats);
+  CDVDVideoCodec* codec = NULL;
+  if(m_pKeptCodec && m_keptHints.Equal(hint, true))
+  {
+    CLog::Log(LOGNOTICE, "Reusing video codec %s for codec id: %i", m_pKeptCodec->GetName(), hint.codec);
+    codec = m_pKeptCodec;
+    codec->Reset();
+    m_pKeptCodec = NULL;
+  }
+  ReleaseKeptCodec();
+
+  if(!codec)
+  {
+    CLog::Log(LOGNOTICE, "Creating video codec with codec id: %i", hint.codec);
+    codec = CDVDFactoryCodec::CreateVideoCodec(hint, surfaces, formats);
+  }
   if(!codec)
   {
     CLog::Log(LOGERROR, "Unsupported video codec");
@@ -239,6 +255,7 @@ void CDVDPlayerVideo::OpenStream(CDVDStreamInfo &hint, CDVDVideoCodec* codec)
 
   m_iDroppedRequest = 0;
   m_iLateFrames = 0;
+  m_iPacketsSinceReset = 0;
   m_autosync = 1;
 
   if( m_fFrameRate > 100 || m_fFrameRate < 5 )
@@ -263,7 +280,7 @@ void CDVDPlayerVideo::OpenStream(CDVDStreamInfo &hint, CDVDVideoCodec* codec)
   m_codecname = m_pVideoCodec->GetName();
 }
 
-void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
+void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers, bool bKeepCodec)
 {
   // wait until buffers are empty
   if (bWaitForBuffers && m_speed > 0) m_messageQueue.WaitUntilEmpty();
@@ -277,9 +294,17 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
 
   m_messageQueue.End();
 
-  CLog::Log(LOGNOTICE, "deleting video codec");
-  if (m_pVideoCodec)
+  if (m_pVideoCodec && bKeepCodec && m_pVideoCodec->CanReuse())
   {
+    CLog::Log(LOGNOTICE, "keeping video codec for the next stream");
+    ReleaseKeptCodec();
+    m_pKeptCodec = m_pVideoCodec;
+    m_keptHints = m_hints;
+    m_pVideoCodec = NULL;
+  }
+  else if (m_pVideoCodec)
+  {
+    CLog::Log(LOGNOTICE, "deleting video codec");
     m_pVideoCodec->Dispose();
     delete m_pVideoCodec;
     m_pVideoCodec = NULL;
@@ -295,6 +320,17 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
   m_pClock->UpdateFramerate(0.0);
 }
 
+void CDVDPlayerVideo::ReleaseKeptCodec()
+{
+  if (m_pKeptCodec)
+  {
+    CLog::Log(LOGNOTICE, "deleting kept video codec");
+    m_pKeptCodec->Dispose();
+    delete m_pKeptCodec;
+    m_pKeptCodec = NULL;
+  }
+}
+
 void CDVDPlayerVideo::OnStartup()
 {
   m_iDroppedFrames = 0;
@@ -435,6 +471,7 @@ void CDVDPlayerVideo::Process()
         m_pVideoCodec->Reset();
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
       m_packets.clear();
+      m_iPacketsSinceReset = 0;
       m_started = false;
     }
     else if (pMsg->IsType(CDVDMsg::GENERAL_FLUSH)) // private message sent by (CDVDPlayerVideo::Flush())
@@ -443,6 +480,7 @@ void CDVDPlayerVideo::Process()
         m_pVideoCodec->Reset();
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
       m_packets.clear();
+      m_iPacketsSinceReset = 0;
 
       m_pullupCorrection.Flush();
       //we need to recalculate the framerate
@@ -478,6 +516,24 @@ void CDVDPlayerVideo::Process()
       msg->m_codec = NULL;
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
     }
+    else if (pMsg->IsType(CDVDMsg::GENERAL_EOF))
+    {
+      CLog::Log(LOGDEBUG, "CDVDPlayerVideo - CDVDMsg::GENERAL_EOF");
+
+      // decode an empty packet so the codec outputs the pictures
+      // it still holds back, a frame threaded decoder keeps several
+      DemuxPacket* pPacket = CDVDDemuxUtils::AllocateDemuxPacket(0);
+      if (m_pVideoCodec && pPacket)
+      {
+        pPacket->dts = DVD_NOPTS_VALUE;
+        pPacket->pts = DVD_NOPTS_VALUE;
+        m_pVideoCodec->Drain();
+        pMsg->Release();
+        pMsg = new CDVDMsgDemuxerPacket(pPacket);
+      }
+      else if (pPacket)
+        CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+    }
 
     if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
     {
@@ -555,11 +611,14 @@ void CDVDPlayerVideo::Process()
       }
 
       m_videoStats.AddSampleBytes(pPacket->iSize);
+      m_iPacketsSinceReset++;
       // assume decoder dropped a picture if it didn't give us any
       // picture from a demux packet, this should be reasonable
       // for libavformat as a demuxer as it normally packetizes
-      // pictures when they come from demuxer
-      if(bRequestDrop && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
+      // pictures when they come from demuxer. a frame threaded
+      // decoder holds back the first few packets after a reset.
+      if(bRequestDrop && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE)
+      && m_iPacketsSinceReset > m_pVideoCodec->GetFrameDelay())
       {
         m_iDroppedFrames++;
         iDropped++;
@@ -586,6 +645,7 @@ void CDVDPlayerVideo::Process()
 
           m_pVideoCodec->Reset();
           m_packets.clear();
+          m_iPacketsSinceReset = 0;
           break;
         }
 
@@ -602,6 +662,7 @@ void CDVDPlayerVideo::Process()
 
           // try to retrieve the picture (should never fail!), unless there is a demuxer bug ofcours
           m_pVideoCodec->ClearPicture(&picture);
+          picture.buffer = NULL; // only set by codecs that decode into pooled buffers
           if (m_pVideoCodec->GetPicture(&picture))
           {
             sPostProcessType.clear();
@@ -730,6 +791,7 @@ void CDVDPlayerVideo::Process()
           {
             CLog::Log(LOGWARNING, "Decoder Error getting videoPicture.");
             m_pVideoCodec->Reset();
+            m_iPacketsSinceReset = 0;
           }
         }
 
@@ -936,6 +998,7 @@ void CDVDPlayerVideo::ProcessOverlays(DVDVideoPicture* pSource, double pts)
       CDVDCodecUtils::CopyPicture(m_pTempOverlayPicture, pSource);
       memcpy(pSource->data     , m_pTempOverlayPicture->data     , sizeof(pSource->data));
       memcpy(pSource->iLineSize, m_pTempOverlayPicture->iLineSize, sizeof(pSource->iLineSize));
+      pSource->buffer = NULL;
     }
   }
 
@@ -1527,6 +1590,13 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   s << ", Mb/s:" << fixed << setprecision(2) << (double)GetVideoBitrate() / (1024.0*1024.0);
   s << ", drop:" << m_iDroppedFrames;
 
+  double copyrate;
+  unsigned int direct, copied;
+  g_renderManager.GetCopyStats(copyrate, direct, copied);
+  s << ", cp:" << fixed << setprecision(1) << copyrate / (1024.0*1024.0) << "MB/s";
+  if (direct + copied > 0)
+    s << " (" << direct * 100 / (direct + copied) << "% direct)";
+
   int pc = m_pullupCorrection.GetPatternLength();
   if (pc > 0)
     s << ", pc:" << pc;
@@ -47,7 +47,8 @@ public:
 
   bool OpenStream(CDVDStreamInfo &hint);
   void OpenStream(CDVDStreamInfo &hint, CDVDVideoCodec* codec);
-  void CloseStream(bool bWaitForBuffers);
+  void CloseStream(bool bWaitForBuffers, bool bKeepCodec = false);
+  void ReleaseKeptCodec();
 
   void StepFrame();
   void Flush();
@@ -169,6 +170,7 @@ protected:
   float m_fForcedAspectRatio;
 
   int m_iNrOfPicturesNotToSkip;
+  unsigned int m_iPacketsSinceReset; // packets fed to the codec since it was last reset
   int m_speed;
 
   double m_droptime;
@@ -188,6 +190,8 @@ protected:
   // classes
   CDVDStreamInfo m_hints;
   CDVDVideoCodec* m_pVideoCodec;
+  CDVDStreamInfo m_keptHints;
+  CDVDVideoCodec* m_pKeptCodec; // codec of the previous stream, kept for reuse
   CDVDOverlayCodecCC* m_pOverlayCodecCC;
 
   DVDVideoPicture* m_pTempOverlayPicture;
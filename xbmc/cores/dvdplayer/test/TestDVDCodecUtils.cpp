@@ -0,0 +1,187 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+static void FillPicture(DVDVideoPicture* pPicture)
+{
+  for (int p = 0; p < 3; p++)
+  {
+    int h = p ? pPicture->iHeight / 2 : pPicture->iHeight;
+    for (int y = 0; y < h; y++)
+      for (int x = 0; x < pPicture->iLineSize[p]; x++)
+        pPicture->data[p][y * pPicture->iLineSize[p] + x] = (uint8_t)(p * 85 + y * 7 + x * 3);
+  }
+}
+
+TEST(TestDVDCodecUtils, InterleaveUV)
+{
+  int cpu = g_cpuInfo.GetCPUFeatures();
+  std::vector<uint8_t> u(100), v(100), ref(200), out(200);
+  for (unsigned int i = 0; i < u.size(); i++)
+  {
+    u[i] = (uint8_t)i;
+    v[i] = (uint8_t)(255 - i);
+  }
+
+  /* odd widths exercise the scalar tail of the vector versions */
+  for (int width = 1; width <= 100; width++)
+  {
+    CDVDCodecUtils::InterleaveUV(&ref[0], &u[0], &v[0], width, 0);
+    CDVDCodecUtils::InterleaveUV(&out[0], &u[0], &v[0], width, cpu);
+    for (int x = 0; x < width; x++)
+    {
+      EXPECT_EQ(u[x], ref[2 * x]);
+      EXPECT_EQ(v[x], ref[2 * x + 1]);
+    }
+    EXPECT_EQ(0, memcmp(&ref[0], &out[0], 2 * width));
+  }
+}
+
+TEST(TestDVDCodecUtils, PackYUV422)
+{
+  int cpu = g_cpuInfo.GetCPUFeatures();
+  std::vector<uint8_t> y(200), u(100), v(100), ref(400), out(400);
+  for (unsigned int i = 0; i < y.size(); i++)
+    y[i] = (uint8_t)(i * 3);
+  for (unsigned int i = 0; i < u.size(); i++)
+  {
+    u[i] = (uint8_t)i;
+    v[i] = (uint8_t)(255 - i);
+  }
+
+  for (int width = 2; width <= 200; width += 2)
+  {
+    CDVDCodecUtils::PackYUV422(&ref[0], &y[0], &u[0], &v[0], width, RENDER_FMT_YUYV422, 0);
+    CDVDCodecUtils::PackYUV422(&out[0], &y[0], &u[0], &v[0], width, RENDER_FMT_YUYV422, cpu);
+    EXPECT_EQ(y[0], ref[0]);
+    EXPECT_EQ(u[0], ref[1]);
+    EXPECT_EQ(y[1], ref[2]);
+    EXPECT_EQ(v[0], ref[3]);
+    EXPECT_EQ(0, memcmp(&ref[0], &out[0], 2 * width));
+
+    CDVDCodecUtils::PackYUV422(&ref[0], &y[0], &u[0], &v[0], width, RENDER_FMT_UYVY422, 0);
+    CDVDCodecUtils::PackYUV422(&out[0], &y[0], &u[0], &v[0], width, RENDER_FMT_UYVY422, cpu);
+    EXPECT_EQ(u[0], ref[0]);
+    EXPECT_EQ(y[0], ref[1]);
+    EXPECT_EQ(v[0], ref[2]);
+    EXPECT_EQ(y[1], ref[3]);
+    EXPECT_EQ(0, memcmp(&ref[0], &out[0], 2 * width));
+  }
+}
+
+TEST(TestDVDCodecUtils, ConvertToNV12Picture)
+{
+  DVDVideoPicture* pSrc = CDVDCodecUtils::AllocatePicture(176, 144);
+  ASSERT_TRUE(pSrc != NULL);
+  FillPicture(pSrc);
+
+  DVDVideoPicture* pDst = CDVDCodecUtils::ConvertToNV12Picture(pSrc);
+  ASSERT_TRUE(pDst != NULL);
+  EXPECT_EQ(RENDER_FMT_NV12, pDst->format);
+  for (int y = 0; y < pSrc->iHeight; y++)
+    EXPECT_EQ(0, memcmp(pSrc->data[0] + y * pSrc->iLineSize[0],
+                        pDst->data[0] + y * pDst->iLineSize[0], pSrc->iWidth));
+  for (int y = 0; y < pSrc->iHeight / 2; y++)
+  {
+    for (int x = 0; x < pSrc->iWidth / 2; x++)
+    {
+      EXPECT_EQ(pSrc->data[1][y * pSrc->iLineSize[1] + x], pDst->data[1][y * pDst->iLineSize[1] + 2 * x]);
+      EXPECT_EQ(pSrc->data[2][y * pSrc->iLineSize[2] + x], pDst->data[1][y * pDst->iLineSize[1] + 2 * x + 1]);
+    }
+  }
+
+  CDVDCodecUtils::FreePicture(pDst);
+  CDVDCodecUtils::FreePicture(pSrc);
+}
+
+TEST(TestDVDCodecUtils, ConvertToYUV422PackedPicture)
+{
+  DVDVideoPicture* pSrc = CDVDCodecUtils::AllocatePicture(176, 144);
+  ASSERT_TRUE(pSrc != NULL);
+  FillPicture(pSrc);
+
+  DVDVideoPicture* pDst = CDVDCodecUtils::ConvertToYUV422PackedPicture(pSrc, RENDER_FMT_YUYV422);
+  ASSERT_TRUE(pDst != NULL);
+  EXPECT_EQ(RENDER_FMT_YUYV422, pDst->format);
+  for (int y = 0; y < pSrc->iHeight; y++)
+  {
+    const uint8_t *s_y = pSrc->data[0] + y * pSrc->iLineSize[0];
+    const uint8_t *s_u = pSrc->data[1] + (y / 2) * pSrc->iLineSize[1];
+    const uint8_t *s_v = pSrc->data[2] + (y / 2) * pSrc->iLineSize[2];
+    const uint8_t *d   = pDst->data[0] + y * pDst->iLineSize[0];
+    for (int x = 0; x < pSrc->iWidth / 2; x++)
+    {
+      EXPECT_EQ(s_y[2 * x],     d[4 * x]);
+      EXPECT_EQ(s_u[x],         d[4 * x + 1]);
+      EXPECT_EQ(s_y[2 * x + 1], d[4 * x + 2]);
+      EXPECT_EQ(s_v[x],         d[4 * x + 3]);
+    }
+  }
+
+  CDVDCodecUtils::FreePicture(pDst);
+  CDVDCodecUtils::FreePicture(pSrc);
+}
+
+TEST(TestDVDCodecUtils, Throughput)
+{
+  const int frames = 50;
+  DVDVideoPicture* pSrc = CDVDCodecUtils::AllocatePicture(1920, 1080);
+  ASSERT_TRUE(pSrc != NULL);
+  FillPicture(pSrc);
+  std::vector<uint8_t> dst(1920 * 1080 * 2);
+
+  int cpus[2] = { 0, g_cpuInfo.GetCPUFeatures() };
+  for (int i = 0; i < 2; i++)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (int f = 0; f < frames; f++)
+    {
+      for (int y = 0; y < pSrc->iHeight / 2; y++)
+        CDVDCodecUtils::InterleaveUV(&dst[y * pSrc->iWidth],
+                                     pSrc->data[1] + y * pSrc->iLineSize[1],
+                                     pSrc->data[2] + y * pSrc->iLineSize[2],
+                                     pSrc->iWidth / 2, cpus[i]);
+    }
+    unsigned int nv12 = XbmcThreads::SystemClockMillis();
+    for (int f = 0; f < frames; f++)
+    {
+      for (int y = 0; y < pSrc->iHeight; y++)
+        CDVDCodecUtils::PackYUV422(&dst[y * pSrc->iWidth * 2],
+                                   pSrc->data[0] + y * pSrc->iLineSize[0],
+                                   pSrc->data[1] + (y >> 1) * pSrc->iLineSize[1],
+                                   pSrc->data[2] + (y >> 1) * pSrc->iLineSize[2],
+                                   pSrc->iWidth, RENDER_FMT_YUYV422, cpus[i]);
+    }
+    unsigned int yuy2 = XbmcThreads::SystemClockMillis();
+
+    std::cout << (i ? "Optimized" : "Plain C") << " 1080p x " << testing::PrintToString(frames) <<
+      ": NV12 " << testing::PrintToString(nv12 - start) <<
+      " ms, YUY2 " << testing::PrintToString(yuy2 - nv12) << " ms\n";
+  }
+
+  CDVDCodecUtils::FreePicture(pSrc);
+}
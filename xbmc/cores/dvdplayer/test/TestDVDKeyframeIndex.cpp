@@ -0,0 +1,78 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDKeyframeIndex.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestDVDKeyframeIndex, Add)
+{
+  CDVDKeyframeIndex index;
+  index.Add(0, 0);
+  index.Add(1000, 100);
+  index.Add(4000, 400);
+  index.Add(2000, 200);
+  index.Add(3000, 300);
+  ASSERT_EQ(3u, index.Size());
+  EXPECT_EQ(0, index[0].time);
+  EXPECT_EQ(2000, index[1].time);
+  EXPECT_EQ(4000, index[2].time);
+  EXPECT_TRUE(index.IsChanged());
+}
+
+TEST(TestDVDKeyframeIndex, Find)
+{
+  CDVDKeyframeIndex index;
+  CDVDKeyframeIndex::SEntry entry;
+  index.Add(0, 0);
+  index.Add(5000, 500);
+  index.Add(60000, 6000);
+
+  EXPECT_TRUE(index.Find(3000, true, entry));
+  EXPECT_EQ(0, entry.time);
+  EXPECT_TRUE(index.Find(3000, false, entry));
+  EXPECT_EQ(5000, entry.time);
+  EXPECT_TRUE(index.Find(60000, false, entry));
+  EXPECT_EQ(6000, entry.pos);
+
+  /* gap between 5s and 60s is not covered */
+  EXPECT_FALSE(index.Find(30000, true, entry));
+  /* nothing known past the last keyframe */
+  EXPECT_FALSE(index.Find(61000, true, entry));
+}
+
+TEST(TestDVDKeyframeIndex, Serialize)
+{
+  CDVDKeyframeIndex index, copy;
+  for (int i = 0; i < 100; i++)
+    index.Add(i * 2500, i * 123456789LL);
+
+  EXPECT_TRUE(copy.Deserialize(index.Serialize()));
+  ASSERT_EQ(index.Size(), copy.Size());
+  for (size_t i = 0; i < index.Size(); i++)
+  {
+    EXPECT_EQ(index[i].time, copy[i].time);
+    EXPECT_EQ(index[i].pos, copy[i].pos);
+  }
+  EXPECT_FALSE(copy.IsChanged());
+
+  EXPECT_FALSE(copy.Deserialize("0,0;1000,abc;"));
+  EXPECT_TRUE(copy.IsEmpty());
+}
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDInputStreams/DVDTimeshiftBuffer.h"
+#include "filesystem/HDFile.h"
+#include "filesystem/IFile.h"
+#include "test/TestUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+/* a local file stands in for the stream of a pvr client */
+TEST(TestDVDTimeshiftBuffer, ReadAndSeek)
+{
+  XFILE::CHDFile source;
+  ASSERT_TRUE(source.Open(CURL(
+    XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt"))));
+
+  CDVDTimeshiftBuffer buffer(&source, 1024 * 1024);
+  ASSERT_TRUE(buffer.Open());
+
+  BYTE data[2048];
+  int iTotal = 0;
+  int iRead;
+  while ((iRead = buffer.Read(data + iTotal, sizeof(data) - iTotal)) > 0)
+    iTotal += iRead;
+
+  EXPECT_EQ(1616, iTotal);
+  EXPECT_EQ(1616, buffer.GetPosition());
+  EXPECT_TRUE(!memcmp("About\n-----\nXBMC is ", data, 20));
+  EXPECT_TRUE(buffer.IsEOF());
+
+  XFILE::SCacheStatus status;
+  ASSERT_TRUE(buffer.GetCacheStatus(&status));
+  EXPECT_EQ(0u, status.forward);
+  EXPECT_FALSE(status.full);
+
+  /* everything is still buffered, so seeking back works without the source */
+  EXPECT_EQ(100, buffer.Seek(100, SEEK_SET));
+  EXPECT_FALSE(buffer.IsEOF());
+  ASSERT_TRUE(buffer.GetCacheStatus(&status));
+  EXPECT_EQ(1516u, status.forward);
+  EXPECT_EQ(20, buffer.Read(data, 20));
+  EXPECT_TRUE(!memcmp("ent hub for digital ", data, 20));
+  EXPECT_EQ(220, buffer.Seek(100, SEEK_CUR));
+  EXPECT_EQ(220, buffer.GetPosition());
+
+  /* the end of a live stream isn't known and nothing past it was read */
+  EXPECT_EQ(-1, buffer.Seek(0, SEEK_END));
+  EXPECT_EQ(-1, buffer.Seek(1024 * 1024, SEEK_SET));
+  EXPECT_EQ(220, buffer.GetPosition());
+
+  buffer.Close();
+  EXPECT_TRUE(buffer.IsEOF());
+  EXPECT_EQ(0, buffer.Read(data, sizeof(data)));
+  source.Close();
+}
+
+/* a live stream that never ends and only contains the number of its channel */
+class CTestLiveStream : public XFILE::IFile
+{
+public:
+  CTestLiveStream() : m_channel('1') {}
+
+  virtual bool Open(const CURL& url) { return true; }
+  virtual bool Exists(const CURL& url) { return true; }
+  virtual int Stat(const CURL& url, struct __stat64* buffer) { return -1; }
+  virtual unsigned int Read(void* lpBuf, int64_t uiBufSize)
+  {
+    memset(lpBuf, m_channel, (size_t)uiBufSize);
+    return (unsigned int)uiBufSize;
+  }
+  virtual int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET) { return -1; }
+  virtual void Close() {}
+  virtual int64_t GetPosition() { return -1; }
+  virtual int64_t GetLength() { return -1; }
+
+  volatile char m_channel;
+};
+
+static bool ReadChannel(CDVDTimeshiftBuffer &buffer, char channel)
+{
+  BYTE data[4096];
+  int iTotal = 0;
+  while (iTotal < (int)sizeof(data))
+  {
+    int iRead = buffer.Read(data + iTotal, sizeof(data) - iTotal);
+    if (iRead <= 0)
+      return false;
+    iTotal += iRead;
+  }
+
+  for (int i = 0; i < iTotal; i++)
+  {
+    if (data[i] != (BYTE)channel)
+      return false;
+  }
+  return true;
+}
+
+/* a channel switch of the client is wrapped in Close() and Open() by CDVDInputStreamPVRManager */
+TEST(TestDVDTimeshiftBuffer, SwitchChannel)
+{
+  CTestLiveStream source;
+  CDVDTimeshiftBuffer buffer(&source, 1024 * 1024);
+  ASSERT_TRUE(buffer.Open());
+  EXPECT_TRUE(ReadChannel(buffer, '1'));
+  EXPECT_EQ(4096, buffer.GetPosition());
+
+  /* more of the old channel is buffered ahead of the read position */
+  XFILE::SCacheStatus status;
+  ASSERT_TRUE(buffer.GetCacheStatus(&status));
+  EXPECT_LT(0u, status.forward);
+
+  buffer.Close();
+  source.m_channel = '2';
+  ASSERT_TRUE(buffer.Open());
+
+  /* nothing of the old channel is played after the switch */
+  EXPECT_TRUE(ReadChannel(buffer, '2'));
+  EXPECT_EQ(4096, buffer.GetPosition());
+  EXPECT_FALSE(buffer.IsEOF());
+
+  buffer.Close();
+}
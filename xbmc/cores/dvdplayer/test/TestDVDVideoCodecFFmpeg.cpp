@@ -0,0 +1,183 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDCodecs/DVDCodecs.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemux.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDFactoryDemuxer.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDFactoryInputStream.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStream.h"
+#include "cores/dvdplayer/DVDStreamInfo.h"
+#include "settings/AdvancedSettings.h"
+#include "test/TestUtils.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#define TEST_VIDEO_PACKETS 300
+
+/* Read the first packets of the first video stream of a file */
+static bool ReadVideoPackets(const CStdString &strFile, CDVDStreamInfo &hints, std::vector<DemuxPacket*> &packets)
+{
+  CDVDInputStream *input = CDVDFactoryInputStream::CreateInputStream(NULL, strFile, "");
+  if (!input || !input->Open(strFile.c_str(), ""))
+  {
+    delete input;
+    return false;
+  }
+
+  CDVDDemux *demux = CDVDFactoryDemuxer::CreateDemuxer(input);
+  CDemuxStream *stream = NULL;
+  for (int i = 0; demux && i < demux->GetNrOfStreams() && !stream; i++)
+  {
+    if (demux->GetStream(i)->type == STREAM_VIDEO)
+      stream = demux->GetStream(i);
+  }
+
+  if (stream)
+  {
+    /* not marked as software, that would disable threading */
+    hints.Assign(*stream, true);
+
+    DemuxPacket *packet;
+    while (packets.size() < TEST_VIDEO_PACKETS && (packet = demux->Read()))
+    {
+      if (packet->iStreamId == stream->iId)
+        packets.push_back(packet);
+      else
+        CDVDDemuxUtils::FreeDemuxPacket(packet);
+    }
+  }
+
+  delete demux;
+  delete input;
+  return !packets.empty();
+}
+
+/* Count the pictures a decoder returns, starting with the given state */
+static int GetPictures(CDVDVideoCodecFFmpeg &codec, int state)
+{
+  int pictures = 0;
+  while (!(state & VC_ERROR))
+  {
+    if (state & VC_PICTURE)
+    {
+      DVDVideoPicture picture;
+      codec.ClearPicture(&picture);
+      if (codec.GetPicture(&picture) && !(picture.iFlags & DVP_FLAG_DROPPED))
+        pictures++;
+    }
+    if (state & VC_BUFFER)
+      break;
+    state = codec.Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+  }
+  return pictures;
+}
+
+/* Decode all packets and drain the decoder like the player does at end of
+ * stream, returns the number of pictures or -1 if the codec can't be opened */
+static int DecodePackets(CDVDStreamInfo &hints, const std::vector<DemuxPacket*> &packets, bool bFrameThreading)
+{
+  g_advancedSettings.m_videoFrameThreading = bFrameThreading;
+
+  CDVDVideoCodecFFmpeg codec;
+  CDVDCodecOptions options;
+  options.m_formats.push_back(RENDER_FMT_YUV420P);
+  if (!codec.Open(hints, options))
+    return -1;
+
+  int pictures = 0;
+  for (std::vector<DemuxPacket*>::const_iterator it = packets.begin(); it != packets.end(); ++it)
+    pictures += GetPictures(codec, codec.Decode((*it)->pData, (*it)->iSize, (*it)->dts, (*it)->pts));
+
+  codec.Drain();
+  pictures += GetPictures(codec, codec.Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE));
+
+  codec.Dispose();
+  return pictures;
+}
+
+static void FreePackets(std::vector<DemuxPacket*> &packets)
+{
+  for (std::vector<DemuxPacket*>::iterator it = packets.begin(); it != packets.end(); ++it)
+    CDVDDemuxUtils::FreeDemuxPacket(*it);
+  packets.clear();
+}
+
+/* The tests decode the video files given as arguments to the main testsuite
+ * program, ideally h264 or mpeg4 files without broken frames.
+ */
+TEST(TestDVDVideoCodecFFmpeg, Drain)
+{
+  std::vector<CStdString> files =
+    CXBMCTestUtils::Instance().getTestVideoCodecFiles();
+  bool bFrameThreading = g_advancedSettings.m_videoFrameThreading;
+
+  for (std::vector<CStdString>::iterator it = files.begin(); it != files.end(); ++it)
+  {
+    CDVDStreamInfo hints;
+    std::vector<DemuxPacket*> packets;
+    ASSERT_TRUE(ReadVideoPackets(*it, hints, packets)) << *it;
+
+    /* a frame threaded decoder has to return as many pictures as a
+     * single threaded one once it's drained */
+    int single = DecodePackets(hints, packets, false);
+    int threaded = DecodePackets(hints, packets, true);
+    EXPECT_LT(0, single) << *it;
+    EXPECT_EQ(single, threaded) << *it;
+
+    FreePackets(packets);
+  }
+
+  g_advancedSettings.m_videoFrameThreading = bFrameThreading;
+}
+
+TEST(TestDVDVideoCodecFFmpeg, Throughput)
+{
+  std::vector<CStdString> files =
+    CXBMCTestUtils::Instance().getTestVideoCodecFiles();
+  bool bFrameThreading = g_advancedSettings.m_videoFrameThreading;
+
+  for (std::vector<CStdString>::iterator it = files.begin(); it != files.end(); ++it)
+  {
+    CDVDStreamInfo hints;
+    std::vector<DemuxPacket*> packets;
+    ASSERT_TRUE(ReadVideoPackets(*it, hints, packets)) << *it;
+
+    for (int i = 0; i < 2; i++)
+    {
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      int pictures = DecodePackets(hints, packets, i == 1);
+      unsigned int end = XbmcThreads::SystemClockMillis();
+
+      std::cout << (i ? "Frame threads" : "Single thread") << " " << *it <<
+        ": " << testing::PrintToString(pictures) <<
+        " pictures in " << testing::PrintToString(end - start) << " ms\n";
+    }
+
+    FreePackets(packets);
+  }
+
+  g_advancedSettings.m_videoFrameThreading = bFrameThreading;
+}
@@ -0,0 +1,108 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoPicturePool.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestDVDVideoPicturePool, Reuse)
+{
+  CDVDVideoPicturePool* pool = new CDVDVideoPicturePool();
+
+  CDVDVideoPictureBuffer* first = pool->Get(1024);
+  ASSERT_TRUE(first != NULL);
+  EXPECT_TRUE(first->Base() != NULL);
+  EXPECT_EQ(1024U, first->size);
+  EXPECT_EQ(1U, pool->GetAllocated());
+
+  /* a buffer in use is never handed out twice */
+  CDVDVideoPictureBuffer* second = pool->Get(1024);
+  ASSERT_TRUE(second != NULL);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(2U, pool->GetAllocated());
+
+  /* the buffer is reused once the last reference is released */
+  BYTE* base = first->Base();
+  first->data[0] = base;
+  first->iLineSize[0] = 32;
+  first->Release();
+  CDVDVideoPictureBuffer* third = pool->Get(1024);
+  ASSERT_TRUE(third != NULL);
+  EXPECT_EQ(base, third->Base());
+  EXPECT_TRUE(third->data[0] == NULL);
+  EXPECT_EQ(0, third->iLineSize[0]);
+  EXPECT_EQ(2U, pool->GetAllocated());
+
+  third->Release();
+  second->Release();
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, SharedReference)
+{
+  CDVDVideoPicturePool* pool = new CDVDVideoPicturePool();
+
+  /* the renderer holds its own reference next to the decoder */
+  CDVDVideoPictureBuffer* buffer = pool->Get(1024);
+  ASSERT_TRUE(buffer != NULL);
+  buffer->Acquire();
+  EXPECT_EQ(1, buffer->Release());
+
+  CDVDVideoPictureBuffer* other = pool->Get(1024);
+  ASSERT_TRUE(other != NULL);
+  EXPECT_NE(buffer, other);
+
+  EXPECT_EQ(0, buffer->Release());
+  other->Release();
+  EXPECT_EQ(2U, pool->GetAllocated());
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, SizeChange)
+{
+  CDVDVideoPicturePool* pool = new CDVDVideoPicturePool();
+
+  CDVDVideoPictureBuffer* buffer = pool->Get(1024);
+  ASSERT_TRUE(buffer != NULL);
+  buffer->Release();
+  EXPECT_EQ(1U, pool->GetAllocated());
+
+  /* free buffers of the old picture size are dropped */
+  buffer = pool->Get(2048);
+  ASSERT_TRUE(buffer != NULL);
+  EXPECT_EQ(2048U, buffer->size);
+  EXPECT_EQ(1U, pool->GetAllocated());
+
+  buffer->Release();
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, OutlivesOwner)
+{
+  CDVDVideoPicturePool* pool = new CDVDVideoPicturePool();
+
+  /* a buffer still held by the renderer keeps the pool alive
+   * after the codec released it */
+  CDVDVideoPictureBuffer* buffer = pool->Get(1024);
+  ASSERT_TRUE(buffer != NULL);
+  EXPECT_EQ(1, pool->Release());
+  memset(buffer->Base(), 0, buffer->size);
+  buffer->Release();
+}
@@ -30,6 +30,8 @@
 #include "utils/MathUtils.h"
 
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Interfaces/AEStream.h"
@@ -37,6 +39,7 @@
 #define TIME_TO_CACHE_NEXT_FILE 5000 /* 5 seconds before end of song, start caching the next song */
 #define FAST_XFADE_TIME           80 /* 80 milliseconds */
 #define MAX_SKIP_XFADE_TIME     2000 /* max 2 seconds crossfade on track skip */
+#define PRELOAD_WAIT_TIME        500 /* max 0.5 seconds to wait for a running preload */
 
 CAEChannelInfo ICodec::GetChannelInfo()
 {
@@ -47,6 +50,37 @@ CAEChannelInfo ICodec::GetChannelInfo()
 // Supporting all open  audio codec standards.
 // First one being nullsoft's nsv audio decoder format
 
+/* opens and pre-decodes an upcoming file so QueueNextFile doesn't have to wait on the codec */
+class CPAPlayerPreloadJob : public CJob
+{
+public:
+  CPAPlayerPreloadJob(const CFileItem &file) : m_file(file), m_stream(NULL) {}
+
+  virtual ~CPAPlayerPreloadJob()
+  {
+    if (m_stream)
+      PAPlayer::FreeStream(m_stream);
+  }
+
+  virtual const char *GetType() const { return "paplayerpreload"; }
+
+  virtual bool DoWork()
+  {
+    /* tells the player the file is being opened, or skips it if the player gave up on it */
+    if (ShouldCancel(0, 1))
+      return false;
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_stream = PAPlayer::OpenStream(m_file);
+    if (m_stream)
+      CLog::Log(LOGDEBUG, "CPAPlayerPreloadJob::DoWork - Preloaded %s in %u ms", m_file.GetPath().c_str(), XbmcThreads::SystemClockMillis() - start);
+    return m_stream != NULL;
+  }
+
+  CFileItem             m_file;
+  PAPlayer::StreamInfo* m_stream;
+};
+
 PAPlayer::PAPlayer(IPlayerCallback& callback) :
   IPlayer              (callback),
   CThread              ("PAPlayer"),
@@ -59,13 +93,18 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) :
   m_upcomingCrossfadeMS(0),
   m_currentStream      (NULL ),
   m_audioCallback      (NULL ),
-  m_FileItem           (new CFileItem())
+  m_FileItem           (new CFileItem()),
+  m_preloadHits        (0),
+  m_preloadMisses      (0),
+  m_underruns          (0)
 {
   memset(&m_playerGUIData, 0, sizeof(m_playerGUIData));
 }
 
 PAPlayer::~PAPlayer()
 {
+  ClearPreloads();
+
   if (!m_isPaused)
     SoftStop(true, true);
   CloseAllStreams(false);
@@ -192,30 +231,14 @@ void PAPlayer::CloseAllStreams(bool fade/* = true */)
     {
       StreamInfo* si = m_streams.front();
       m_streams.pop_front();
-      
-      if (si->m_stream)
-      {
-        CAEFactory::FreeStream(si->m_stream);
-        si->m_stream = NULL;
-      }
-
-      si->m_decoder.Destroy();
-      delete si;
+      FreeStream(si);
     }
 
     while(!m_finishing.empty())
     {
       StreamInfo* si = m_finishing.front();
       m_finishing.pop_front();
-
-      if (si->m_stream)
-      {
-        CAEFactory::FreeStream(si->m_stream);
-        si->m_stream = NULL;
-      }
-
-      si->m_decoder.Destroy();
-      delete si;
+      FreeStream(si);
     }
     m_currentStream = NULL;
   }
@@ -289,17 +312,16 @@ bool PAPlayer::QueueNextFile(const CFileItem &file)
   return QueueNextFileEx(file);
 }
 
-bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */)
+PAPlayer::StreamInfo* PAPlayer::OpenStream(const CFileItem &file)
 {
   StreamInfo *si = new StreamInfo();
 
   if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75))
   {
-    CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create the decoder");
+    CLog::Log(LOGWARNING, "PAPlayer::OpenStream - Failed to create the decoder");
 
     delete si;
-    m_callback.OnQueueNextItem();
-    return false;
+    return NULL;
   }
 
   /* decode until there is data-available */
@@ -311,16 +333,182 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */)
         status == STATUS_NO_FILE ||
         si->m_decoder.ReadSamples(PACKET_SIZE) == RET_ERROR)
     {
-      CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx - Error reading samples");
+      CLog::Log(LOGINFO, "PAPlayer::OpenStream - Error reading samples");
 
       si->m_decoder.Destroy();
       delete si;
-      m_callback.OnQueueNextItem();
-      return false;
+      return NULL;
     }
 
     /* yield our time so that the main PAP thread doesnt stall */
-    CThread::Sleep(1);
+    ::Sleep(1);
+  }
+
+  /* the tags are known now, so the gain doesn't have to be worked out when the stream starts */
+  si->m_replayGain = si->m_decoder.GetReplayGain();
+  si->m_stream     = NULL;
+  return si;
+}
+
+void PAPlayer::FreeStream(StreamInfo *si)
+{
+  if (si->m_stream)
+  {
+    CAEFactory::FreeStream(si->m_stream);
+    si->m_stream = NULL;
+  }
+
+  si->m_decoder.Destroy();
+  delete si;
+}
+
+PAPlayer::PreloadList::iterator PAPlayer::FindPreload(const CFileItem &file)
+{
+  for (PreloadList::iterator it = m_preloads.begin(); it != m_preloads.end(); ++it)
+  {
+    if (it->m_path == file.GetPath() && it->m_startOffset == file.m_lStartOffset)
+      return it;
+  }
+  return m_preloads.end();
+}
+
+PAPlayer::StreamInfo* PAPlayer::TakePreloadedStream(const CFileItem &file)
+{
+  CSingleLock lock(m_preloadSection);
+  PreloadList::iterator it = FindPreload(file);
+
+  /* a preload that is being opened will be done soon, waiting for it beats opening the file
+     a second time. one that didn't start yet is cancelled and the file opened right away */
+  XbmcThreads::EndTime timeout(PRELOAD_WAIT_TIME);
+  while (it != m_preloads.end() && it->m_jobID && it->m_started && !timeout.IsTimePast())
+  {
+    m_preloadEvent.Reset();
+    lock.Leave();
+    m_preloadEvent.WaitMSec(timeout.MillisLeft());
+    lock.Enter();
+    it = FindPreload(file);
+  }
+
+  if (it == m_preloads.end())
+  {
+    m_preloadMisses++;
+    return NULL;
+  }
+
+  if (it->m_jobID)
+  {
+    if (it->m_started)
+      CLog::Log(LOGDEBUG, "PAPlayer::TakePreloadedStream - Timed out waiting for %s", file.GetPath().c_str());
+    CJobManager::GetInstance().CancelJob(it->m_jobID);
+  }
+
+  StreamInfo *si = it->m_stream;
+  m_preloads.erase(it);
+
+  if (si)
+    m_preloadHits++;
+  else
+    m_preloadMisses++;
+
+  return si;
+}
+
+void PAPlayer::PreloadFiles(const CFileItemList &files)
+{
+  CSingleLock lock(m_preloadSection);
+
+  /* drop anything that is no longer coming up */
+  PreloadList::iterator it = m_preloads.begin();
+  while (it != m_preloads.end())
+  {
+    bool upcoming = false;
+    for (int i = 0; i < files.Size() && !upcoming; i++)
+      upcoming = files[i]->GetPath() == it->m_path && files[i]->m_lStartOffset == it->m_startOffset;
+
+    if (upcoming)
+    {
+      ++it;
+      continue;
+    }
+
+    if (it->m_jobID)
+      CJobManager::GetInstance().CancelJob(it->m_jobID);
+    if (it->m_stream)
+      FreeStream(it->m_stream);
+    it = m_preloads.erase(it);
+  }
+
+  for (int i = 0; i < files.Size(); i++)
+  {
+    const CFileItemPtr item = files[i];
+    if (item->IsInternetStream() || FindPreload(*item) != m_preloads.end())
+      continue;
+
+    PreloadInfo info;
+    info.m_path        = item->GetPath();
+    info.m_startOffset = item->m_lStartOffset;
+    info.m_stream      = NULL;
+    info.m_started     = false;
+    info.m_jobID       = CJobManager::GetInstance().AddJob(new CPAPlayerPreloadJob(*item), this);
+    m_preloads.push_back(info);
+  }
+}
+
+void PAPlayer::ClearPreloads()
+{
+  CSingleLock lock(m_preloadSection);
+  for (PreloadList::iterator it = m_preloads.begin(); it != m_preloads.end(); ++it)
+  {
+    if (it->m_jobID)
+      CJobManager::GetInstance().CancelJob(it->m_jobID);
+    if (it->m_stream)
+      FreeStream(it->m_stream);
+  }
+  m_preloads.clear();
+}
+
+void PAPlayer::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job)
+{
+  CSingleLock lock(m_preloadSection);
+  for (PreloadList::iterator it = m_preloads.begin(); it != m_preloads.end(); ++it)
+  {
+    if (it->m_jobID == jobID)
+    {
+      it->m_started = true;
+      break;
+    }
+  }
+}
+
+void PAPlayer::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CPAPlayerPreloadJob *preload = (CPAPlayerPreloadJob*)job;
+
+  CSingleLock lock(m_preloadSection);
+  for (PreloadList::iterator it = m_preloads.begin(); it != m_preloads.end(); ++it)
+  {
+    if (it->m_jobID != jobID)
+      continue;
+
+    /* take the stream over from the job, a failed preload is left for QueueNextFile to retry */
+    it->m_jobID  = 0;
+    it->m_stream = preload->m_stream;
+    preload->m_stream = NULL;
+    break;
+  }
+  m_preloadEvent.Set();
+}
+
+bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */)
+{
+  StreamInfo *si = TakePreloadedStream(file);
+  if (!si)
+    si = OpenStream(file);
+
+  if (!si)
+  {
+    m_callback.OnQueueNextItem();
+    return false;
   }
 
   UpdateCrossfadeTime(file);
@@ -340,6 +528,7 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */)
   si->m_volume             = (fadeIn && m_upcomingCrossfadeMS) ? 0.0f : 1.0f;
   si->m_fadeOutTriggered   = false;
   si->m_isSlaved           = false;
+  si->m_underrun           = false;
 
   int64_t streamTotalTime = si->m_decoder.TotalTime();
   if (si->m_endOffset)
@@ -403,7 +592,7 @@ inline bool PAPlayer::PrepareStream(StreamInfo *si)
   }
 
   si->m_stream->SetVolume    (si->m_volume);
-  si->m_stream->SetReplayGain(si->m_decoder.GetReplayGain());
+  si->m_stream->SetReplayGain(si->m_replayGain);
 
   /* if its not the first stream and crossfade is not enabled */
   if (m_currentStream && m_currentStream != si && !m_upcomingCrossfadeMS)
@@ -654,9 +843,22 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &delay, double &buffe
   if (si->m_started)
   {
     if (si->m_stream->IsBuffering())
+    {
       delay = 0.0;
+
+      /* the decoder could not keep up with playback */
+      if (!si->m_underrun)
+      {
+        si->m_underrun = true;
+        m_underruns++;
+        CLog::Log(LOGWARNING, "PAPlayer::ProcessStream - Stream underrun (%u so far)", m_underruns);
+      }
+    }
     else
+    {
+      si->m_underrun = false;
       delay = std::min(delay , si->m_stream->GetDelay());
+    }
     buffer = std::min(buffer, si->m_stream->GetCacheTotal());
   }
 
@@ -691,6 +893,24 @@ void PAPlayer::OnExit()
 
 }
 
+void PAPlayer::GetGeneralInfo(CStdString& strGeneralInfo)
+{
+  unsigned int ready = 0, loading = 0;
+  {
+    CSingleLock lock(m_preloadSection);
+    for (PreloadList::const_iterator it = m_preloads.begin(); it != m_preloads.end(); ++it)
+    {
+      if (it->m_jobID)
+        loading++;
+      else if (it->m_stream)
+        ready++;
+    }
+  }
+
+  strGeneralInfo.Format("preload:%u ready, %u loading, %u/%u hit/miss, underruns:%u",
+                        ready, loading, m_preloadHits, m_preloadMisses, m_underruns);
+}
+
 void PAPlayer::RegisterAudioCallback(IAudioCallback* pCallback)
 {
   CSharedLock lock(m_streamsLock);
@@ -26,6 +26,7 @@
 #include "threads/Thread.h"
 #include "AudioDecoder.h"
 #include "threads/SharedSection.h"
+#include "utils/Job.h"
 
 #include "cores/IAudioCallback.h"
 #include "cores/AudioEngine/Utils/AEChannelInfo.h"
@@ -33,7 +34,8 @@
 class IAEStream;
 
 class CFileItem;
-class PAPlayer : public IPlayer, public CThread
+class CFileItemList;
+class PAPlayer : public IPlayer, public CThread, public IJobCallback
 {
 public:
   PAPlayer(IPlayerCallback& callback);
@@ -43,6 +45,7 @@ public:
   virtual void UnRegisterAudioCallback();
   virtual bool OpenFile(const CFileItem& file, const CPlayerOptions &options);
   virtual bool QueueNextFile(const CFileItem &file);
+  virtual void PreloadFiles(const CFileItemList &files);
   virtual void OnNothingToQueueNotify();
   virtual bool CloseFile();
   virtual bool IsPlaying() const;
@@ -58,7 +61,7 @@ public:
   virtual void SetDynamicRangeCompression(long drc);
   virtual void GetAudioInfo( CStdString& strAudioInfo) {}
   virtual void GetVideoInfo( CStdString& strVideoInfo) {}
-  virtual void GetGeneralInfo( CStdString& strVideoInfo) {}
+  virtual void GetGeneralInfo( CStdString& strGeneralInfo);
   virtual void Update(bool bPauseDrawing = false) {}
   virtual void ToFFRW(int iSpeed = 0);
   virtual int GetCacheLevel() const;
@@ -92,7 +95,12 @@ protected:
   virtual void Process();
   virtual void OnExit();
 
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+  virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
+
 private:
+  friend class CPAPlayerPreloadJob;
+
   typedef struct {
     CAudioDecoder     m_decoder;             /* the stream decoder */
     int64_t           m_startOffset;         /* the stream start offset */
@@ -103,6 +111,7 @@ private:
     enum AEDataFormat m_dataFormat;          /* data format of the samples */
     unsigned int      m_bytesPerSample;      /* number of bytes per audio sample */
     unsigned int      m_bytesPerFrame;       /* number of bytes per audio frame */
+    float             m_replayGain;          /* the replay gain to apply to the stream */
 
     bool              m_started;             /* if playback of this stream has been started */
     bool              m_finishing;           /* if this stream is finishing */
@@ -119,10 +128,21 @@ private:
     float             m_volume;              /* the initial volume level to set the stream to on creation */
 
     bool              m_isSlaved;            /* true if the stream has been slaved to another */
+    bool              m_underrun;            /* true while the playback stream is starved */
   } StreamInfo;
 
   typedef std::list<StreamInfo*> StreamList;
 
+  typedef struct {
+    CStdString        m_path;                /* the file being preloaded */
+    int64_t           m_startOffset;         /* the start offset of the file */
+    unsigned int      m_jobID;               /* the preload job, 0 once it has finished */
+    StreamInfo*       m_stream;              /* the opened stream, NULL if still loading or failed */
+    bool              m_started;             /* true once the preload job opens the file */
+  } PreloadInfo;
+
+  typedef std::list<PreloadInfo> PreloadList;
+
   bool                m_signalSpeedChange;   /* true if OnPlaybackSpeedChange needs to be called */
   int                 m_playbackSpeed;       /* the playback speed (1 = normal) */
   bool                m_isPlaying;
@@ -140,7 +160,19 @@ private:
   StreamList          m_streams;             /* playing streams */  
   StreamList          m_finishing;           /* finishing streams */
 
+  CCriticalSection    m_preloadSection;      /* lock for the preload list */
+  PreloadList         m_preloads;            /* upcoming files, opened ahead of time */
+  CEvent              m_preloadEvent;        /* set when a preload job finishes */
+  unsigned int        m_preloadHits;         /* queued files that were already preloaded */
+  unsigned int        m_preloadMisses;       /* queued files that had to be opened in place */
+  unsigned int        m_underruns;           /* times a started stream ran out of data */
+
   bool QueueNextFileEx(const CFileItem &file, bool fadeIn = true);
+  static StreamInfo* OpenStream(const CFileItem &file);
+  static void FreeStream(StreamInfo *si);
+  PreloadList::iterator FindPreload(const CFileItem &file);
+  StreamInfo* TakePreloadedStream(const CFileItem &file);
+  void ClearPreloads();
   void SoftStart(bool wait = false);
   void SoftStop(bool wait = false, bool close = true);
   void CloseAllStreams(bool fade = true);
@@ -22,7 +22,9 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
+#include "utils/TextSearch.h"
 #include "utils/TimeUtils.h"
 
 #include "EpgDatabase.h"
@@ -91,6 +93,7 @@ CEpg &CEpg::operator =(const CEpg &right)
   m_nowActiveStart    = right.m_nowActiveStart;
   m_lastScanTime      = right.m_lastScanTime;
   m_pvrChannel        = right.m_pvrChannel;
+  m_textIndex.Clear();
 
   for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); it++)
     m_tags.insert(make_pair(it->first, new CEpgInfoTag(*it->second)));
@@ -152,6 +155,7 @@ void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  m_textIndex.Clear();
 }
 
 void CEpg::Cleanup(void)
@@ -172,6 +176,7 @@ void CEpg::Cleanup(const CDateTime &Time)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_textIndex.Remove(it->second.get());
       m_tags.erase(it++);
     }
   }
@@ -194,8 +199,12 @@ bool CEpg::InfoTagNow(CEpgInfoTag &tag, bool bUpdateIfNeeded /* = true */)
   {
     CDateTime lastActiveTag;
 
-    /* one of the first items will always match if the list is sorted */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+    /* only the events around the last one that started before now can be active */
+    map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.upper_bound(CDateTime::GetUTCDateTime());
+    for (int iPtr = 0; iPtr < 2 && it != m_tags.begin(); iPtr++)
+      --it;
+
+    for (int iPtr = 0; iPtr < 4 && it != m_tags.end(); iPtr++, it++)
     {
       if (it->second->IsActive())
       {
@@ -208,7 +217,7 @@ bool CEpg::InfoTagNow(CEpgInfoTag &tag, bool bUpdateIfNeeded /* = true */)
     }
 
     /* there might be a gap between the last and next event. just return the last if found */
-    map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(lastActiveTag);
+    it = m_tags.find(lastActiveTag);
     if (it != m_tags.end())
     {
       tag = *it->second;
@@ -235,7 +244,12 @@ bool CEpg::InfoTagNext(CEpgInfoTag &tag)
   else if (Size() > 0)
   {
     /* return the first event that is in the future */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+    CSingleLock lock(m_critSection);
+    map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.upper_bound(CDateTime::GetUTCDateTime());
+    if (it != m_tags.begin())
+      --it;
+
+    for (; it != m_tags.end(); it++)
     {
       if (it->second->InTheFuture())
       {
@@ -295,14 +309,30 @@ CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &
 CEpgInfoTagPtr CEpg::GetTagAround(const CDateTime &time) const
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = FindTagAround(time);
+  if (it != m_tags.end())
+    return it->second;
+
+  CEpgInfoTagPtr retVal;
+  return retVal;
+}
+
+map<CDateTime, CEpgInfoTagPtr>::const_iterator CEpg::FindTagAround(const CDateTime &time) const
+{
+  /* events don't overlap and are keyed by their start time, so only the ones around
+     the last event that started before the given time can cover it. look at a few
+     neighbours, fixing overlapping events moves start times without re-keying them */
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.upper_bound(time);
+  for (int iPtr = 0; iPtr < 2 && it != m_tags.begin(); iPtr++)
+    --it;
+
+  for (int iPtr = 0; iPtr < 4 && it != m_tags.end(); iPtr++, it++)
   {
     if ((it->second->StartAsUTC() <= time) && (it->second->EndAsUTC() >= time))
-      return it->second;
+      return it;
   }
 
-  CEpgInfoTagPtr retVal;
-  return retVal;
+  return m_tags.end();
 }
 
 void CEpg::AddEntry(const CEpgInfoTag &tag)
@@ -324,6 +354,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->m_epg          = this;
     newTag->m_bChanged     = false;
+    m_textIndex.Add(newTag);
   }
 }
 
@@ -351,6 +382,7 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
     infoTag->Update(tag, bNewTag);
     infoTag->m_epg          = this;
     infoTag->m_pvrChannel   = m_pvrChannel;
+    m_textIndex.Add(infoTag);
   }
 
   if (bUpdateDatabase)
@@ -415,9 +447,9 @@ bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */)
 #if EPG_DEBUGGING
       CLog::Log(LOGDEBUG, "%s - %zu entries in memory before merging", __FUNCTION__, m_tags.size());
 #endif
-      /* copy over tags */
+      /* copy over tags. they're written to the database in one batch below */
       for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); it++)
-        UpdateEntry(*it->second, bStoreInDb, false);
+        UpdateEntry(*it->second, false, false);
 
 #if EPG_DEBUGGING
       CLog::Log(LOGDEBUG, "%s - %zu entries in memory after merging and before fixing", __FUNCTION__, m_tags.size());
@@ -431,6 +463,9 @@ bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */)
       m_lastScanTime = CDateTime::GetCurrentDateTime().GetAsUTCDateTime();
 
       SetChanged();
+
+      if (bStoreInDb)
+        PersistChangedTags(*database);
     }
     /* persist changes */
     if (bStoreInDb)
@@ -486,7 +521,18 @@ CDateTime CEpg::GetLastScanTime(void)
 
 bool CEpg::Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate /* = false */)
 {
-  bool bGrabSuccess(true);
+  if (!StartUpdate(iUpdateTime, bForceUpdate))
+    return FinishUpdate(NULL);
+
+  CEpg *entries = FetchEntries(start, end);
+  bool bReturn = FinishUpdate(entries, entries != NULL);
+  delete entries;
+
+  return bReturn;
+}
+
+bool CEpg::StartUpdate(int iUpdateTime, bool bForceUpdate /* = false */)
+{
   bool bUpdate(false);
 
   /* load the entries from the db first */
@@ -512,8 +558,13 @@ bool CEpg::Update(const time_t start, const time_t end, int iUpdateTime, bool bF
   else
     bUpdate = true;
 
-  if (bUpdate)
-    bGrabSuccess = LoadFromClients(start, end);
+  return bUpdate;
+}
+
+bool CEpg::FinishUpdate(const CEpg *entries, bool bGrabSuccess /* = true */)
+{
+  if (entries)
+    bGrabSuccess = UpdateEntries(*entries, !g_guiSettings.GetBool("epg.ignoredbforclient"));
 
   if (bGrabSuccess)
   {
@@ -553,10 +604,33 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
   CSingleLock lock(m_critSection);
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  /* only look at the events the word index says can match the search term */
+  vector<CEpgInfoTagPtr> candidates;
+  bool bNarrowed(false);
+  if (!filter.m_strSearchTerm.IsEmpty())
   {
-    if (filter.FilterEntry(*it->second))
-      results.Add(CFileItemPtr(new CFileItem(*it->second)));
+    if (!m_textIndex.IsBuilt())
+      m_textIndex.Build(m_tags);
+
+    CTextSearch search(filter.m_strSearchTerm, filter.m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+    bNarrowed = m_textIndex.GetCandidates(search, candidates);
+  }
+
+  if (bNarrowed)
+  {
+    for (vector<CEpgInfoTagPtr>::const_iterator it = candidates.begin(); it != candidates.end(); it++)
+    {
+      if (filter.FilterEntry(**it))
+        results.Add(CFileItemPtr(new CFileItem(**it)));
+    }
+  }
+  else
+  {
+    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+    {
+      if (filter.FilterEntry(*it->second))
+        results.Add(CFileItemPtr(new CFileItem(*it->second)));
+    }
   }
 
   return results.Size() - iInitialSize;
@@ -685,20 +759,19 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
     if (previousTag->EndAsUTC() >= currentTag->EndAsUTC())
     {
       // delete the current tag. it's completely overlapped
-      if (bUpdateDb)
+      if (bUpdateDb && currentTag->BroadcastId() > 0)
         bReturn &= database->Delete(*currentTag);
 
       if (m_nowActiveStart == it->first)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_textIndex.Remove(it->second.get());
       m_tags.erase(it++);
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
     {
       currentTag->SetStartFromUTC(previousTag->EndAsUTC());
-      if (bUpdateDb)
-        bReturn &= currentTag->Persist();
 
       previousTag = it->second;
     }
@@ -716,12 +789,6 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
       if (m_nowActiveStart == it->first)
         m_nowActiveStart = currentTag->StartAsUTC();
 
-      if (bUpdateDb)
-      {
-        bReturn &= currentTag->Persist();
-        bReturn &= previousTag->Persist();
-      }
-
       previousTag = it->second;
     }
     else
@@ -763,6 +830,29 @@ bool CEpg::UpdateFromScraper(time_t start, time_t end)
   return bGrabSuccess;
 }
 
+bool CEpg::PersistChangedTags(CEpgDatabase &database)
+{
+  unsigned int iStart = XbmcThreads::SystemClockMillis();
+
+  vector<CEpgInfoTagPtr> tags;
+  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  {
+    if (it->second->m_bChanged)
+      tags.push_back(it->second);
+  }
+
+  if (tags.empty())
+    return true;
+
+  bool bReturn = database.Persist(*this, tags);
+
+  CLog::Log(LOGDEBUG, "EPG - %s - persisted %u new or changed tags of table '%s', %u unchanged, in %u ms",
+      __FUNCTION__, (unsigned int) tags.size(), m_strName.c_str(), (unsigned int) (m_tags.size() - tags.size()),
+      XbmcThreads::SystemClockMillis() - iStart);
+
+  return bReturn;
+}
+
 bool CEpg::PersistTags(void) const
 {
   bool bReturn = false;
@@ -877,21 +967,41 @@ bool CEpg::IsRemovableTag(const CEpgInfoTag &tag) const
 bool CEpg::LoadFromClients(time_t start, time_t end)
 {
   bool bReturn(false);
-  CPVRChannelPtr channel = Channel();
-  if (channel)
+  CEpg *tmpEpg = FetchEntries(start, end);
+  if (tmpEpg)
   {
-    CEpg tmpEpg(channel);
-    if (tmpEpg.UpdateFromScraper(start, end))
-      bReturn = UpdateEntries(tmpEpg, !g_guiSettings.GetBool("epg.ignoredbforclient"));
+    bReturn = UpdateEntries(*tmpEpg, !g_guiSettings.GetBool("epg.ignoredbforclient"));
+    delete tmpEpg;
   }
-  else
+
+  return bReturn;
+}
+
+CEpg *CEpg::FetchEntries(time_t start, time_t end) const
+{
+  CEpg *tmpEpg = CreateFetchTable();
+  if (!tmpEpg->FetchFromClient(start, end))
   {
-    CEpg tmpEpg(m_iEpgID, m_strName, m_strScraperName);
-    if (tmpEpg.UpdateFromScraper(start, end))
-      bReturn = UpdateEntries(tmpEpg, !g_guiSettings.GetBool("epg.ignoredbforclient"));
+    delete tmpEpg;
+    tmpEpg = NULL;
   }
 
-  return bReturn;
+  return tmpEpg;
+}
+
+CEpg *CEpg::CreateFetchTable(void) const
+{
+  CPVRChannelPtr channel = Channel();
+  if (channel)
+    return new CEpg(channel);
+
+  CSingleLock lock(m_critSection);
+  return new CEpg(m_iEpgID, m_strName, m_strScraperName);
+}
+
+bool CEpg::FetchFromClient(time_t start, time_t end)
+{
+  return UpdateFromScraper(start, end);
 }
 
 CEpgInfoTagPtr CEpg::GetNextEvent(const CEpgInfoTag& tag) const
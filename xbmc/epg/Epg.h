@@ -26,6 +26,7 @@
 
 #include "EpgInfoTag.h"
 #include "EpgSearchFilter.h"
+#include "EpgTextIndex.h"
 #include "utils/Observer.h"
 #include "pvr/channels/PVRChannel.h"
 
@@ -37,6 +38,8 @@ namespace PVR
 /** EPG container for CEpgInfoTag instances */
 namespace EPG
 {
+  class CEpgDatabase;
+
   class CEpg : public Observable
   {
     friend class CEpgDatabase;
@@ -229,6 +232,46 @@ namespace EPG
      */
     bool Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate = false);
 
+    /*!
+     * @brief The first step of Update(). Load this table from the database if needed, clean it up and check whether it has to be updated.
+     * @param iUpdateTime Update the table after the given amount of time has passed.
+     * @param bForceUpdate Force update from client even if it's not the time to
+     * @return True if new entries have to be fetched, false otherwise.
+     */
+    bool StartUpdate(int iUpdateTime, bool bForceUpdate = false);
+
+    /*!
+     * @brief The second step of Update(). Get the entries of this table from its client without changing this table.
+     *        Can be called from any thread.
+     * @param start Only get entries after this start time.
+     * @param end Only get entries before this end time.
+     * @return A temporary table with the entries or NULL if they couldn't be fetched. The caller has to delete it.
+     */
+    CEpg *FetchEntries(time_t start, time_t end) const;
+
+    /*!
+     * @brief Create an empty temporary table that the entries of this table can be fetched into with FetchFromClient().
+     *        The temporary table doesn't reference this table, so it stays valid when this table is deleted.
+     * @return The temporary table. The caller has to delete it.
+     */
+    CEpg *CreateFetchTable(void) const;
+
+    /*!
+     * @brief Get the entries of a table created by CreateFetchTable() from its client. Can be called from any thread.
+     * @param start Only get entries after this start time.
+     * @param end Only get entries before this end time.
+     * @return True if the entries were fetched, false otherwise.
+     */
+    bool FetchFromClient(time_t start, time_t end);
+
+    /*!
+     * @brief The last step of Update(). Merge the fetched entries into this table.
+     * @param entries The entries returned by FetchEntries() or NULL if nothing has to be merged.
+     * @param bGrabSuccess False if fetching the entries failed.
+     * @return True if the update was successful, false otherwise.
+     */
+    bool FinishUpdate(const CEpg *entries, bool bGrabSuccess = true);
+
     /*!
      * @brief Get all EPG entries.
      * @param results The file list to store the results in.
@@ -316,9 +359,16 @@ namespace EPG
      */
     bool PersistTags(void) const;
 
+    /*!
+     * @brief Persist all new and changed tags in this container in one batch.
+     * @param database The database to persist the tags in.
+     * @return True if all tags were persisted, false otherwise.
+     */
+    bool PersistChangedTags(CEpgDatabase &database);
+
     /*!
      * @brief Fix overlapping events from the tables.
-     * @param bUpdateDb If set to yes, any changes to tags during fixing will be persisted to database
+     * @param bUpdateDb If set to yes, tags that are removed will be removed from the database. Changed tags are left for PersistChangedTags()
      * @return True if anything changed, false otherwise.
      */
     bool FixOverlappingEvents(bool bUpdateDb = false);
@@ -347,7 +397,15 @@ namespace EPG
 
     bool IsRemovableTag(const EPG::CEpgInfoTag &tag) const;
 
+    /*!
+     * @brief Get the first tag that covers the given time.
+     * @param time The time in UTC.
+     * @return The tag or m_tags.end() if there is none.
+     */
+    std::map<CDateTime, CEpgInfoTagPtr>::const_iterator FindTagAround(const CDateTime &time) const;
+
     std::map<CDateTime, CEpgInfoTagPtr> m_tags;
+    mutable CEpgTextIndex               m_textIndex;       /*!< word index on m_tags, built on the first search */
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
     bool                                m_bTagsChanged;    /*!< true when any tags are changed and not persisted, false otherwise */
     bool                                m_bLoaded;         /*!< true when the initial entries have been loaded */
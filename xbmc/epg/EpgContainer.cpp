@@ -20,6 +20,7 @@
 
 #include "Application.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "dialogs/GUIDialogExtendedProgressBar.h"
@@ -27,7 +28,9 @@
 #include "guilib/GUIWindowManager.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/log.h"
+#include "utils/JobManager.h"
 #include "pvr/PVRManager.h"
+#include "pvr/channels/PVRChannelGroup.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
 #include "pvr/timers/PVRTimers.h"
 
@@ -36,12 +39,151 @@
 #include "EpgInfoTag.h"
 #include "EpgSearchFilter.h"
 
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
 using namespace std;
 using namespace EPG;
 using namespace PVR;
 
 typedef std::map<int, CEpg*>::iterator EPGITR;
 
+/* don't wait longer than this for running fetch jobs when an update is interrupted.
+   Stop() still waits for them, because they use the clients that are unloaded after it */
+#define EPG_FETCH_INTERRUPT_WAIT 2000
+
+/* entries fetched by the jobs of a single update, waiting to be merged by the update thread.
+   shared by the update and its jobs, so jobs that are still running when the update gives up on them
+   don't touch the container */
+class CEpgFetchResults
+{
+public:
+  CEpgFetchResults(void) : m_iRunningJobs(0), m_bCancelled(false) {}
+
+  struct FetchedEntries
+  {
+    int   iEpgId;    /*!< the id of the table that was updated */
+    int   iClientId; /*!< the client the entries were fetched from */
+    CEpg *entries;   /*!< the fetched entries or NULL if fetching failed */
+  };
+
+  ~CEpgFetchResults()
+  {
+    for (std::vector<FetchedEntries>::iterator it = m_entries.begin(); it != m_entries.end(); it++)
+      delete it->entries;
+  }
+
+  void Add(int iEpgId, int iClientId, CEpg *entries)
+  {
+    FetchedEntries fetched;
+    fetched.iEpgId    = iEpgId;
+    fetched.iClientId = iClientId;
+    fetched.entries   = entries;
+
+    CSingleLock lock(m_section);
+    m_entries.push_back(fetched);
+    --m_iRunningJobs;
+    m_event.Set();
+  }
+
+  void JobStarted(void)
+  {
+    CSingleLock lock(m_section);
+    ++m_iRunningJobs;
+  }
+
+  /* jobs that didn't start fetching yet skip it after the update gave up on them */
+  void Cancel(void)
+  {
+    CSingleLock lock(m_section);
+    m_bCancelled = true;
+  }
+
+  bool IsCancelled(void)
+  {
+    CSingleLock lock(m_section);
+    return m_bCancelled;
+  }
+
+  bool HasRunningJobs(void)
+  {
+    CSingleLock lock(m_section);
+    return m_iRunningJobs > 0;
+  }
+
+  /* wait until all jobs reported their entries */
+  void WaitForJobs(void)
+  {
+    CSingleLock lock(m_section);
+    while (m_iRunningJobs > 0)
+    {
+      CSingleExit exit(m_section);
+      m_event.WaitMSec(100);
+    }
+  }
+
+  void Get(std::vector<FetchedEntries> &entries)
+  {
+    CSingleLock lock(m_section);
+    entries.swap(m_entries);
+  }
+
+  void Wait(unsigned int iTimeout)
+  {
+    m_event.WaitMSec(iTimeout);
+  }
+
+private:
+  std::vector<FetchedEntries> m_entries;
+  int                         m_iRunningJobs;
+  bool                        m_bCancelled;
+  CCriticalSection            m_section;
+  CEvent                      m_event;
+};
+
+/* fetches the entries of a single table from its client into a temporary table.
+   the result is handed over when the job is destroyed, so cancelled jobs that never ran are reported too */
+class CEpgFetchJob : public CJob
+{
+public:
+  CEpgFetchJob(const boost::shared_ptr<CEpgFetchResults> &results, const CEpg &epg, int iClientId, time_t start, time_t end) :
+    m_results(results), m_iEpgId(epg.EpgID()), m_iClientId(iClientId), m_start(start), m_end(end),
+    m_entries(epg.CreateFetchTable()), m_bFetched(false)
+  {
+    m_results->JobStarted();
+  }
+
+  virtual ~CEpgFetchJob()
+  {
+    if (!m_bFetched)
+    {
+      delete m_entries;
+      m_entries = NULL;
+    }
+    m_results->Add(m_iEpgId, m_iClientId, m_entries);
+  }
+
+  virtual const char *GetType() const { return "epgfetch"; }
+
+  virtual bool DoWork()
+  {
+    if (m_results->IsCancelled())
+      return false;
+
+    m_bFetched = m_entries->FetchFromClient(m_start, m_end);
+    return m_bFetched;
+  }
+
+private:
+  boost::shared_ptr<CEpgFetchResults> m_results;
+  int     m_iEpgId;
+  int     m_iClientId;
+  time_t  m_start;
+  time_t  m_end;
+  CEpg   *m_entries;
+  bool    m_bFetched;
+};
+
 CEpgContainer::CEpgContainer(void) :
     CThread("EPG updater")
 {
@@ -145,6 +287,15 @@ bool CEpgContainer::Stop(void)
 {
   StopThread();
 
+  /* fetch jobs the update gave up on may still be calling the clients, which can be unloaded after this */
+  vector<boost::shared_ptr<CEpgFetchResults> > abandonedFetches;
+  {
+    CSingleLock lock(m_critSection);
+    abandonedFetches.swap(m_abandonedFetches);
+  }
+  for (vector<boost::shared_ptr<CEpgFetchResults> >::iterator it = abandonedFetches.begin(); it != abandonedFetches.end(); it++)
+    (*it)->WaitForJobs();
+
   if (m_database.IsOpen())
     m_database.Close();
 
@@ -474,26 +625,97 @@ bool CEpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
     return false;
   }
 
-  /* load or update all EPG tables */
-  CEpg *epg;
+  /* load or update all EPG tables. the entries are fetched by jobs, with at most m_iEpgUpdateJobsPerClient
+     running for each client, and are merged on this thread as soon as they come in */
+  list<CEpg *> tables;
+  GetTablesToUpdate(tables);
+
+  boost::shared_ptr<CEpgFetchResults> results(new CEpgFetchResults);
+  map<int, int> runningJobs;
+  int iRunningJobs(0);
   unsigned int iCounter(0);
-  for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
+  unsigned int iTables(tables.size());
+  unsigned int iGiveUpTime(0);
+  while ((!tables.empty() && !bInterrupted) || iRunningJobs > 0)
   {
-    if (InterruptUpdate())
+    if (!bInterrupted && InterruptUpdate())
     {
       bInterrupted = true;
-      break;
+      iGiveUpTime = XbmcThreads::SystemClockMillis() + EPG_FETCH_INTERRUPT_WAIT;
     }
 
-    epg = it->second;
-    if (!epg)
-      continue;
+    /* start the next tables whose client isn't busy */
+    for (list<CEpg *>::iterator it = tables.begin(); !bInterrupted && it != tables.end();)
+    {
+      CEpg *epg = *it;
+      CPVRChannelPtr channel = epg->Channel();
+      int iClientId = channel ? channel->ClientID() : -1;
+      if (runningJobs[iClientId] >= g_advancedSettings.m_iEpgUpdateJobsPerClient)
+      {
+        it++;
+        continue;
+      }
+      it = tables.erase(it);
 
-    if (bShowProgress && !bOnlyPending)
-          UpdateProgressDialog(++iCounter, m_epgs.size(), epg->Name());
+      if (bShowProgress && !bOnlyPending)
+        UpdateProgressDialog(++iCounter, iTables, epg->Name());
+
+      if (bOnlyPending && !epg->UpdatePending())
+        continue;
+
+      if (!epg->StartUpdate(m_iUpdateTime, bOnlyPending))
+      {
+        if (epg->FinishUpdate(NULL))
+          ++iUpdatedTables;
+        continue;
+      }
+
+      CJobManager::GetInstance().AddJob(new CEpgFetchJob(results, *epg, iClientId, start, end), NULL);
+      ++runningJobs[iClientId];
+      ++iRunningJobs;
+    }
+
+    /* merge the entries that have been fetched */
+    vector<CEpgFetchResults::FetchedEntries> fetched;
+    results->Get(fetched);
+
+    for (vector<CEpgFetchResults::FetchedEntries>::iterator it = fetched.begin(); it != fetched.end(); it++)
+    {
+      --runningJobs[it->iClientId];
+      --iRunningJobs;
+
+      /* the table may have been deleted while its entries were fetched */
+      CEpg *epg = GetById(it->iEpgId);
+      if (epg && epg->FinishUpdate(it->entries, it->entries != NULL))
+        ++iUpdatedTables;
+      delete it->entries;
+    }
 
-    if ((!bOnlyPending || epg->UpdatePending()) && epg->Update(start, end, m_iUpdateTime, bOnlyPending))
-      ++iUpdatedTables;
+    if (fetched.empty() && iRunningJobs > 0)
+    {
+      if (!bInterrupted)
+        results->Wait(1000);
+      else if (XbmcThreads::SystemClockMillis() < iGiveUpTime)
+        results->Wait(100);
+      else
+      {
+        /* the jobs still hold a reference to the results, so they can finish after we're gone.
+           Stop() waits for them before the clients are unloaded */
+        CLog::Log(LOGDEBUG, "EpgContainer - %s - not waiting for %d running fetch jobs", __FUNCTION__, iRunningJobs);
+        results->Cancel();
+
+        CSingleLock lock(m_critSection);
+        for (vector<boost::shared_ptr<CEpgFetchResults> >::iterator it = m_abandonedFetches.begin(); it != m_abandonedFetches.end();)
+        {
+          if ((*it)->HasRunningJobs())
+            it++;
+          else
+            it = m_abandonedFetches.erase(it);
+        }
+        m_abandonedFetches.push_back(results);
+        break;
+      }
+    }
   }
 
   if (bInterrupted)
@@ -527,6 +749,49 @@ bool CEpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
   return !bInterrupted;
 }
 
+void CEpgContainer::GetTablesToUpdate(list<CEpg *> &tables)
+{
+  CPVRChannelPtr playingChannel;
+  CPVRChannelGroupPtr playingGroup;
+  if (g_PVRManager.IsStarted())
+  {
+    bool bRadio = g_PVRManager.GetCurrentChannel(playingChannel) && playingChannel->IsRadio();
+    playingGroup = g_PVRManager.GetPlayingGroup(bRadio);
+  }
+
+  vector<CEpg *> epgs;
+  {
+    CSingleLock lock(m_critSection);
+    for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
+    {
+      if (it->second)
+        epgs.push_back(it->second);
+    }
+  }
+
+  /* the playing channel first, then the channels in the playing group in the order they are
+     shown in the guide, then all others */
+  CEpg *playingEpg(NULL);
+  map<unsigned int, CEpg *> groupMembers;
+  list<CEpg *> others;
+  for (vector<CEpg *>::iterator it = epgs.begin(); it != epgs.end(); it++)
+  {
+    CPVRChannelPtr channel = (*it)->Channel();
+    if (channel && playingChannel && channel->ChannelID() == playingChannel->ChannelID())
+      playingEpg = *it;
+    else if (channel && playingGroup && playingGroup->IsGroupMember(*channel))
+      groupMembers.insert(make_pair(playingGroup->GetChannelNumber(*channel), *it));
+    else
+      others.push_back(*it);
+  }
+
+  if (playingEpg)
+    tables.push_back(playingEpg);
+  for (map<unsigned int, CEpg *>::iterator it = groupMembers.begin(); it != groupMembers.end(); it++)
+    tables.push_back(it->second);
+  tables.splice(tables.end(), others);
+}
+
 int CEpgContainer::GetEPGAll(CFileItemList &results)
 {
   int iInitialSize = results.Size();
@@ -28,8 +28,12 @@
 #include "Epg.h"
 #include "EpgDatabase.h"
 
+#include <boost/shared_ptr.hpp>
+#include <list>
 #include <map>
+#include <vector>
 
+class CEpgFetchResults;
 class CFileItemList;
 class CGUIDialogProgressBarHandle;
 
@@ -237,6 +241,12 @@ namespace EPG
      */
     virtual bool UpdateEPG(bool bOnlyPending = false);
 
+    /*!
+     * @brief Get the tables to update, the ones for the playing channel and the channels in the playing group first.
+     * @param tables The tables in the order they should be updated.
+     */
+    void GetTablesToUpdate(std::list<CEpg *> &tables);
+
     /*!
      * @return True if a running update should be interrupted, false otherwise.
      */
@@ -275,6 +285,7 @@ namespace EPG
     time_t       m_iNextEpgActiveTagCheck; /*!< the time the EPG will be checked for active tag updates */
     unsigned int m_iNextEpgId;             /*!< the next epg ID that will be given to a new table when the db isn't being used */
     std::map<unsigned int, CEpg*> m_epgs;  /*!< the EPGs in this container */
+    std::vector<boost::shared_ptr<CEpgFetchResults> > m_abandonedFetches; /*!< results of interrupted updates with fetch jobs that may still be running */
     //@}
 
     CGUIDialogProgressBarHandle *  m_progressHandle; /*!< the progress dialog that is visible when updating the first time */
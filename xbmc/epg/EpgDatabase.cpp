@@ -24,6 +24,8 @@
 #include "utils/log.h"
 #include "addons/include/xbmc_pvr_types.h"
 
+#include "threads/SingleLock.h"
+
 #include "EpgDatabase.h"
 #include "EpgContainer.h"
 
@@ -383,12 +385,13 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
 
   if (iBroadcastId < 0)
   {
-    strQuery = FormatSQL("INSERT INTO epgtags (idEpg, iStartTime, "
+    /* queued writes are executed as one batch, so don't let an old entry with the same start time fail all of them */
+    strQuery = FormatSQL("%s INTO epgtags (idEpg, iStartTime, "
         "iEndTime, sTitle, sPlotOutline, sPlot, iGenreType, iGenreSubType, sGenre, "
         "iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
         "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid) "
         "VALUES (%u, %u, %u, '%s', '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i);",
-        tag.EpgID(), iStartTime, iEndTime,
+        bSingleUpdate ? "INSERT" : "REPLACE", tag.EpgID(), iStartTime, iEndTime,
         tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
         iFirstAired, tag.ParentalRating(), tag.StarRating(), tag.Notify(),
         tag.SeriesNum(), tag.EpisodeNum(), tag.EpisodePart(), tag.EpisodeName().c_str(),
@@ -421,3 +424,74 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
 
   return iReturn;
 }
+
+bool CEpgDatabase::Persist(const CEpg &epg, const vector<CEpgInfoTagPtr> &tags)
+{
+  bool bReturn(true);
+  bool bNewTags(false);
+  vector<CEpgInfoTagPtr> queuedTags;
+
+  for (vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); it++)
+  {
+    if (Persist(**it, false) < 0)
+    {
+      bReturn = false;
+      continue;
+    }
+
+    if ((*it)->BroadcastId() <= 0)
+      bNewTags = true;
+    queuedTags.push_back(*it);
+  }
+
+  if (queuedTags.empty())
+    return bReturn;
+
+  if (!CommitInsertQueries())
+  {
+    CLog::Log(LOGERROR, "EpgDB - %s - failed to persist the tags of table %d", __FUNCTION__, epg.EpgID());
+    return false;
+  }
+
+  /* get the IDs of the new tags, they're unique per table and start time */
+  map<time_t, int> broadcastIds;
+  if (bNewTags)
+  {
+    CStdString strQuery = FormatSQL("SELECT idBroadcast, iStartTime FROM epgtags WHERE idEpg = %u;", epg.EpgID());
+    if (ResultQuery(strQuery))
+    {
+      try
+      {
+        while (!m_pDS->eof())
+        {
+          broadcastIds.insert(make_pair((time_t) m_pDS->fv("iStartTime").get_asInt(), m_pDS->fv("idBroadcast").get_asInt()));
+          m_pDS->next();
+        }
+        m_pDS->close();
+      }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "EpgDB - %s - couldn't get the IDs of the new tags of table %d", __FUNCTION__, epg.EpgID());
+      }
+    }
+  }
+
+  for (vector<CEpgInfoTagPtr>::const_iterator it = queuedTags.begin(); it != queuedTags.end(); it++)
+  {
+    CEpgInfoTag *tag = it->get();
+    CSingleLock lock(tag->m_critSection);
+    if (tag->m_iBroadcastId <= 0)
+    {
+      time_t iStartTime;
+      tag->m_startTime.GetAsTime(iStartTime);
+      map<time_t, int>::const_iterator id = broadcastIds.find(iStartTime);
+      if (id == broadcastIds.end())
+        continue;
+
+      tag->m_iBroadcastId = id->second;
+    }
+    tag->m_bChanged = false;
+  }
+
+  return bReturn;
+}
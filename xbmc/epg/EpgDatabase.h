@@ -21,6 +21,9 @@
 
 #include "dbwrappers/Database.h"
 #include "XBDateTime.h"
+#include "EpgInfoTag.h"
+
+#include <vector>
 
 namespace EPG
 {
@@ -140,6 +143,15 @@ namespace EPG
      */
     virtual int Persist(const CEpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Persist a batch of tags of a table with a single queued write.
+     *        The database IDs of new tags are fetched afterwards with a single query.
+     * @param epg The table the tags belong to. It has to be persisted already.
+     * @param tags The tags to persist.
+     * @return True if all tags were persisted, false otherwise.
+     */
+    virtual bool Persist(const CEpg &epg, const std::vector<CEpgInfoTagPtr> &tags);
+
     //@}
 
   protected:
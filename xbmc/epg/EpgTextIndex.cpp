@@ -0,0 +1,219 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgTextIndex.h"
+#include "guilib/LocalizeStrings.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+using namespace std;
+using namespace EPG;
+
+/* removed ids are only dropped from the word lists once there are this many */
+#define EPG_INDEX_COMPACT_THRESHOLD 1024
+
+static bool SortByStartTime(const CEpgInfoTagPtr &left, const CEpgInfoTagPtr &right)
+{
+  return left->StartAsUTC() < right->StartAsUTC();
+}
+
+CEpgTextIndex::CEpgTextIndex(void) :
+    m_bBuilt(false),
+    m_iRemoved(0)
+{
+}
+
+void CEpgTextIndex::Build(const map<CDateTime, CEpgInfoTagPtr> &tags)
+{
+  Clear();
+  m_bBuilt = true;
+
+  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); it++)
+    Add(it->second);
+}
+
+void CEpgTextIndex::Clear(void)
+{
+  m_bBuilt = false;
+  m_tags.clear();
+  m_ids.clear();
+  m_words.clear();
+  m_iRemoved = 0;
+}
+
+void CEpgTextIndex::Add(const CEpgInfoTagPtr &tag)
+{
+  if (!m_bBuilt || !tag)
+    return;
+
+  Remove(tag.get());
+
+  unsigned int iId = m_tags.size();
+  m_tags.push_back(tag);
+  m_ids.insert(make_pair(tag.get(), iId));
+
+  /* ids only grow, so the word lists stay sorted */
+  vector<CStdString> words;
+  GetWords(*tag, words);
+  for (vector<CStdString>::const_iterator it = words.begin(); it != words.end(); it++)
+    m_words[*it].push_back(iId);
+}
+
+void CEpgTextIndex::Remove(const CEpgInfoTag *tag)
+{
+  if (!m_bBuilt)
+    return;
+
+  map<const CEpgInfoTag *, unsigned int>::iterator it = m_ids.find(tag);
+  if (it == m_ids.end())
+    return;
+
+  m_tags[it->second].reset();
+  m_ids.erase(it);
+
+  if (++m_iRemoved > EPG_INDEX_COMPACT_THRESHOLD && m_iRemoved > m_ids.size())
+    Compact();
+}
+
+void CEpgTextIndex::Compact(void)
+{
+  vector<CEpgInfoTagPtr> tags;
+  for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  {
+    if (*it)
+      tags.push_back(*it);
+  }
+
+  Clear();
+  m_bBuilt = true;
+
+  for (vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); it++)
+    Add(*it);
+}
+
+void CEpgTextIndex::GetWords(const CEpgInfoTag &tag, vector<CStdString> &words)
+{
+  /* the same fields EpgSearchFilter::MatchSearchTerm() looks at, lowered the same way as CTextSearch does.
+     the index outlives the parental lock of the channel and the "no information" setting, so the real
+     text is indexed together with the placeholders that are shown instead of it */
+  CStdString strTitle = tag.Title(true);
+  CStdString strText = strTitle + " " + tag.PlotOutline(true);
+  if (tag.HasPVRChannel())
+    strText += " " + g_localizeStrings.Get(19266); // parental locked
+  if (strTitle.IsEmpty() || strTitle == g_localizeStrings.Get(19055))
+    strText += " " + g_localizeStrings.Get(19055); // no information available
+  strText = strText.ToLower();
+
+  CStdStringArray parts;
+  StringUtils::SplitString(strText, " ", parts);
+  for (unsigned int iPtr = 0; iPtr < parts.size(); iPtr++)
+  {
+    if (!parts[iPtr].IsEmpty())
+      words.push_back(parts[iPtr]);
+  }
+
+  sort(words.begin(), words.end());
+  words.erase(unique(words.begin(), words.end()), words.end());
+}
+
+bool CEpgTextIndex::GetCandidates(const CStdString &strTerm, vector<unsigned int> &ids) const
+{
+  /* a match of the term contains its longest space separated part within a single word */
+  CStdString strLowerTerm(strTerm);
+  strLowerTerm = strLowerTerm.ToLower();
+
+  CStdStringArray parts;
+  StringUtils::SplitString(strLowerTerm, " ", parts);
+  CStdString strPart;
+  for (unsigned int iPtr = 0; iPtr < parts.size(); iPtr++)
+  {
+    if (parts[iPtr].length() > strPart.length())
+      strPart = parts[iPtr];
+  }
+
+  if (strPart.IsEmpty())
+    return false;
+
+  set<unsigned int> found;
+  for (map<CStdString, Postings>::const_iterator it = m_words.begin(); it != m_words.end(); it++)
+  {
+    if (it->first.Find(strPart) != -1)
+      found.insert(it->second.begin(), it->second.end());
+  }
+
+  ids.assign(found.begin(), found.end());
+  return true;
+}
+
+bool CEpgTextIndex::GetCandidates(const CTextSearch &search, vector<CEpgInfoTagPtr> &candidates) const
+{
+  if (!m_bBuilt)
+    return false;
+
+  vector<unsigned int> ids;
+  bool bNarrowed(false);
+
+  /* at least one of the OR terms has to match */
+  const vector<CStdString> &orTerms = search.OrTerms();
+  for (vector<CStdString>::const_iterator it = orTerms.begin(); it != orTerms.end(); it++)
+  {
+    vector<unsigned int> termIds, merged;
+    if (!GetCandidates(*it, termIds))
+      return false;
+
+    set_union(ids.begin(), ids.end(), termIds.begin(), termIds.end(), back_inserter(merged));
+    ids.swap(merged);
+    bNarrowed = true;
+  }
+
+  /* and all of the AND terms */
+  const vector<CStdString> &andTerms = search.AndTerms();
+  for (vector<CStdString>::const_iterator it = andTerms.begin(); it != andTerms.end(); it++)
+  {
+    vector<unsigned int> termIds, merged;
+    if (!GetCandidates(*it, termIds))
+      continue;
+
+    if (!bNarrowed)
+      ids.swap(termIds);
+    else
+    {
+      set_intersection(ids.begin(), ids.end(), termIds.begin(), termIds.end(), back_inserter(merged));
+      ids.swap(merged);
+    }
+    bNarrowed = true;
+  }
+
+  if (!bNarrowed)
+    return false;
+
+  for (vector<unsigned int>::const_iterator it = ids.begin(); it != ids.end(); it++)
+  {
+    if (m_tags[*it])
+      candidates.push_back(m_tags[*it]);
+  }
+  sort(candidates.begin(), candidates.end(), SortByStartTime);
+
+  return true;
+}
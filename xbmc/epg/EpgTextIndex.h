@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgInfoTag.h"
+
+#include <map>
+#include <vector>
+
+class CTextSearch;
+
+namespace EPG
+{
+  /** Inverted word index over the searchable text of the tags in an EPG table */
+
+  class CEpgTextIndex
+  {
+  public:
+    CEpgTextIndex(void);
+
+    /*!
+     * @return True if the index has been built, false otherwise.
+     */
+    bool IsBuilt(void) const { return m_bBuilt; }
+
+    /*!
+     * @brief Index all given tags, replacing the current contents.
+     * @param tags The tags to index.
+     */
+    void Build(const std::map<CDateTime, CEpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Drop the index. It will have to be built again before it can be used.
+     */
+    void Clear(void);
+
+    /*!
+     * @brief Add a tag to the index, or re-index it if it was added before.
+     * @param tag The tag to add.
+     */
+    void Add(const CEpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove a tag from the index.
+     * @param tag The tag to remove.
+     */
+    void Remove(const CEpgInfoTag *tag);
+
+    /*!
+     * @brief Get the tags that can match the given search.
+     * @param search The search.
+     * @param candidates The tags that can match, sorted by start time. The search still has to be applied to them.
+     * @return False if the search can't be narrowed down with this index and all tags have to be checked.
+     */
+    bool GetCandidates(const CTextSearch &search, std::vector<CEpgInfoTagPtr> &candidates) const;
+
+  private:
+    typedef std::vector<unsigned int> Postings;
+
+    bool GetCandidates(const CStdString &strTerm, std::vector<unsigned int> &ids) const;
+    static void GetWords(const CEpgInfoTag &tag, std::vector<CStdString> &words);
+
+    void Compact(void);
+
+    bool                                        m_bBuilt;   /*!< true when the index has been built */
+    std::vector<CEpgInfoTagPtr>                 m_tags;     /*!< indexed tags by id, empty when removed */
+    std::map<const CEpgInfoTag *, unsigned int> m_ids;      /*!< id of each indexed tag */
+    std::map<CStdString, Postings>              m_words;    /*!< ids of the tags containing each word, in ascending order */
+    unsigned int                                m_iRemoved; /*!< removed ids still listed in m_words */
+  };
+}
@@ -25,6 +25,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "guilib/DirtyRegion.h"
 #include <tinyxml.h>
+#include <algorithm>
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "threads/SystemClock.h"
@@ -90,7 +91,10 @@ CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID, int controlID, float po
   m_cacheChannelItems     = preloadItems;
   m_cacheRulerItems       = preloadItems;
   m_cacheProgrammeItems   = preloadItems;
-  m_gridIndex             = NULL;
+  m_item                  = NULL;
+  m_emptyGridItem.width   = 0;
+  m_emptyGridItem.height  = 0;
+  m_emptyGridItem.block   = 0;
 }
 
 CGUIEPGGridContainer::~CGUIEPGGridContainer(void)
@@ -317,26 +321,23 @@ void CGUIEPGGridContainer::Render()
     int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    GridItemsPtr *gridItem = GetGridItem(channel, block);
+    if (gridItem->item && gridItem->block < blockOffset)
     {
       /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
+      block = gridItem->block;
       int missingSection = blockOffset - block;
       posA2 -= missingSection * m_blockSize;
     }
 
     while (posA2 < endA && m_programmeItems.size())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      gridItem = GetGridItem(channel, block);
+      CGUIListItemPtr item = gridItem->item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == GetGridItem(m_channelOffset + m_channelCursor, m_blockOffset + m_blockCursor)->item);
 
       // render our item
       if (focused)
@@ -352,27 +353,27 @@ void CGUIEPGGridContainer::Render()
           focusedPosY = posA2;
         }
         focusedItem = item;
-        focusedwidth = m_gridIndex[channel][block].width;
-        focusedheight = m_gridIndex[channel][block].height;
+        focusedwidth = gridItem->width;
+        focusedheight = gridItem->height;
       }
       else
       {
         if (m_orientation == VERTICAL)
-          RenderProgrammeItem(posA2, posB, m_gridIndex[channel][block].width, m_gridIndex[channel][block].height, item.get(), focused);
+          RenderProgrammeItem(posA2, posB, gridItem->width, gridItem->height, item.get(), focused);
         else
-          RenderProgrammeItem(posB, posA2, m_gridIndex[channel][block].width, m_gridIndex[channel][block].height, item.get(), focused);
+          RenderProgrammeItem(posB, posA2, gridItem->width, gridItem->height, item.get(), focused);
       }
 
       // increment our X position
       if (m_orientation == VERTICAL)
       {
-        posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-        block += (int)(m_gridIndex[channel][block].width / m_blockSize);
+        posA2 += gridItem->width; // assumes focused & unfocused layouts have equal length
+        block += (int)(gridItem->width / m_blockSize);
       }
       else
       {
-        posA2 += m_gridIndex[channel][block].height; // assumes focused & unfocused layouts have equal length
-        block += (int)(m_gridIndex[channel][block].height / m_blockSize);
+        posA2 += gridItem->height; // assumes focused & unfocused layouts have equal length
+        block += (int)(gridItem->height / m_blockSize);
       }
     }
 
@@ -710,14 +711,6 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
         m_programmeItems.push_back(items->Get(i));
 
       ClearGridIndex();
-      m_gridIndex = (struct GridItemsPtr **) calloc(1,m_channelItems.size()*sizeof(struct GridItemsPtr*));
-      if (m_gridIndex != NULL)
-      {
-        for (unsigned int i = 0; i < m_channelItems.size(); i++)
-        {
-          m_gridIndex[i] = (struct GridItemsPtr*) calloc(1,MAXBLOCKS*sizeof(struct GridItemsPtr));
-        }
-      }
 
       UpdateLayout(true); // true to refresh all items
 
@@ -756,7 +749,7 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
 
 void CGUIEPGGridContainer::UpdateItems()
 {
-  CDateTimeSpan blockDuration, gridDuration;
+  CDateTimeSpan gridDuration;
 
   /* check for invalid start and end time */
   if (m_gridStart >= m_gridEnd)
@@ -782,99 +775,9 @@ void CGUIEPGGridContainer::UpdateItems()
     return;
   }
 
-  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
-
-  long tick(XbmcThreads::SystemClockMillis());
-
-  for (unsigned int row = 0; row < m_channelItems.size(); ++row)
-  {
-    CDateTime gridCursor  = m_gridStart; //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[row].start;
-    unsigned long lastIdx = m_epgItemsPtr[row].stop;
-    int iEpgId            = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag()->EpgID();
-
-    /** FOR EACH BLOCK **********************************************************************/
-
-    for (int block = 0; block < m_blocks; block++)
-    {
-      while (progIdx <= lastIdx)
-      {
-        CGUIListItemPtr item = m_programmeItems[progIdx];
-        const CEpgInfoTag* tag = ((CFileItem *)item.get())->GetEPGInfoTag();
-        if (tag == NULL)
-          progIdx++;
-
-        if (tag->EpgID() != iEpgId)
-          break;
-
-        if (m_gridEnd <= tag->StartAsUTC())
-        {
-          break;
-        }
-        else if (gridCursor >= tag->EndAsUTC())
-        {
-          progIdx++;
-        }
-        else if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[row][block].item = item;
-          break;
-        }
-        else
-        {
-          progIdx++;
-        }
-      }
-
-      gridCursor += blockDuration;
-    }
-
-    /** FOR EACH BLOCK **********************************************************************/
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
-
-    for (int block = 0; block < m_blocks; block++)
-    {
-      if (m_gridIndex[row][block].item != m_gridIndex[row][block+1].item)
-      {
-        if (!m_gridIndex[row][block].item)
-        {
-          CEpgInfoTag broadcast;
-          CFileItemPtr unknown(new CFileItem(broadcast));
-          for (int i = block ; i > block - itemSize; i--)
-          {
-            m_gridIndex[row][i].item = unknown;
-          }
-        }
-
-        CGUIListItemPtr item = m_gridIndex[row][block].item;
-        CFileItem *fileItem = (CFileItem *)item.get();
-
-        m_gridIndex[row][savedBlock].item->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
-        if (m_orientation == VERTICAL)
-        {
-          m_gridIndex[row][savedBlock].width   = itemSize*m_blockSize;
-          m_gridIndex[row][savedBlock].height  = m_channelHeight;
-        }
-        else
-        {
-          m_gridIndex[row][savedBlock].width   = m_channelWidth;
-          m_gridIndex[row][savedBlock].height  = itemSize*m_blockSize;
-        }
-
-        itemSize = 1;
-        savedBlock = block+1;
-      }
-      else
-      {
-        itemSize++;
-      }
-    }
-  }
-
-  /******************************************* END ******************************************/
-
-  CLog::Log(LOGDEBUG, "%s completed successfully in %u ms", __FUNCTION__, (unsigned int)(XbmcThreads::SystemClockMillis()-tick));
+  /* the rows are only filled once they are shown or navigated to */
+  ClearGridIndex();
+  m_gridIndex.resize(m_channelItems.size());
 
   m_channels = (int)m_epgItemsPtr.size();
   m_item = GetItem(m_channelCursor);
@@ -967,7 +870,7 @@ bool CGUIEPGGridContainer::MoveChannel(bool direction)
 
 bool CGUIEPGGridContainer::MoveProgrammes(bool direction)
 {
-  if (!m_gridIndex || !m_item)
+  if (m_gridIndex.empty() || !m_item)
     return false;
 
   if (direction)
@@ -975,7 +878,7 @@ bool CGUIEPGGridContainer::MoveProgrammes(bool direction)
     if (m_channelCursor + m_channelOffset < 0 || m_blockOffset < 0)
       return false;
 
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blockOffset].item)
+    if (m_item->item != GetGridItem(m_channelCursor + m_channelOffset, m_blockOffset)->item)
     {
       // this is not first item on page
       m_item = GetPrevItem(m_channelCursor);
@@ -1024,7 +927,7 @@ bool CGUIEPGGridContainer::MoveProgrammes(bool direction)
   }
   else
   {
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blocksPerPage + m_blockOffset - 1].item)
+    if (m_item->item != GetGridItem(m_channelCursor + m_channelOffset, m_blocksPerPage + m_blockOffset - 1)->item)
     {
       // this is not last item on page
       m_item = GetNextItem(m_channelCursor);
@@ -1310,13 +1213,13 @@ bool CGUIEPGGridContainer::OnMouseWheel(char wheel, const CPoint &point)
 
 int CGUIEPGGridContainer::GetSelectedItem() const
 {
-  if (!m_gridIndex ||
+  if (m_gridIndex.empty() ||
       !m_epgItemsPtr.size() ||
       m_channelCursor + m_channelOffset >= (int)m_channelItems.size() ||
       m_blockCursor + m_blockOffset >= (int)m_programmeItems.size())
     return 0;
 
-  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
+  CGUIListItemPtr currentItem = GetGridItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset)->item;
   if (!currentItem)
     return 0;
 
@@ -1365,9 +1268,9 @@ GridItemsPtr *CGUIEPGGridContainer::GetClosestItem(const int &channel)
   }
 
   if (right <= SHORTGAP && right <= left && m_blockCursor + right < m_blocksPerPage)
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + right + m_blockOffset];
+    return GetGridItem(channel + m_channelOffset, m_blockCursor + right + m_blockOffset);
 
-  return &m_gridIndex[channel + m_channelOffset][m_blockCursor - left  + m_blockOffset];
+  return GetGridItem(channel + m_channelOffset, m_blockCursor - left  + m_blockOffset);
 }
 
 int CGUIEPGGridContainer::GetItemSize(GridItemsPtr *item)
@@ -1388,44 +1291,137 @@ int CGUIEPGGridContainer::GetBlock(const CGUIListItemPtr &item, const int &chann
 
 int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, const int &channel)
 {
-  int block = 0;
+  if (channel + m_channelOffset < 0 || channel + m_channelOffset >= (int)m_gridIndex.size())
+    return m_blocks;
+
+  const GridRow &row = m_gridIndex[channel + m_channelOffset];
+  if (!row.bBuilt)
+    BuildGridRow(channel + m_channelOffset);
 
-  while (m_gridIndex[channel + m_channelOffset][block].item != item && block < m_blocks)
-    block++;
+  for (vector<GridItemsPtr>::const_iterator it = row.items.begin(); it != row.items.end(); it++)
+  {
+    if (it->item == item)
+      return it->block;
+  }
 
-  return block;
+  return m_blocks;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
 {
   int i = m_blockCursor;
 
-  while (m_gridIndex[channel + m_channelOffset][i + m_blockOffset].item == m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset].item && i < m_blocksPerPage)
+  while (GetGridItem(channel + m_channelOffset, i + m_blockOffset)->item == GetGridItem(channel + m_channelOffset, m_blockCursor + m_blockOffset)->item && i < m_blocksPerPage)
     i++;
 
-  return &m_gridIndex[channel + m_channelOffset][i + m_blockOffset];
+  return GetGridItem(channel + m_channelOffset, i + m_blockOffset);
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
 {
   int i = m_blockCursor;
 
-  while (m_gridIndex[channel + m_channelOffset][i + m_blockOffset].item == m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset].item && i > 0)
+  while (GetGridItem(channel + m_channelOffset, i + m_blockOffset)->item == GetGridItem(channel + m_channelOffset, m_blockCursor + m_blockOffset)->item && i > 0)
     i--;
 
-  return &m_gridIndex[channel + m_channelOffset][i + m_blockOffset];
-
-//  return &m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset - 1];
+  return GetGridItem(channel + m_channelOffset, i + m_blockOffset);
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
 {
   if ( (channel >= 0) && (channel < m_channels) )
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset];
+    return GetGridItem(channel + m_channelOffset, m_blockCursor + m_blockOffset);
   else
     return NULL;
 }
 
+void CGUIEPGGridContainer::BuildGridRow(int channel) const
+{
+  GridRow &row = m_gridIndex[channel];
+  row.bBuilt = true;
+  row.items.clear();
+
+  if (channel >= (int)m_epgItemsPtr.size())
+    return;
+
+  unsigned long progIdx = m_epgItemsPtr[channel].start;
+  unsigned long lastIdx = m_epgItemsPtr[channel].stop;
+  int iEpgId            = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag()->EpgID();
+  int block             = 0;
+
+  /* a programme fills all blocks from the end of the previous one up to its own end */
+  for (; progIdx <= lastIdx && block < m_blocks; progIdx++)
+  {
+    CGUIListItemPtr item = m_programmeItems[progIdx];
+    const CEpgInfoTag* tag = ((CFileItem *)item.get())->GetEPGInfoTag();
+    if (tag == NULL)
+      continue;
+
+    if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+      break;
+
+    if (tag->EndAsUTC() <= m_gridStart)
+      continue;
+
+    CDateTimeSpan duration = tag->EndAsUTC() - m_gridStart;
+    int iSeconds  = duration.GetDays()*24*60*60 + duration.GetHours()*60*60 + duration.GetMinutes()*60 + duration.GetSeconds();
+    int iEndBlock = (iSeconds + MINSPERBLOCK*60 - 1) / (MINSPERBLOCK*60);
+    if (iEndBlock > m_blocks)
+      iEndBlock = m_blocks;
+    if (iEndBlock <= block)
+      continue;
+
+    GridItemsPtr gridItem;
+    gridItem.item  = item;
+    gridItem.block = block;
+    gridItem.width = gridItem.height = (iEndBlock - block) * m_blockSize;
+    row.items.push_back(gridItem);
+    block = iEndBlock;
+  }
+
+  if (block < m_blocks)
+  {
+    CEpgInfoTag broadcast;
+    GridItemsPtr gridItem;
+    gridItem.item  = CFileItemPtr(new CFileItem(broadcast));
+    gridItem.block = block;
+    gridItem.width = gridItem.height = (m_blocks - block) * m_blockSize;
+    row.items.push_back(gridItem);
+  }
+
+  for (vector<GridItemsPtr>::iterator it = row.items.begin(); it != row.items.end(); it++)
+  {
+    CFileItem *fileItem = (CFileItem *)it->item.get();
+    fileItem->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
+    if (m_orientation == VERTICAL)
+      it->height = m_channelHeight;
+    else
+      it->width  = m_channelWidth;
+  }
+}
+
+static bool GridItemStartsAfter(int block, const GridItemsPtr &item)
+{
+  return block < item.block;
+}
+
+GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block) const
+{
+  if (channel < 0 || channel >= (int)m_gridIndex.size() || block < 0 || block >= m_blocks)
+    return &m_emptyGridItem;
+
+  GridRow &row = m_gridIndex[channel];
+  if (!row.bBuilt)
+    BuildGridRow(channel);
+
+  /* the last programme that starts at or before this block */
+  vector<GridItemsPtr>::iterator it = upper_bound(row.items.begin(), row.items.end(), block, GridItemStartsAfter);
+  if (it == row.items.begin())
+    return &m_emptyGridItem;
+
+  return &*(--it);
+}
+
 void CGUIEPGGridContainer::SetFocus(bool bOnOff)
 {
   if (bOnOff != HasFocus())
@@ -1599,19 +1595,16 @@ CStdString CGUIEPGGridContainer::GetDescription() const
 
 void CGUIEPGGridContainer::ClearGridIndex(void)
 {
-  if (m_gridIndex)
+  for (vector<GridRow>::iterator row = m_gridIndex.begin(); row != m_gridIndex.end(); row++)
   {
-    for (unsigned int i = 0; i < m_channelItems.size(); i++)
+    for (vector<GridItemsPtr>::iterator it = row->items.begin(); it != row->items.end(); it++)
     {
-      for (int block = 0; block < m_blocks; block++)
-      {
-        if (m_gridIndex[i][block].item)
-          m_gridIndex[i][block].item.get()->ClearProperties();
-      }
-      free(m_gridIndex[i]);
+      if (it->item)
+        it->item.get()->ClearProperties();
     }
-    free(m_gridIndex);
   }
+  m_gridIndex.clear();
+  m_item = NULL;
 }
 
 void CGUIEPGGridContainer::Reset()
@@ -1626,7 +1619,6 @@ void CGUIEPGGridContainer::Reset()
 
   m_lastItem    = NULL;
   m_lastChannel = NULL;
-  m_gridIndex   = NULL;
 }
 
 void CGUIEPGGridContainer::GoToBegin()
@@ -1642,10 +1634,10 @@ void CGUIEPGGridContainer::GoToEnd()
   int blockOffset = 0; // the block offset to scroll to
   for (int blockIndex = m_blocks; blockIndex >= 0 && (!blocksEnd || !blocksStart); blockIndex--)
   {
-    if (!blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item != NULL)
+    if (!blocksEnd && GetGridItem(m_channelCursor + m_channelOffset, blockIndex)->item != NULL)
       blocksEnd = blockIndex;
-    if (blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blocksEnd].item != 
-                     m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item)
+    if (blocksEnd && GetGridItem(m_channelCursor + m_channelOffset, blocksEnd)->item !=
+                     GetGridItem(m_channelCursor + m_channelOffset, blockIndex)->item)
       blocksStart = blockIndex + 1;
   }
   if (blocksEnd - blocksStart > m_blocksPerPage)
@@ -40,6 +40,14 @@ namespace EPG
     CGUIListItemPtr item;
     float width;
     float height;
+    int   block; //! first block of the programme
+  };
+
+  /*! the programmes of one channel in the grid, one entry per programme instead of one per block */
+  struct GridRow
+  {
+    bool                      bBuilt; //! false until the row is first needed
+    std::vector<GridItemsPtr> items;  //! the programmes, sorted by their first block
   };
 
   class CGUIEPGGridContainer : public CGUIControl
@@ -110,6 +118,8 @@ namespace EPG
     void CalculateLayout();
     void Reset();
     void ClearGridIndex(void);
+    void BuildGridRow(int channel) const;
+    GridItemsPtr *GetGridItem(int channel, int block) const;
 
     GridItemsPtr *GetItem(const int &channel);
     GridItemsPtr *GetNextItem(const int &channel);
@@ -205,7 +215,8 @@ namespace EPG
     CDateTime m_gridStart;
     CDateTime m_gridEnd;
 
-    struct GridItemsPtr **m_gridIndex;
+    mutable std::vector<GridRow> m_gridIndex; //! built per row on demand
+    mutable GridItemsPtr m_emptyGridItem;     //! returned for blocks outside of the grid
     GridItemsPtr *m_item;
     CGUIListItem *m_lastItem;
     CGUIListItem *m_lastChannel;
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "epg/EpgTextIndex.h"
+#include "pvr/channels/PVRChannel.h"
+#include "utils/TextSearch.h"
+
+#include "gtest/gtest.h"
+
+using namespace EPG;
+
+static CEpgInfoTagPtr CreateTag(int iHour, const CStdString &strTitle, const CStdString &strPlotOutline)
+{
+  CEpgInfoTagPtr tag(new CEpgInfoTag());
+  tag->SetStartFromUTC(CDateTime(2012, 10, 1, iHour, 0, 0));
+  tag->SetTitle(strTitle);
+  tag->SetPlotOutline(strPlotOutline);
+  return tag;
+}
+
+static std::vector<CEpgInfoTagPtr> Find(const CEpgTextIndex &index, const CStdString &strSearch)
+{
+  std::vector<CEpgInfoTagPtr> candidates;
+  EXPECT_TRUE(index.GetCandidates(CTextSearch(strSearch), candidates));
+  return candidates;
+}
+
+class TestEpgTextIndex : public testing::Test
+{
+protected:
+  TestEpgTextIndex()
+  {
+    m_news    = CreateTag(20, "Evening News", "Headlines of the day");
+    m_weather = CreateTag(21, "Weather", "The forecast for tomorrow");
+    m_movie   = CreateTag(22, "Late Movie", "A film about the news business");
+
+    std::map<CDateTime, CEpgInfoTagPtr> tags;
+    tags.insert(std::make_pair(m_news->StartAsUTC(), m_news));
+    tags.insert(std::make_pair(m_weather->StartAsUTC(), m_weather));
+    m_index.Build(tags);
+  }
+
+  CEpgTextIndex  m_index;
+  CEpgInfoTagPtr m_news;
+  CEpgInfoTagPtr m_weather;
+  CEpgInfoTagPtr m_movie;
+};
+
+TEST_F(TestEpgTextIndex, Build)
+{
+  CEpgTextIndex index;
+  std::vector<CEpgInfoTagPtr> candidates;
+  EXPECT_FALSE(index.IsBuilt());
+  EXPECT_FALSE(index.GetCandidates(CTextSearch("news"), candidates));
+
+  EXPECT_TRUE(m_index.IsBuilt());
+  candidates = Find(m_index, "NEWS");
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(m_news, candidates[0]);
+
+  /* words of the plot outline and parts of words are found too */
+  candidates = Find(m_index, "forecast");
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(m_weather, candidates[0]);
+  EXPECT_EQ(1u, Find(m_index, "head").size());
+  EXPECT_TRUE(Find(m_index, "sports").empty());
+}
+
+TEST_F(TestEpgTextIndex, Add)
+{
+  m_index.Add(m_movie);
+
+  /* sorted by start time */
+  std::vector<CEpgInfoTagPtr> candidates = Find(m_index, "news");
+  ASSERT_EQ(2u, candidates.size());
+  EXPECT_EQ(m_news, candidates[0]);
+  EXPECT_EQ(m_movie, candidates[1]);
+
+  /* an OR search returns the tags that match either term, an AND search the ones that match both */
+  EXPECT_EQ(3u, Find(m_index, "news weather").size());
+  candidates = Find(m_index, "news +film");
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(m_movie, candidates[0]);
+}
+
+TEST_F(TestEpgTextIndex, Remove)
+{
+  m_index.Remove(m_news.get());
+  EXPECT_TRUE(Find(m_index, "news").empty());
+  EXPECT_EQ(1u, Find(m_index, "weather").size());
+
+  /* removing a tag that isn't indexed does nothing */
+  m_index.Remove(m_movie.get());
+  EXPECT_EQ(1u, Find(m_index, "weather").size());
+}
+
+TEST_F(TestEpgTextIndex, Update)
+{
+  m_weather->SetTitle("Sports");
+  m_index.Add(m_weather);
+
+  EXPECT_TRUE(Find(m_index, "weather").empty());
+  std::vector<CEpgInfoTagPtr> candidates = Find(m_index, "sports");
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(m_weather, candidates[0]);
+
+  /* the plot outline didn't change */
+  EXPECT_EQ(1u, Find(m_index, "forecast").size());
+}
+
+TEST_F(TestEpgTextIndex, LockedChannel)
+{
+  /* the real text of tags on a locked channel is indexed, so they are found once the channel is unlocked */
+  PVR::CPVRChannelPtr channel(new PVR::CPVRChannel(false));
+  channel->SetLocked(true);
+  m_movie->SetPVRChannel(channel);
+  m_index.Add(m_movie);
+
+  std::vector<CEpgInfoTagPtr> candidates = Find(m_index, "film");
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(m_movie, candidates[0]);
+
+  channel->SetLocked(false);
+  EXPECT_EQ(1u, Find(m_index, "film").size());
+}
@@ -30,6 +30,7 @@
 #include <sys/stat.h>
 #ifdef _LINUX
 #include <sys/ioctl.h>
+#include <fcntl.h>
 #else
 #include <io.h>
 #include "utils/CharsetConverter.h"
@@ -326,6 +327,10 @@ int CHDFile::IoControl(EIoControl request, void* param)
     SNativeIoControl* s = (SNativeIoControl*)param;
     return ioctl((*m_hFile).fd, s->request, s->param);
   }
+#endif
+#if defined(TARGET_POSIX) && defined(POSIX_FADV_SEQUENTIAL)
+  if(request == IOCTRL_SEQUENTIAL_ACCESS)
+    return posix_fadvise((*m_hFile).fd, 0, 0, POSIX_FADV_SEQUENTIAL) == 0 ? 0 : -1;
 #endif
   return -1;
 }
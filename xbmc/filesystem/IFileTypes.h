@@ -43,6 +43,7 @@ typedef enum {
   IOCTRL_CACHE_STATUS  = 3, /**< SCacheStatus structure */
   IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with speed limit for caching in bytes per second */
   IOCTRL_SET_CACHE    = 8, /** <CFileCache */
+  IOCTRL_SEQUENTIAL_ACCESS = 9, /**< hint that the file is read sequentially, no parameter */
 } EIoControl;
 
 }
@@ -613,6 +613,12 @@ int CGUIBaseContainer::GetSelectedItem() const
   return CorrectOffset(GetOffset(), GetCursor());
 }
 
+void CGUIBaseContainer::GetVisibleItems(int &first, int &last) const
+{
+  first = std::max(CorrectOffset(GetOffset(), 0), 0);
+  last = std::min(CorrectOffset(GetOffset() + m_itemsPerPage, 0), (int)m_items.size()) - 1;
+}
+
 CGUIListItemPtr CGUIBaseContainer::GetListItem(int offset, unsigned int flag) const
 {
   if (!m_items.size())
@@ -67,6 +67,12 @@ public:
   virtual void SaveStates(std::vector<CControlState> &states);
   virtual int GetSelectedItem() const;
 
+  /*! \brief Get the range of items that are on screen
+   \param first [out] index of the first item on screen
+   \param last [out] index of the last item on screen, smaller than first if there are none
+   */
+  void GetVisibleItems(int &first, int &last) const;
+
   virtual void DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions);
   virtual void Process(unsigned int currentTime, CDirtyRegionList &dirtyregions);
 
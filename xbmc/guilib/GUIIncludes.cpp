@@ -174,21 +174,21 @@ bool CGUIIncludes::HasIncludeFile(const CStdString &file) const
   return false;
 }
 
-void CGUIIncludes::ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */)
+void CGUIIncludes::ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */, std::set<CStdString>* includeFiles /* = NULL */)
 {
   if (!node)
     return;
-  ResolveIncludesForNode(node, xmlIncludeConditions);
+  ResolveIncludesForNode(node, xmlIncludeConditions, includeFiles);
 
   TiXmlElement *child = node->FirstChildElement();
   while (child)
   {
-    ResolveIncludes(child, xmlIncludeConditions);
+    ResolveIncludes(child, xmlIncludeConditions, includeFiles);
     child = child->NextSiblingElement();
   }
 }
 
-void CGUIIncludes::ResolveIncludesForNode(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */)
+void CGUIIncludes::ResolveIncludesForNode(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions /* = NULL */, std::set<CStdString>* includeFiles /* = NULL */)
 {
   // we have a node, find any <include file="fileName">tagName</include> tags and replace
   // recursively with their real includes
@@ -220,7 +220,10 @@ void CGUIIncludes::ResolveIncludesForNode(TiXmlElement *node, std::map<int, bool
     const char *file = include->Attribute("file");
     if (file)
     { // we need to load this include from the alternative file
-      LoadIncludes(g_SkinInfo->GetSkinPath(file));
+      CStdString includeFile = g_SkinInfo->GetSkinPath(file);
+      LoadIncludes(includeFile);
+      if (includeFiles)
+        includeFiles->insert(includeFile);
     }
     const char *condition = include->Attribute("condition");
     if (condition)
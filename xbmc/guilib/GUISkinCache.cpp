@@ -0,0 +1,322 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUISkinCache.h"
+#include "addons/Skin.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+#define SKIN_CACHE_FOLDER  "special://temp/skincache/"
+#define SKIN_CACHE_MAGIC   "XBSC"
+#define SKIN_CACHE_VERSION 2
+
+// node types in a cache file
+#define SKIN_CACHE_ELEMENT 'E'
+#define SKIN_CACHE_TEXT    'T'
+#define SKIN_CACHE_CDATA   'C'
+
+static void WriteUInt(std::string &out, uint32_t value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static void WriteString(std::string &out, const char *value)
+{
+  uint32_t length = strlen(value);
+  WriteUInt(out, length);
+  out.append(value, length);
+}
+
+static bool IsCachedNode(const TiXmlNode *node)
+{
+  // comments and declarations aren't needed to build a window
+  return node->Type() == TiXmlNode::TINYXML_ELEMENT || node->Type() == TiXmlNode::TINYXML_TEXT;
+}
+
+static void WriteNode(std::string &out, const TiXmlNode *node)
+{
+  if (node->Type() == TiXmlNode::TINYXML_TEXT)
+  {
+    out += node->ToText()->CDATA() ? SKIN_CACHE_CDATA : SKIN_CACHE_TEXT;
+    WriteString(out, node->Value());
+    return;
+  }
+
+  const TiXmlElement *element = node->ToElement();
+  out += SKIN_CACHE_ELEMENT;
+  WriteString(out, element->Value());
+
+  uint32_t count = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    count++;
+  WriteUInt(out, count);
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    WriteString(out, attribute->Name());
+    WriteString(out, attribute->Value());
+  }
+
+  count = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (IsCachedNode(child))
+      count++;
+  }
+  WriteUInt(out, count);
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (IsCachedNode(child))
+      WriteNode(out, child);
+  }
+}
+
+static bool ReadUInt(const char *&pos, const char *end, uint32_t &value)
+{
+  if ((size_t)(end - pos) < sizeof(value))
+    return false;
+  memcpy(&value, pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+static bool ReadString(const char *&pos, const char *end, std::string &value)
+{
+  uint32_t length;
+  if (!ReadUInt(pos, end, length) || (size_t)(end - pos) < length)
+    return false;
+  value.assign(pos, length);
+  pos += length;
+  return true;
+}
+
+static TiXmlNode *ReadNode(const char *&pos, const char *end)
+{
+  std::string value;
+  if (pos >= end)
+    return NULL;
+  char type = *pos++;
+  if (!ReadString(pos, end, value))
+    return NULL;
+
+  if (type == SKIN_CACHE_TEXT || type == SKIN_CACHE_CDATA)
+  {
+    TiXmlText *text = new TiXmlText(value.c_str());
+    text->SetCDATA(type == SKIN_CACHE_CDATA);
+    return text;
+  }
+  else if (type != SKIN_CACHE_ELEMENT)
+    return NULL;
+
+  TiXmlElement *element = new TiXmlElement(value.c_str());
+
+  uint32_t count;
+  if (!ReadUInt(pos, end, count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string name;
+    if (!ReadString(pos, end, name) || !ReadString(pos, end, value))
+    {
+      delete element;
+      return NULL;
+    }
+    element->SetAttribute(name.c_str(), value.c_str());
+  }
+
+  if (!ReadUInt(pos, end, count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    TiXmlNode *child = ReadNode(pos, end);
+    if (!child)
+    {
+      delete element;
+      return NULL;
+    }
+    element->LinkEndChild(child);
+  }
+
+  return element;
+}
+
+void CGUISkinCache::Serialize(std::string &out, const TiXmlElement *root)
+{
+  WriteNode(out, root);
+}
+
+TiXmlElement* CGUISkinCache::Deserialize(const char *data, size_t size)
+{
+  const char *pos = data;
+  const char *end = data + size;
+  TiXmlNode *root = ReadNode(pos, end);
+  if (!root || !root->ToElement() || pos != end)
+  {
+    delete root;
+    return NULL;
+  }
+  return root->ToElement();
+}
+
+TiXmlElement* CGUISkinCache::Load(const CStdString &strPath)
+{
+  CStdString strKey;
+  if (!GetKey(strPath, strKey))
+    return NULL;
+
+  CFile file;
+  if (!file.Open(GetCacheFile(strPath)))
+    return NULL;
+
+  int64_t length = file.GetLength();
+  if (length <= 0)
+    return NULL;
+  std::vector<char> buffer((size_t)length);
+  if (file.Read(&buffer[0], length) != length)
+    return NULL;
+  file.Close();
+
+  const char *pos = &buffer[0];
+  const char *end = pos + buffer.size();
+  std::string magic, key;
+  uint32_t version;
+  if (!ReadString(pos, end, magic) || magic != SKIN_CACHE_MAGIC ||
+      !ReadUInt(pos, end, version) || version != SKIN_CACHE_VERSION ||
+      !ReadString(pos, end, key) || key != strKey)
+  {
+    CLog::Log(LOGDEBUG, "%s - cached skin file for %s is outdated", __FUNCTION__, strPath.c_str());
+    return NULL;
+  }
+
+  // the include files the window was resolved with have to be unchanged too
+  std::vector<CStdString> includeFiles;
+  uint32_t count = 0;
+  bool bDamaged = !ReadUInt(pos, end, count);
+  for (uint32_t i = 0; !bDamaged && i < count; i++)
+  {
+    std::string file, stamp;
+    if (!ReadString(pos, end, file) || !ReadString(pos, end, stamp))
+    {
+      bDamaged = true;
+      break;
+    }
+
+    CStdString strStamp;
+    if (!GetFileStamp(file, strStamp) || strStamp != stamp)
+    {
+      CLog::Log(LOGDEBUG, "%s - cached skin file for %s is outdated, %s changed", __FUNCTION__, strPath.c_str(), file.c_str());
+      return NULL;
+    }
+    includeFiles.push_back(file);
+  }
+
+  TiXmlElement *root = bDamaged ? NULL : Deserialize(pos, end - pos);
+  if (!root)
+  {
+    CLog::Log(LOGWARNING, "%s - cached skin file for %s is damaged", __FUNCTION__, strPath.c_str());
+    return NULL;
+  }
+
+  // load the include files like resolving the includes of the window would have done,
+  // so windows that aren't cached find the includes in them
+  for (std::vector<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+    g_SkinInfo->LoadIncludeFile(*it);
+
+  CLog::Log(LOGDEBUG, "%s - loaded %s from the skin cache", __FUNCTION__, strPath.c_str());
+  return root;
+}
+
+bool CGUISkinCache::Save(const CStdString &strPath, const TiXmlElement *root, const std::set<CStdString> &includeFiles)
+{
+  CStdString strKey;
+  if (!root || !GetKey(strPath, strKey))
+    return false;
+
+  std::string out;
+  WriteString(out, SKIN_CACHE_MAGIC);
+  WriteUInt(out, SKIN_CACHE_VERSION);
+  WriteString(out, strKey.c_str());
+
+  WriteUInt(out, includeFiles.size());
+  for (std::set<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+  {
+    CStdString strStamp;
+    if (!GetFileStamp(*it, strStamp))
+      return false;
+    WriteString(out, it->c_str());
+    WriteString(out, strStamp.c_str());
+  }
+
+  Serialize(out, root);
+
+  if (!CDirectory::Exists(SKIN_CACHE_FOLDER))
+    CDirectory::Create(SKIN_CACHE_FOLDER);
+
+  CFile file;
+  if (!file.OpenForWrite(GetCacheFile(strPath), true) ||
+      file.Write(out.c_str(), out.size()) != (int)out.size())
+  {
+    CLog::Log(LOGERROR, "%s - unable to store %s in the skin cache", __FUNCTION__, strPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+CStdString CGUISkinCache::GetCacheFile(const CStdString &strPath)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(strPath);
+  CStdString strFile;
+  strFile.Format(SKIN_CACHE_FOLDER "%08x.bin", (unsigned int)crc);
+  return strFile;
+}
+
+bool CGUISkinCache::GetKey(const CStdString &strPath, CStdString &strKey)
+{
+  CStdString strStamp;
+  if (!g_SkinInfo || !GetFileStamp(strPath, strStamp))
+    return false;
+
+  strKey.Format("%s-%s", g_SkinInfo->GetIncludesStamp().c_str(), strStamp.c_str());
+  return true;
+}
+
+bool CGUISkinCache::GetFileStamp(const CStdString &strPath, CStdString &strStamp)
+{
+  struct __stat64 info;
+  if (CFile::Stat(strPath, &info) != 0)
+    return false;
+
+  strStamp.Format("%"PRId64"-%"PRId64, (int64_t)info.st_mtime, (int64_t)info.st_size);
+  return true;
+}
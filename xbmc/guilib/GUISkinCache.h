@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StdString.h"
+
+#include <set>
+#include <string>
+
+class TiXmlElement;
+
+/*!
+ \ingroup winman
+ \brief Cache of window xml files with their includes resolved.
+
+ The resolved xml tree of a window is stored in a binary file in special://temp/skincache/,
+ so the next time the window is loaded neither the xml has to be parsed nor the includes
+ resolved. A cached window is only used if the skin, its include files and the window
+ file itself didn't change since it was stored. The include files that were loaded while
+ resolving the includes of the window are stored with it and loaded again when it's used.
+ */
+class CGUISkinCache
+{
+public:
+  /*! \brief Load the resolved xml tree of a window from the cache and the include files it was resolved with
+   \param strPath path of the window xml file
+   \return the root element of the window, owned by the caller, or NULL if the window isn't cached or changed
+   */
+  static TiXmlElement* Load(const CStdString &strPath);
+
+  /*! \brief Store the resolved xml tree of a window in the cache
+   \param strPath path of the window xml file
+   \param root root element of the window with all includes resolved
+   \param includeFiles the include files named in <include file="..."> tags of the window
+   \return true if the window was stored, false otherwise
+   */
+  static bool Save(const CStdString &strPath, const TiXmlElement *root, const std::set<CStdString> &includeFiles);
+
+  /*! \brief Append the binary form of an xml tree to a buffer
+   \param out the buffer
+   \param root root element of the tree
+   */
+  static void Serialize(std::string &out, const TiXmlElement *root);
+
+  /*! \brief Rebuild an xml tree from its binary form
+   \param data the binary form written by Serialize()
+   \param size size of the data in bytes
+   \return the root element, owned by the caller, or NULL if the data is damaged
+   */
+  static TiXmlElement* Deserialize(const char *data, size_t size);
+
+private:
+  static CStdString GetCacheFile(const CStdString &strPath);
+  static bool GetKey(const CStdString &strPath, CStdString &strKey);
+  static bool GetFileStamp(const CStdString &strPath, CStdString &strStamp);
+};
@@ -26,6 +26,7 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "GUISkinCache.h"
 #include "settings/Settings.h"
 #ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
 #include "GUIEditControl.h"
@@ -131,25 +132,39 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
-  // load window xml if we don't have it stored yet
+  // load window xml if we don't have it stored yet. the stored xml has its includes resolved
   if (!m_windowXMLRootElement)
   {
-    CXBMCTinyXML xmlDoc;
-    if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+    m_windowXMLRootElement = CGUISkinCache::Load(strPath);
+    if (m_windowXMLRootElement)
+      m_xmlIncludeConditions.clear();
+    else
     {
-      CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
-      SetID(WINDOW_INVALID);
-      return false;
+      CXBMCTinyXML xmlDoc;
+      if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+      {
+        CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
+        SetID(WINDOW_INVALID);
+        return false;
+      }
+      m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+
+      // Resolve any includes that may be present and save conditions used to do it
+      std::set<CStdString> includeFiles;
+      g_SkinInfo->ResolveIncludes(m_windowXMLRootElement, &m_xmlIncludeConditions, &includeFiles);
+
+      // windows with conditional includes are resolved again when a condition changes, so they aren't cached
+      if (m_xmlIncludeConditions.empty())
+        CGUISkinCache::Save(strPath, m_windowXMLRootElement, includeFiles);
     }
-    m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  return Load(m_windowXMLRootElement, false);
 }
 
-bool CGUIWindow::Load(TiXmlElement* pRootElement)
+bool CGUIWindow::Load(TiXmlElement* pRootElement, bool bResolveIncludes /* = true */)
 {
   if (!pRootElement)
     return false;
@@ -165,7 +180,8 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
   // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  if (bResolveIncludes)
+    g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
   // now load in the skin file
   SetDefaults();
 
@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUISkinCache.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+static std::string Print(const TiXmlElement *root)
+{
+  TiXmlPrinter printer;
+  root->Accept(&printer);
+  return printer.CStr();
+}
+
+static const char *window =
+  "<window id=\"3000\" type=\"dialog\">"
+    "<defaultcontrol always=\"true\">10</defaultcontrol>"
+    "<controls>"
+      "<control type=\"label\" id=\"10\">"
+        "<label>$LOCALIZE[31000] &amp; more</label>"
+        "<font></font>"
+        "<textcolor>ff&lt;ffffff</textcolor>"
+      "</control>"
+      "<control type=\"image\"><texture><![CDATA[a <b> c]]></texture></control>"
+    "</controls>"
+  "</window>";
+
+TEST(TestGUISkinCache, RoundTrip)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(window);
+  ASSERT_TRUE(doc.RootElement() != NULL);
+
+  std::string data;
+  CGUISkinCache::Serialize(data, doc.RootElement());
+  ASSERT_FALSE(data.empty());
+
+  TiXmlElement *root = CGUISkinCache::Deserialize(data.c_str(), data.size());
+  ASSERT_TRUE(root != NULL);
+  EXPECT_EQ(Print(doc.RootElement()), Print(root));
+
+  TiXmlElement *texture = root->FirstChildElement("controls")->LastChild("control")->FirstChildElement("texture");
+  ASSERT_TRUE(texture && texture->FirstChild() && texture->FirstChild()->ToText());
+  EXPECT_TRUE(texture->FirstChild()->ToText()->CDATA());
+  EXPECT_STREQ("a <b> c", texture->GetText());
+  delete root;
+}
+
+TEST(TestGUISkinCache, DropsComments)
+{
+  CXBMCTinyXML doc;
+  doc.Parse("<window><!-- a comment --><controls/></window>");
+  ASSERT_TRUE(doc.RootElement() != NULL);
+
+  std::string data;
+  CGUISkinCache::Serialize(data, doc.RootElement());
+  TiXmlElement *root = CGUISkinCache::Deserialize(data.c_str(), data.size());
+  ASSERT_TRUE(root != NULL);
+
+  CXBMCTinyXML expected;
+  expected.Parse("<window><controls/></window>");
+  EXPECT_EQ(Print(expected.RootElement()), Print(root));
+  delete root;
+}
+
+TEST(TestGUISkinCache, Damaged)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(window);
+  ASSERT_TRUE(doc.RootElement() != NULL);
+
+  std::string data;
+  CGUISkinCache::Serialize(data, doc.RootElement());
+
+  /* truncated data, trailing data and a bad node type are all rejected */
+  for (size_t size = 0; size < data.size(); size += 7)
+    EXPECT_TRUE(CGUISkinCache::Deserialize(data.c_str(), size) == NULL);
+
+  std::string longer = data + "E";
+  EXPECT_TRUE(CGUISkinCache::Deserialize(longer.c_str(), longer.size()) == NULL);
+
+  std::string broken = data;
+  broken[0] = 'X';
+  EXPECT_TRUE(CGUISkinCache::Deserialize(broken.c_str(), broken.size()) == NULL);
+}
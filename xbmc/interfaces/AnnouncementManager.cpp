@@ -30,12 +30,29 @@
 #include "video/VideoDatabase.h"
 
 #define LOOKUP_PROPERTY "database-lookup"
+#define ANNOUNCEMENT_QUEUE_MAX 1000
 
 using namespace std;
 using namespace ANNOUNCEMENT;
 
 #define m_announcers XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_announcers
 #define m_critSection XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_critSection
+#define m_queueSection XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_queueSection
+#define m_queue XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_queue
+#define m_queueEvent XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_queueEvent
+#define m_dispatcher XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_dispatcher
+#define m_bSynchronous XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_bSynchronous
+#define m_iDropped XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_iDropped
+#define m_iCoalesced XBMC_GLOBAL_USE(ANNOUNCEMENT::CAnnouncementManager::Globals).m_iCoalesced
+
+void CAnnouncementDispatcher::Process()
+{
+  while (!m_bStop)
+  {
+    if (!CAnnouncementManager::ProcessQueue())
+      AbortableWait(m_queueEvent);
+  }
+}
 
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
 {
@@ -71,9 +88,7 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
-    m_announcers[i]->Announce(flag, sender, message, data);
+  Queue(flag, sender, message, data);
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -197,3 +212,94 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 
   Announce(flag, sender, message, object);
 }
+
+void CAnnouncementManager::Deinitialize()
+{
+  {
+    CSingleLock lock (m_queueSection);
+    m_bSynchronous = true;
+  }
+
+  m_dispatcher.StopThread();
+
+  // deliver whatever was still pending on the calling thread
+  while (ProcessQueue());
+
+  CLog::Log(LOGDEBUG, "CAnnouncementManager - dispatcher stopped (%u announcements coalesced, %u dropped)",
+            m_iCoalesced, m_iDropped);
+}
+
+void CAnnouncementManager::Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  AnnouncementQueueItem announcement;
+  announcement.flag = flag;
+  announcement.sender = sender;
+  announcement.message = message;
+  announcement.data = data;
+
+  CSingleLock lock (m_queueSection);
+  if (m_bSynchronous)
+  {
+    lock.Leave();
+    Dispatch(announcement);
+    return;
+  }
+
+  // merge the announcement into an identical one that is still waiting to be
+  // delivered (e.g. repeated OnUpdate notifications during a library scan).
+  // only the newest queued entry of the same message is compared, an older one
+  // was overtaken by different data. a different message from the same sender
+  // is an ordering barrier so state changes like OnPlay/OnPause/OnPlay are
+  // never reordered.
+  for (deque<AnnouncementQueueItem>::reverse_iterator it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+  {
+    if (it->flag != flag || it->sender != announcement.sender)
+      continue;
+    if (it->message == announcement.message && it->data == data)
+    {
+      it->data = data;
+      m_iCoalesced++;
+      return;
+    }
+    break;
+  }
+
+  if (m_queue.size() >= ANNOUNCEMENT_QUEUE_MAX)
+  {
+    // the announcers can't keep up, sacrifice the oldest announcement
+    // rather than growing without bound or blocking the caller
+    if (m_iDropped++ % 100 == 0)
+      CLog::Log(LOGWARNING, "CAnnouncementManager - queue full, dropping %s from %s (%u dropped so far)",
+                m_queue.front().message.c_str(), m_queue.front().sender.c_str(), m_iDropped);
+    m_queue.pop_front();
+  }
+
+  m_queue.push_back(announcement);
+
+  if (!m_dispatcher.IsRunning())
+    m_dispatcher.Create();
+  m_queueEvent.Set();
+}
+
+bool CAnnouncementManager::ProcessQueue()
+{
+  AnnouncementQueueItem announcement;
+  {
+    CSingleLock lock (m_queueSection);
+    if (m_queue.empty())
+      return false;
+
+    announcement = m_queue.front();
+    m_queue.pop_front();
+  }
+
+  Dispatch(announcement);
+  return true;
+}
+
+void CAnnouncementManager::Dispatch(const AnnouncementQueueItem &announcement)
+{
+  CSingleLock lock (m_critSection);
+  for (unsigned int i = 0; i < m_announcers.size(); i++)
+    m_announcers[i]->Announce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+}
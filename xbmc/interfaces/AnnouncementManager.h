@@ -22,11 +22,40 @@
 #include "IAnnouncer.h"
 #include "FileItem.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/Variant.h"
+#include <deque>
+#include <string>
 #include <vector>
 
 namespace ANNOUNCEMENT
 {
+  /*!
+   \brief A queued announcement waiting to be dispatched to the announcers.
+   */
+  typedef struct
+  {
+    AnnouncementFlag flag;
+    std::string sender;
+    std::string message;
+    CVariant data;
+  } AnnouncementQueueItem;
+
+  /*!
+   \brief Worker thread that delivers queued announcements to all registered
+   announcers, so the thread raising an announcement never waits for them.
+   */
+  class CAnnouncementDispatcher : public CThread
+  {
+  public:
+    CAnnouncementDispatcher() : CThread("Announcement dispatcher") {}
+
+  protected:
+    virtual void Process();
+  };
+
   class CAnnouncementManager
   {
   public:
@@ -34,8 +63,19 @@ namespace ANNOUNCEMENT
      class Globals
      {
      public:
+       Globals() : m_bSynchronous(false), m_iDropped(0), m_iCoalesced(0) {}
+       ~Globals() { m_dispatcher.StopThread(); }
+
        CCriticalSection m_critSection;
        std::vector<IAnnouncer *> m_announcers;
+
+       CCriticalSection m_queueSection;
+       std::deque<AnnouncementQueueItem> m_queue;
+       CEvent m_queueEvent;
+       CAnnouncementDispatcher m_dispatcher;
+       bool m_bSynchronous;
+       unsigned int m_iDropped;
+       unsigned int m_iCoalesced;
      };
 
     static void AddAnnouncer(IAnnouncer *listener);
@@ -44,7 +84,20 @@ namespace ANNOUNCEMENT
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+    /*!
+     \brief Deliver all pending announcements and stop the dispatcher thread.
+     Announcements raised afterwards are delivered synchronously on the
+     calling thread.
+     */
+    static void Deinitialize();
+
   private:
+    friend class CAnnouncementDispatcher;
+
+    static void Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    static bool ProcessQueue();
+    static void Dispatch(const AnnouncementQueueItem &announcement);
   };
 }
 
@@ -1367,6 +1367,29 @@ JSONRPC_STATUS CPlayerOperations::GetPropertyValue(PlayerType player, const CStd
         break;
     }
   }
+  else if (property.Equals("starttimes"))
+  {
+    CPlayerStartTimes times;
+    switch (player)
+    {
+      case Video:
+      case Audio:
+        if (g_application.m_pPlayer)
+          g_application.m_pPlayer->GetStartTimes(times);
+        break;
+
+      case Picture:
+      default:
+        break;
+    }
+
+    result = CVariant(CVariant::VariantTypeObject);
+    result["inputopen"] = times.inputopen;
+    result["probe"] = times.probe;
+    result["streaminfo"] = times.streaminfo;
+    result["firstpacket"] = times.firstpacket;
+    result["faststart"] = times.faststart;
+  }
   else
     return InvalidParams;
 
@@ -22,7 +22,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://www.xbmc.org/jsonrpc/ServiceDescription.json";
-  const int         JSONRPC_SERVICE_VERSION     = 5;
+  const int         JSONRPC_SERVICE_VERSION     = 6;
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -195,13 +195,23 @@ namespace JSONRPC
         "\"language\": { \"type\": \"string\", \"required\": true }"
       "}"
     "}",
+    "\"Player.StartTimes\": {"
+      "\"type\": \"object\","
+      "\"properties\": {"
+        "\"inputopen\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true },"
+        "\"probe\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true },"
+        "\"streaminfo\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true },"
+        "\"firstpacket\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true },"
+        "\"faststart\": { \"type\": \"boolean\", \"required\": true }"
+      "}"
+    "}",
     "\"Player.Property.Name\": {"
       "\"type\": \"string\","
       "\"enum\": [ \"type\", \"partymode\", \"speed\", \"time\", \"percentage\","
                 "\"totaltime\", \"playlistid\", \"position\", \"repeat\", \"shuffled\","
                 "\"canseek\", \"canchangespeed\", \"canmove\", \"canzoom\", \"canrotate\","
                 "\"canshuffle\", \"canrepeat\", \"currentaudiostream\", \"audiostreams\","
-                "\"subtitleenabled\", \"currentsubtitle\", \"subtitles\" ]"
+                "\"subtitleenabled\", \"currentsubtitle\", \"subtitles\", \"starttimes\" ]"
     "}",
     "\"Player.Property.Value\": {"
       "\"type\": \"object\","
@@ -227,7 +237,8 @@ namespace JSONRPC
         "\"audiostreams\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Audio.Stream\" } },"
         "\"subtitleenabled\": { \"type\": \"boolean\" },"
         "\"currentsubtitle\": { \"$ref\": \"Player.Subtitle\" },"
-        "\"subtitles\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Subtitle\" } }"
+        "\"subtitles\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Subtitle\" } },"
+        "\"starttimes\": { \"$ref\": \"Player.StartTimes\" }"
       "}"
     "}",
     "\"Notifications.Item.Type\": {"
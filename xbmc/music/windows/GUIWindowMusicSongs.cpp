@@ -473,6 +473,9 @@ bool CGUIWindowMusicSongs::Update(const CStdString &strDirectory)
   if (m_vecItems->GetContent().IsEmpty())
     m_vecItems->SetContent("files");
   m_thumbLoader.Load(*m_vecItems);
+  int first, last;
+  if (m_viewControl.GetVisibleItems(first, last))
+    m_thumbLoader.Prioritize(*m_vecItems, first, last);
 
   return true;
 }
@@ -24,6 +24,14 @@
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <algorithm>
+#include <errno.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+#ifdef HAS_TCPSERVER_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -55,6 +63,33 @@ using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
 #define RECEIVEBUFFER 1024
+#define SENDBUFFER_MAX (8 * 1024 * 1024)
+#define EPOLL_MAXEVENTS 64
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static bool WouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+static void SetNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+  unsigned long nonblocking = 1;
+  ioctlsocket(socket, FIONBIO, &nonblocking);
+#else
+  fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+#endif
+}
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -90,18 +125,36 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+#ifdef HAS_TCPSERVER_EPOLL
+  m_epollfd = -1;
+#endif
+  m_droppedClients = 0;
 }
 
 void CTCPServer::Process()
 {
   m_bStop = false;
 
+#ifdef HAS_TCPSERVER_EPOLL
+  if (m_epollfd >= 0)
+    ProcessEpoll();
+#endif
+
+  // without epoll, or when epoll stopped working
+  ProcessSelect();
+
+  Deinitialize();
+}
+
+void CTCPServer::ProcessSelect()
+{
   while (!m_bStop)
   {
     SOCKET          max_fd = 0;
-    fd_set          rfds;
+    fd_set          rfds, wfds;
     struct timeval  to     = {1, 0};
     FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
 
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
@@ -113,11 +166,13 @@ void CTCPServer::Process()
     for (unsigned int i = 0; i < m_connections.size(); i++)
     {
       FD_SET(m_connections[i]->m_socket, &rfds);
+      if (m_connections[i]->GetQueuedBytes() > 0)
+        FD_SET(m_connections[i]->m_socket, &wfds);
       if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
         max_fd = m_connections[i]->m_socket;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
@@ -129,71 +184,217 @@ void CTCPServer::Process()
       for (int i = m_connections.size() - 1; i >= 0; i--)
       {
         int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
+        if (FD_ISSET(socket, &wfds))
+          m_connections[i]->Flush();
+        if (FD_ISSET(socket, &rfds) && !ReceiveFrom(i))
+          CloseConnection(i);
       }
 
       for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
       {
         if (FD_ISSET(*it, &rfds))
+          AcceptConnections(*it);
+      }
+    }
+
+    CloseDroppedConnections();
+  }
+}
+
+#ifdef HAS_TCPSERVER_EPOLL
+void CTCPServer::ProcessEpoll()
+{
+  struct epoll_event events[EPOLL_MAXEVENTS];
+
+  while (!m_bStop)
+  {
+    int res = epoll_wait(m_epollfd, events, EPOLL_MAXEVENTS, 1000);
+    if (res < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      // only the epoll instance is rebuilt, the sockets and connections are fine
+      CLog::Log(LOGERROR, "JSONRPC Server: epoll_wait failed (%d)", errno);
+      Sleep(1000);
+      if (!InitializeEpoll())
+      {
+        CLog::Log(LOGWARNING, "JSONRPC Server: Unable to recreate epoll (%d), falling back to select", errno);
+        return;
+      }
+      continue;
+    }
+
+    for (int e = 0; e < res; e++)
+    {
+      CTCPClient *client = (CTCPClient*)events[e].data.ptr;
+      if (client == NULL)
+      {
+        // server sockets are registered without a client, they're few enough
+        // to simply try them all
+        for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+          AcceptConnections(*it);
+        continue;
+      }
+
+      std::vector<CTCPClient*>::iterator it = std::find(m_connections.begin(), m_connections.end(), client);
+      if (it == m_connections.end())
+        continue;
+      unsigned int index = it - m_connections.begin();
+
+      bool close = (events[e].events & (EPOLLERR | EPOLLHUP)) != 0;
+      if (!close && (events[e].events & EPOLLOUT))
+        client->Flush();
+      if (!close && (events[e].events & EPOLLIN))
+        close = !ReceiveFrom(index);
+
+      if (close)
+        CloseConnection(index);
+    }
+
+    CloseDroppedConnections();
+  }
+}
+#endif
+
+void CTCPServer::AcceptConnections(SOCKET server)
+{
+  while (true)
+  {
+    CTCPClient *newconnection = new CTCPClient();
+    newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+    if (newconnection->m_socket == INVALID_SOCKET)
+    {
+      if (!WouldBlock())
+        CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
+      delete newconnection;
+      return;
+    }
+
+    SetNonBlocking(newconnection->m_socket);
+
+#ifdef HAS_TCPSERVER_EPOLL
+    if (m_epollfd >= 0)
+    {
+      struct epoll_event event = {};
+      event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+      event.data.ptr = newconnection;
+      if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, newconnection->m_socket, &event) < 0)
+      {
+        CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection (%d)", errno);
+        newconnection->Disconnect();
+        delete newconnection;
+        continue;
+      }
+    }
+#endif
+
+    CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+    {
+      CSingleLock lock (m_connectionsSection);
+      m_connections.push_back(newconnection);
+    }
+    LogStats();
+  }
+}
+
+bool CTCPServer::ReceiveFrom(unsigned int index)
+{
+  // the sockets are non-blocking and, with epoll, edge triggered so keep
+  // reading until the kernel has nothing left for us
+  while (true)
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = recv(m_connections[index]->m_socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread < 0 && WouldBlock())
+      return true;
+    if (nread <= 0)
+      return false;
+
+    std::string response;
+    if (m_connections[index]->IsNew())
+    {
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+      if (response.size() > 0)
+        m_connections[index]->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
+      {
+        // Replace the CTCPClient with a CWebSocketClient
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[index]));
+#ifdef HAS_TCPSERVER_EPOLL
+        if (m_epollfd >= 0)
         {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
+          struct epoll_event event = {};
+          event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+          event.data.ptr = websocketClient;
+          epoll_ctl(m_epollfd, EPOLL_CTL_MOD, websocketClient->m_socket, &event);
         }
+#endif
+        CSingleLock lock (m_connectionsSection);
+        delete m_connections[index];
+        m_connections[index] = websocketClient;
       }
     }
+
+    if (response.size() <= 0)
+      m_connections[index]->PushBuffer(this, buffer, nread);
+
+    if (m_connections[index]->Closing())
+      return false;
   }
+}
 
-  Deinitialize();
+void CTCPServer::CloseConnection(unsigned int index)
+{
+  CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+
+  CTCPClient *client = m_connections[index];
+#ifdef HAS_TCPSERVER_EPOLL
+  if (m_epollfd >= 0 && client->m_socket != INVALID_SOCKET)
+    epoll_ctl(m_epollfd, EPOLL_CTL_DEL, client->m_socket, NULL);
+#endif
+  client->Disconnect();
+
+  {
+    CSingleLock lock (m_connectionsSection);
+    m_connections.erase(m_connections.begin() + index);
+    delete client;
+  }
+  LogStats();
+}
+
+void CTCPServer::CloseDroppedConnections()
+{
+  for (int i = m_connections.size() - 1; i >= 0; i--)
+  {
+    if (m_connections[i]->IsDropped())
+    {
+      m_droppedClients++;
+      CLog::Log(LOGWARNING, "JSONRPC Server: Dropping client that stopped reading (%u clients dropped so far)", m_droppedClients);
+      CloseConnection(i);
+    }
+  }
+}
+
+void CTCPServer::GetStats(TCPServerStats &stats)
+{
+  CSingleLock lock (m_connectionsSection);
+  stats.clients = m_connections.size();
+  stats.queuedBytes = 0;
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+    stats.queuedBytes += m_connections[i]->GetQueuedBytes();
+  stats.droppedClients = m_droppedClients;
+}
+
+void CTCPServer::LogStats()
+{
+  TCPServerStats stats;
+  GetStats(stats);
+  CLog::Log(LOGDEBUG, "JSONRPC Server: %u clients connected, %"PRIu64" bytes queued, %u clients dropped",
+            stats.clients, stats.queuedBytes, stats.droppedClients);
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -215,6 +416,7 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
+  CSingleLock connectionsLock (m_connectionsSection);
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
     {
@@ -238,6 +440,14 @@ bool CTCPServer::Initialize()
 
   if(started)
   {
+    for (unsigned int i = 0; i < m_servers.size(); i++)
+      SetNonBlocking(m_servers[i]);
+
+#ifdef HAS_TCPSERVER_EPOLL
+    if (!InitializeEpoll())
+      CLog::Log(LOGWARNING, "JSONRPC Server: epoll unavailable (%d), falling back to select", errno);
+#endif
+
     CAnnouncementManager::AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -245,6 +455,46 @@ bool CTCPServer::Initialize()
   return false;
 }
 
+#ifdef HAS_TCPSERVER_EPOLL
+bool CTCPServer::InitializeEpoll()
+{
+  if (m_epollfd >= 0)
+    close(m_epollfd);
+
+  m_epollfd = epoll_create(16);
+  if (m_epollfd < 0)
+    return false;
+
+  for (unsigned int i = 0; i < m_servers.size(); i++)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_servers[i], &event) < 0)
+    {
+      close(m_epollfd);
+      m_epollfd = -1;
+      return false;
+    }
+  }
+
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.ptr = m_connections[i];
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_connections[i]->m_socket, &event) < 0)
+    {
+      close(m_epollfd);
+      m_epollfd = -1;
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif
+
 bool CTCPServer::InitializeBlue()
 {
   if(!m_nonlocal)
@@ -467,19 +717,28 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock (m_connectionsSection);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+    {
+      m_connections[i]->Disconnect();
+      delete m_connections[i];
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+#ifdef HAS_TCPSERVER_EPOLL
+  if (m_epollfd >= 0)
+    close(m_epollfd);
+  m_epollfd = -1;
+#endif
+
 #ifdef HAVE_LIBBLUETOOTH
   if(m_sdpd)
     sdp_close( (sdp_session_t*)m_sdpd );
@@ -498,6 +757,8 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_sendOffset = 0;
+  m_dropped = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -531,12 +792,64 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_dropped || m_socket == INVALID_SOCKET)
+    return;
+
+  // a client that lets this much output pile up isn't reading anymore,
+  // give up on it instead of buffering without bound
+  if (m_sendBuffer.size() - m_sendOffset > SENDBUFFER_MAX)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
-  } while (sent < size);
+    m_dropped = true;
+    m_sendBuffer.clear();
+    m_sendOffset = 0;
+    return;
+  }
+
+  m_sendBuffer.append(data, size);
+  Flush();
+}
+
+void CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  while (m_sendOffset < m_sendBuffer.size() && m_socket != INVALID_SOCKET)
+  {
+    int sent = send(m_socket, m_sendBuffer.c_str() + m_sendOffset, m_sendBuffer.size() - m_sendOffset, SEND_FLAGS);
+    if (sent > 0)
+      m_sendOffset += sent;
+    else if (sent < 0 && WouldBlock())
+    {
+      // drop what was sent once it's at least half the buffer, so a client
+      // that keeps up with a steady stream doesn't grow it without bound
+      if (m_sendOffset >= m_sendBuffer.size() / 2)
+      {
+        m_sendBuffer.erase(0, m_sendOffset);
+        m_sendOffset = 0;
+      }
+      return; // the server thread picks up again once the socket is writable
+    }
+    else
+    {
+      m_dropped = true;
+      break;
+    }
+  }
+
+  m_sendBuffer.clear();
+  m_sendOffset = 0;
+}
+
+unsigned int CTCPServer::CTCPClient::GetQueuedBytes()
+{
+  CSingleLock lock (m_critSection);
+  return m_sendBuffer.size() - m_sendOffset;
+}
+
+bool CTCPServer::CTCPClient::IsDropped()
+{
+  CSingleLock lock (m_critSection);
+  return m_dropped;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -581,6 +894,7 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+    Flush();
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -599,6 +913,9 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendBuffer        = client.m_sendBuffer;
+  m_sendOffset        = client.m_sendOffset;
+  m_dropped           = client.m_dropped;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -29,8 +29,19 @@
 #include "threads/Thread.h"
 #include "websocket/WebSocket.h"
 
+#if defined(TARGET_LINUX)
+#define HAS_TCPSERVER_EPOLL
+#endif
+
 namespace JSONRPC
 {
+  typedef struct
+  {
+    unsigned int clients;
+    uint64_t     queuedBytes;
+    unsigned int droppedClients;
+  } TCPServerStats;
+
   class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread
   {
   public:
@@ -49,8 +60,22 @@ namespace JSONRPC
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
+#ifdef HAS_TCPSERVER_EPOLL
+    bool InitializeEpoll();
+#endif
     void Deinitialize();
 
+    void ProcessSelect();
+#ifdef HAS_TCPSERVER_EPOLL
+    void ProcessEpoll();
+#endif
+    void AcceptConnections(SOCKET server);
+    bool ReceiveFrom(unsigned int index);
+    void CloseConnection(unsigned int index);
+    void CloseDroppedConnections();
+    void GetStats(TCPServerStats &stats);
+    void LogStats();
+
     class CTCPClient : public IClient
     {
     public:
@@ -72,6 +97,14 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Write as much of the queued output as the socket accepts
+       without blocking.
+       */
+      void Flush();
+      unsigned int GetQueuedBytes();
+      bool IsDropped();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -85,6 +118,9 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
+      unsigned int m_sendOffset;
+      bool m_dropped;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -108,7 +144,12 @@ namespace JSONRPC
     };
 
     std::vector<CTCPClient*> m_connections;
+    CCriticalSection m_connectionsSection;
     std::vector<SOCKET> m_servers;
+#ifdef HAS_TCPSERVER_EPOLL
+    int m_epollfd;
+#endif
+    unsigned int m_droppedClients;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
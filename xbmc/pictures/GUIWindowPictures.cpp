@@ -266,7 +266,12 @@ bool CGUIWindowPictures::Update(const CStdString &strDirectory)
 
   m_vecItems->SetThumbnailImage("");
   if (g_guiSettings.GetBool("pictures.generatethumbs"))
+  {
     m_thumbLoader.Load(*m_vecItems);
+    int first, last;
+    if (m_viewControl.GetVisibleItems(first, last))
+      m_thumbLoader.Prioritize(*m_vecItems, first, last);
+  }
   m_vecItems->SetThumbnailImage(CPictureThumbLoader::GetCachedImage(*m_vecItems, "thumb"));
 
   return true;
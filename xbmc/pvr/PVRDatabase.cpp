@@ -375,6 +375,7 @@ int CPVRDatabase::Get(CPVRChannelGroupInternal &results)
 #endif
         PVRChannelGroupMember newMember = { channel, m_pDS->fv("iChannelNumber").get_asInt() };
         results.m_members.push_back(newMember);
+        results.InvalidateMemberIndex();
 
         m_pDS->next();
         ++iReturn;
@@ -719,6 +720,7 @@ int CPVRDatabase::Get(CPVRChannelGroup &group)
 #endif
           PVRChannelGroupMember newMember = { channel, iChannelNumber };
           group.m_members.push_back(newMember);
+          group.InvalidateMemberIndex();
           iReturn++;
         }
         else
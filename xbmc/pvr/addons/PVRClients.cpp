@@ -436,7 +436,7 @@ PVR_ERROR CPVRClients::RenameTimer(const CPVRTimerInfoTag &timer, const CStdStri
   return error;
 }
 
-PVR_ERROR CPVRClients::GetRecordings(CPVRRecordings *recordings)
+PVR_ERROR CPVRClients::GetRecordings(CPVRRecordings *recordings, std::set<int> &failedClients)
 {
   PVR_ERROR error(PVR_ERROR_NO_ERROR);
   PVR_CLIENTMAP clients;
@@ -450,6 +450,7 @@ PVR_ERROR CPVRClients::GetRecordings(CPVRRecordings *recordings)
     {
       CLog::Log(LOGERROR, "PVR - %s - cannot get recordings from client '%d': %s",__FUNCTION__, (*itrClients).first, CPVRClient::ToString(currentError));
       error = currentError;
+      failedClients.insert((*itrClients).first);
     }
   }
 
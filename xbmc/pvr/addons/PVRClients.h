@@ -27,6 +27,7 @@
 #include "pvr/recordings/PVRRecording.h"
 #include "addons/AddonDatabase.h"
 
+#include <set>
 #include <vector>
 #include <deque>
 
@@ -359,9 +360,10 @@ namespace PVR
     /*!
      * @brief Get all recordings from clients
      * @param recordings Store the recordings in this container.
-     * @return The amount of recordings that were added.
+     * @param failedClients The clients that failed to return their recordings.
+     * @return PVR_ERROR_NO_ERROR if all clients returned their recordings, the last error otherwise.
      */
-    PVR_ERROR GetRecordings(CPVRRecordings *recordings);
+    PVR_ERROR GetRecordings(CPVRRecordings *recordings, std::set<int> &failedClients);
 
     /*!
      * @brief Rename a recordings on the backend.
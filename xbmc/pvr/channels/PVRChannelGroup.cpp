@@ -47,7 +47,8 @@ CPVRChannelGroup::CPVRChannelGroup(void) :
     m_iGroupId(-1),
     m_bLoaded(false),
     m_bChanged(false),
-    m_bUsingBackendChannelOrder(false)
+    m_bUsingBackendChannelOrder(false),
+    m_bMemberIndexValid(false)
 {
 }
 
@@ -58,7 +59,8 @@ CPVRChannelGroup::CPVRChannelGroup(bool bRadio, unsigned int iGroupId, const CSt
     m_strGroupName(strGroupName),
     m_bLoaded(false),
     m_bChanged(false),
-    m_bUsingBackendChannelOrder(false)
+    m_bUsingBackendChannelOrder(false),
+    m_bMemberIndexValid(false)
 {
 }
 
@@ -69,7 +71,8 @@ CPVRChannelGroup::CPVRChannelGroup(const PVR_CHANNEL_GROUP &group) :
     m_strGroupName(group.strGroupName),
     m_bLoaded(false),
     m_bChanged(false),
-    m_bUsingBackendChannelOrder(false)
+    m_bUsingBackendChannelOrder(false),
+    m_bMemberIndexValid(false)
 {
 }
 
@@ -101,6 +104,7 @@ CPVRChannelGroup::CPVRChannelGroup(const CPVRChannelGroup &group)
   m_bChanged                    = group.m_bChanged;
   m_bUsingBackendChannelOrder   = group.m_bUsingBackendChannelOrder;
   m_bUsingBackendChannelNumbers = group.m_bUsingBackendChannelNumbers;
+  m_bMemberIndexValid           = false;
 
   for (int iPtr = 0; iPtr < group.Size(); iPtr++)
     m_members.push_back(group.m_members.at(iPtr));
@@ -139,6 +143,7 @@ void CPVRChannelGroup::Unload(void)
   CSingleLock lock(m_critSection);
   g_guiSettings.UnregisterObserver(this);
   m_members.clear();
+  InvalidateMemberIndex();
 }
 
 bool CPVRChannelGroup::Update(void)
@@ -167,6 +172,7 @@ bool CPVRChannelGroup::SetChannelNumber(const CPVRChannel &channel, unsigned int
         m_bChanged = true;
         bReturn = true;
         m_members.at(iChannelPtr).iChannelNumber = iChannelNumber;
+        InvalidateMemberIndex();
       }
       break;
     }
@@ -198,6 +204,7 @@ bool CPVRChannelGroup::MoveChannel(unsigned int iOldChannelNumber, unsigned int
   PVRChannelGroupMember entry = m_members.at(iOldChannelNumber - 1);
   m_members.erase(m_members.begin() + iOldChannelNumber - 1);
   m_members.insert(m_members.begin() + iNewChannelNumber - 1, entry);
+  InvalidateMemberIndex();
 
   /* renumber the list */
   Renumber();
@@ -283,28 +290,116 @@ void CPVRChannelGroup::SortByClientChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   sort(m_members.begin(), m_members.end(), sortByClientChannelNumber());
+  InvalidateMemberIndex();
 }
 
 void CPVRChannelGroup::SortByChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   sort(m_members.begin(), m_members.end(), sortByChannelNumber());
+  InvalidateMemberIndex();
 }
 
 /********** getters **********/
 
-CPVRChannelPtr CPVRChannelGroup::GetByClient(int iUniqueChannelId, int iClientID) const
+void CPVRChannelGroup::InvalidateMemberIndex(void)
 {
   CSingleLock lock(m_critSection);
+  m_bMemberIndexValid = false;
+}
 
-  for (unsigned int ptr = 0; ptr < m_members.size(); ptr++)
+void CPVRChannelGroup::UpdateMemberIndex(void) const
+{
+  CSingleLock lock(m_critSection);
+  if (m_bMemberIndexValid)
+    return;
+
+  m_membersByClient.clear();
+  m_membersById.clear();
+  m_membersByNumber.clear();
+
+  /* insert() keeps the first entry for a key, like the linear lookups did */
+  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
   {
-    PVRChannelGroupMember groupMember = m_members.at(ptr);
-    if (groupMember.channel->UniqueID() == iUniqueChannelId &&
-        groupMember.channel->ClientID() == iClientID)
-      return groupMember.channel;
+    const PVRChannelGroupMember &member = m_members.at(iChannelPtr);
+    if (!member.channel)
+      continue;
+
+    m_membersByClient.insert(std::make_pair(PVRChannelClientKey(member.channel->ClientID(), member.channel->UniqueID()), iChannelPtr));
+    if (member.channel->ChannelID() > 0)
+      m_membersById.insert(std::make_pair(member.channel->ChannelID(), iChannelPtr));
+    if (member.iChannelNumber > 0)
+      m_membersByNumber.insert(std::make_pair(member.iChannelNumber, iChannelPtr));
   }
 
+  m_bMemberIndexValid = true;
+}
+
+int CPVRChannelGroup::GetMemberIndexByClient(int iUniqueChannelId, int iClientID) const
+{
+  CSingleLock lock(m_critSection);
+  UpdateMemberIndex();
+
+  std::map<PVRChannelClientKey, unsigned int>::const_iterator it = m_membersByClient.find(PVRChannelClientKey(iClientID, iUniqueChannelId));
+  if (it == m_membersByClient.end())
+    return -1;
+
+  /* client and unique IDs don't change once a channel was added */
+  return (int) it->second;
+}
+
+int CPVRChannelGroup::GetMemberIndexByChannelID(int iChannelID) const
+{
+  CSingleLock lock(m_critSection);
+  UpdateMemberIndex();
+
+  std::map<int, unsigned int>::const_iterator it = m_membersById.find(iChannelID);
+  if (it != m_membersById.end() && it->second < m_members.size() &&
+      m_members.at(it->second).channel && m_members.at(it->second).channel->ChannelID() == iChannelID)
+    return (int) it->second;
+
+  /* new channels only get an ID when they are persisted, which doesn't touch m_members */
+  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
+  {
+    if (m_members.at(iChannelPtr).channel && m_members.at(iChannelPtr).channel->ChannelID() == iChannelID)
+    {
+      m_bMemberIndexValid = false;
+      return (int) iChannelPtr;
+    }
+  }
+
+  return -1;
+}
+
+int CPVRChannelGroup::GetMemberIndexByChannelNumber(unsigned int iChannelNumber) const
+{
+  CSingleLock lock(m_critSection);
+  UpdateMemberIndex();
+
+  /* hidden channels don't have a number and aren't indexed */
+  if (iChannelNumber == 0)
+  {
+    for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
+      if (m_members.at(iChannelPtr).iChannelNumber == 0)
+        return (int) iChannelPtr;
+    return -1;
+  }
+
+  std::map<unsigned int, unsigned int>::const_iterator it = m_membersByNumber.find(iChannelNumber);
+  if (it == m_membersByNumber.end())
+    return -1;
+
+  return (int) it->second;
+}
+
+CPVRChannelPtr CPVRChannelGroup::GetByClient(int iUniqueChannelId, int iClientID) const
+{
+  CSingleLock lock(m_critSection);
+
+  int iIndex = GetMemberIndexByClient(iUniqueChannelId, iClientID);
+  if (iIndex >= 0)
+    return m_members.at(iIndex).channel;
+
   CPVRChannelPtr empty;
   return empty;
 }
@@ -313,12 +408,9 @@ CPVRChannelPtr CPVRChannelGroup::GetByChannelID(int iChannelID) const
 {
   CSingleLock lock(m_critSection);
 
-  for (unsigned int ptr = 0; ptr < m_members.size(); ptr++)
-  {
-    PVRChannelGroupMember groupMember = m_members.at(ptr);
-    if (groupMember.channel->ChannelID() == iChannelID)
-      return groupMember.channel;
-  }
+  int iIndex = GetMemberIndexByChannelID(iChannelID);
+  if (iIndex >= 0)
+    return m_members.at(iIndex).channel;
 
   CPVRChannelPtr empty;
   return empty;
@@ -400,17 +492,10 @@ unsigned int CPVRChannelGroup::GetChannelNumber(const CPVRChannel &channel) cons
 {
   unsigned int iReturn = 0;
   CSingleLock lock(m_critSection);
-  unsigned int iSize = m_members.size();
 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < iSize; iChannelPtr++)
-  {
-    PVRChannelGroupMember member = m_members.at(iChannelPtr);
-    if (member.channel->ChannelID() == channel.ChannelID())
-    {
-      iReturn = member.iChannelNumber;
-      break;
-    }
-  }
+  int iIndex = GetMemberIndexByChannelID(channel.ChannelID());
+  if (iIndex >= 0)
+    iReturn = m_members.at(iIndex).iChannelNumber;
 
   return iReturn;
 }
@@ -419,14 +504,11 @@ CFileItemPtr CPVRChannelGroup::GetByChannelNumber(unsigned int iChannelNumber) c
 {
   CSingleLock lock(m_critSection);
 
-  for (unsigned int ptr = 0; ptr < m_members.size(); ptr++)
+  int iIndex = GetMemberIndexByChannelNumber(iChannelNumber);
+  if (iIndex >= 0)
   {
-    PVRChannelGroupMember groupMember = m_members.at(ptr);
-    if (groupMember.iChannelNumber == iChannelNumber)
-    {
-      CFileItemPtr retVal = CFileItemPtr(new CFileItem(*groupMember.channel));
-      return retVal;
-    }
+    CFileItemPtr retVal = CFileItemPtr(new CFileItem(*m_members.at(iIndex).channel));
+    return retVal;
   }
 
   CFileItemPtr retVal = CFileItemPtr(new CFileItem);
@@ -481,17 +563,11 @@ CFileItemPtr CPVRChannelGroup::GetByIndex(unsigned int iIndex) const
 
 int CPVRChannelGroup::GetIndex(const CPVRChannel &channel) const
 {
-  int iIndex(-1);
   CSingleLock lock(m_critSection);
 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
-  {
-    if (*m_members.at(iChannelPtr).channel == channel)
-    {
-      iIndex = iChannelPtr;
-      break;
-    }
-  }
+  int iIndex = GetMemberIndexByClient(channel.UniqueID(), channel.ClientID());
+  if (iIndex >= 0 && *m_members.at(iIndex).channel != channel)
+    iIndex = -1;
 
   return iIndex;
 }
@@ -518,6 +594,21 @@ int CPVRChannelGroup::GetMembers(CFileItemList &results, bool bGroupMembers /* =
   return results.Size() - iOrigSize;
 }
 
+int CPVRChannelGroup::GetChannels(std::vector<CPVRChannelPtr> &channels) const
+{
+  int iOrigSize = channels.size();
+  CSingleLock lock(m_critSection);
+
+  channels.reserve(channels.size() + m_members.size());
+  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
+  {
+    if (m_members.at(iChannelPtr).channel)
+      channels.push_back(m_members.at(iChannelPtr).channel);
+  }
+
+  return channels.size() - iOrigSize;
+}
+
 CPVRChannelGroupPtr CPVRChannelGroup::GetNextGroup(void) const
 {
   return g_PVRChannelGroups->Get(m_bRadio)->GetNextGroup(*this);
@@ -591,31 +682,46 @@ bool CPVRChannelGroup::RemoveDeletedChannels(const CPVRChannelGroup &channels)
   bool bReturn(false);
   CSingleLock lock(m_critSection);
 
-  /* check for deleted channels */
-  for (int iChannelPtr = m_members.size() - 1; iChannelPtr >= 0; iChannelPtr--)
+  /* check for deleted channels. the members that are kept are moved to the front,
+     so the list only has to be resized once instead of erasing each deleted channel */
+  std::vector<PVRChannelGroupMember> deletedMembers;
+  unsigned int iKeptPtr(0);
+  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
   {
     CPVRChannelPtr channel = m_members.at(iChannelPtr).channel;
-    if (!channel)
-      continue;
-
-    if (channels.GetByClient(channel->UniqueID(), channel->ClientID()) == NULL)
+    if (!channel || channels.GetByClient(channel->UniqueID(), channel->ClientID()))
     {
-      /* channel was not found */
-      CLog::Log(LOGINFO,"PVRChannelGroup - %s - deleted %s channel '%s' from group '%s'",
-          __FUNCTION__, m_bRadio ? "radio" : "TV", channel->ChannelName().c_str(), GroupName().c_str());
+      if (iKeptPtr != iChannelPtr)
+        m_members.at(iKeptPtr) = m_members.at(iChannelPtr);
+      iKeptPtr++;
+    }
+    else
+      deletedMembers.push_back(m_members.at(iChannelPtr));
+  }
 
-      /* remove this channel from all non-system groups if this is the internal group */
-      if (IsInternalGroup())
-      {
-        g_PVRChannelGroups->Get(m_bRadio)->RemoveFromAllGroups(*channel);
+  if (deletedMembers.empty())
+    return bReturn;
 
-        /* since it was not found in the internal group, it was deleted from the backend */
-        channel->Delete();
-      }
+  m_members.resize(iKeptPtr);
+  InvalidateMemberIndex();
+  m_bChanged = true;
+  bReturn = true;
 
-      m_members.erase(m_members.begin() + iChannelPtr);
-      m_bChanged = true;
-      bReturn = true;
+  for (unsigned int iChannelPtr = 0; iChannelPtr < deletedMembers.size(); iChannelPtr++)
+  {
+    CPVRChannelPtr channel = deletedMembers.at(iChannelPtr).channel;
+
+    /* channel was not found */
+    CLog::Log(LOGINFO,"PVRChannelGroup - %s - deleted %s channel '%s' from group '%s'",
+        __FUNCTION__, m_bRadio ? "radio" : "TV", channel->ChannelName().c_str(), GroupName().c_str());
+
+    /* remove this channel from all non-system groups if this is the internal group */
+    if (IsInternalGroup())
+    {
+      g_PVRChannelGroups->Get(m_bRadio)->RemoveFromAllGroups(*channel);
+
+      /* since it was not found in the internal group, it was deleted from the backend */
+      channel->Delete();
     }
   }
 
@@ -699,6 +805,7 @@ void CPVRChannelGroup::RemoveInvalidChannels(void)
       else
       {
         m_members.erase(m_members.begin() + ptr);
+        InvalidateMemberIndex();
       }
       m_bChanged = true;
     }
@@ -710,16 +817,14 @@ bool CPVRChannelGroup::RemoveFromGroup(const CPVRChannel &channel)
   bool bReturn(false);
   CSingleLock lock(m_critSection);
 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
+  int iChannelPtr = GetIndex(channel);
+  if (iChannelPtr >= 0)
   {
-    if (channel == *m_members.at(iChannelPtr).channel)
-    {
-      // TODO notify observers
-      m_members.erase(m_members.begin() + iChannelPtr);
-      bReturn = true;
-      m_bChanged = true;
-      break;
-    }
+    // TODO notify observers
+    m_members.erase(m_members.begin() + iChannelPtr);
+    InvalidateMemberIndex();
+    bReturn = true;
+    m_bChanged = true;
   }
 
   Renumber();
@@ -746,6 +851,7 @@ bool CPVRChannelGroup::AddToGroup(CPVRChannel &channel, int iChannelNumber /* =
     {
       PVRChannelGroupMember newMember = { realChannel, iChannelNumber };
       m_members.push_back(newMember);
+      InvalidateMemberIndex();
       m_bChanged = true;
 
       if (bSortAndRenumber)
@@ -767,36 +873,12 @@ bool CPVRChannelGroup::AddToGroup(CPVRChannel &channel, int iChannelNumber /* =
 
 bool CPVRChannelGroup::IsGroupMember(const CPVRChannel &channel) const
 {
-  bool bReturn(false);
-  CSingleLock lock(m_critSection);
-
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
-  {
-    if (channel == *m_members.at(iChannelPtr).channel)
-    {
-      bReturn = true;
-      break;
-    }
-  }
-
-  return bReturn;
+  return GetIndex(channel) >= 0;
 }
 
 bool CPVRChannelGroup::IsGroupMember(int iChannelId) const
 {
-  bool bReturn(false);
-  CSingleLock lock(m_critSection);
-
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
-  {
-    if (iChannelId == m_members.at(iChannelPtr).channel->ChannelID())
-    {
-      bReturn = true;
-      break;
-    }
-  }
-
-  return bReturn;
+  return GetMemberIndexByChannelID(iChannelId) >= 0;
 }
 
 bool CPVRChannelGroup::SetGroupName(const CStdString &strGroupName, bool bSaveInDb /* = false */)
@@ -867,6 +949,7 @@ bool CPVRChannelGroup::Renumber(void)
     {
       bReturn = true;
       m_bChanged = true;
+      InvalidateMemberIndex();
     }
 
     m_members.at(iChannelPtr).iChannelNumber = iCurrentChannelNumber;
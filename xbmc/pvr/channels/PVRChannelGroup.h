@@ -25,6 +25,7 @@
 #include "utils/JobManager.h"
 
 #include <boost/shared_ptr.hpp>
+#include <map>
 
 namespace EPG
 {
@@ -291,6 +292,13 @@ namespace PVR
      */
     virtual int GetMembers(CFileItemList &results, bool bGroupMembers = true) const;
 
+    /*!
+     * @brief Get the channels in this group without creating a file item for each of them.
+     * @param channels The list to add the channels to.
+     * @return The amount of channels that were added to the list.
+     */
+    int GetChannels(std::vector<CPVRChannelPtr> &channels) const;
+
     /*!
      * @return The next channel group.
      */
@@ -447,6 +455,38 @@ namespace PVR
      */
     CPVRChannelPtr GetByChannelID(int iChannelID) const;
 
+    /*!
+     * @brief Mark the member lookup tables as outdated. Call this after m_members changed.
+     */
+    void InvalidateMemberIndex(void);
+
+    /*!
+     * @brief Rebuild the member lookup tables if they are outdated.
+     */
+    void UpdateMemberIndex(void) const;
+
+    /*!
+     * @brief Get the position of a channel in m_members.
+     * @param iUniqueChannelId The unique channel id on the client.
+     * @param iClientID The ID of the client.
+     * @return The position or -1 if it wasn't found.
+     */
+    int GetMemberIndexByClient(int iUniqueChannelId, int iClientID) const;
+
+    /*!
+     * @brief Get the position of a channel in m_members.
+     * @param iChannelID The channel ID.
+     * @return The position or -1 if it wasn't found.
+     */
+    int GetMemberIndexByChannelID(int iChannelID) const;
+
+    /*!
+     * @brief Get the position of a channel in m_members.
+     * @param iChannelNumber The channel number in this group.
+     * @return The position or -1 if it wasn't found.
+     */
+    int GetMemberIndexByChannelNumber(unsigned int iChannelNumber) const;
+
     bool             m_bRadio;                      /*!< true if this container holds radio channels, false if it holds TV channels */
     int              m_iGroupType;                  /*!< The type of this group */
     int              m_iGroupId;                    /*!< The ID of this group in the database */
@@ -457,6 +497,12 @@ namespace PVR
     bool             m_bUsingBackendChannelNumbers; /*!< true to use the channel numbers from 1 backend, false otherwise */
     std::vector<PVRChannelGroupMember> m_members;
     CCriticalSection m_critSection;
+
+    typedef std::pair<int, int> PVRChannelClientKey; /*!< client ID and unique channel ID */
+    mutable std::map<PVRChannelClientKey, unsigned int> m_membersByClient; /*!< position in m_members by client ID and unique channel ID */
+    mutable std::map<int, unsigned int>                 m_membersById;     /*!< position in m_members by channel ID */
+    mutable std::map<unsigned int, unsigned int>        m_membersByNumber; /*!< position in m_members by channel number */
+    mutable bool                                        m_bMemberIndexValid; /*!< false if the lookup tables have to be rebuilt */
   };
 
   class CPVRPersistGroupJob : public CJob
@@ -86,7 +86,7 @@ void CPVRChannelGroupInternal::UpdateChannelPaths(void)
   }
 }
 
-void CPVRChannelGroupInternal::UpdateFromClient(const CPVRChannel &channel, unsigned int iChannelNumber /* = 0 */)
+void CPVRChannelGroupInternal::UpdateFromClient(const CPVRChannel &channel, unsigned int iChannelNumber /* = 0 */, bool bSortAndRenumber /* = true */)
 {
   CSingleLock lock(m_critSection);
   CPVRChannelPtr realChannel = GetByClient(channel.UniqueID(), channel.ClientID());
@@ -96,13 +96,17 @@ void CPVRChannelGroupInternal::UpdateFromClient(const CPVRChannel &channel, unsi
   {
     PVRChannelGroupMember newMember = { CPVRChannelPtr(new CPVRChannel(channel)), iChannelNumber > 0 ? iChannelNumber : m_members.size() + 1 };
     m_members.push_back(newMember);
+    InvalidateMemberIndex();
     m_bChanged = true;
 
-    if (m_bUsingBackendChannelOrder)
-      SortByClientChannelNumber();
-    else
-      SortByChannelNumber();
-    Renumber();
+    if (bSortAndRenumber)
+    {
+      if (m_bUsingBackendChannelOrder)
+        SortByClientChannelNumber();
+      else
+        SortByChannelNumber();
+      Renumber();
+    }
   }
 }
 
@@ -247,9 +251,19 @@ int CPVRChannelGroupInternal::LoadFromClients(void)
 {
   int iCurSize = Size();
 
-  /* get the channels from the backends */
+  /* get the channels from the backends. they are added unsorted, so sort and renumber this list once afterwards */
   g_PVRClients->GetChannels(this);
 
+  CSingleLock lock(m_critSection);
+  if (Size() != iCurSize)
+  {
+    if (m_bUsingBackendChannelOrder)
+      SortByClientChannelNumber();
+    else
+      SortByChannelNumber();
+    Renumber();
+  }
+
   return Size() - iCurSize;
 }
 
@@ -277,19 +291,38 @@ bool CPVRChannelGroupInternal::IsGroupMember(const CPVRChannel &channel) const
 
 bool CPVRChannelGroupInternal::UpdateChannel(const CPVRChannel &channel)
 {
-  CSingleLock lock(m_critSection);
-  CPVRChannelPtr updateChannel = GetByUniqueID(channel.UniqueID());
+  CPVRChannelPtr updateChannel;
+  bool bKeyChanged(false);
+  bool bReturn(false);
 
-  if (!updateChannel)
   {
-    updateChannel = CPVRChannelPtr(new CPVRChannel(channel.IsRadio()));
-    PVRChannelGroupMember newMember = { updateChannel, 0 };
-    m_members.push_back(newMember);
-    updateChannel->SetUniqueID(channel.UniqueID());
+    CSingleLock lock(m_critSection);
+    updateChannel = GetByUniqueID(channel.UniqueID());
+
+    if (!updateChannel)
+    {
+      updateChannel = CPVRChannelPtr(new CPVRChannel(channel.IsRadio()));
+      PVRChannelGroupMember newMember = { updateChannel, 0 };
+      m_members.push_back(newMember);
+      updateChannel->SetUniqueID(channel.UniqueID());
+    }
+    else
+    {
+      /* the channel is found by its unique ID, so only the client ID part of its key can change */
+      bKeyChanged = updateChannel->ClientID() != channel.ClientID();
+    }
+    updateChannel->UpdateFromClient(channel);
+    InvalidateMemberIndex();
+
+    bReturn = updateChannel->Persist(!m_bLoaded);
   }
-  updateChannel->UpdateFromClient(channel);
 
-  return updateChannel->Persist(!m_bLoaded);
+  /* the other groups share this channel and look it up by the same key. the container
+     locks itself before each group, so don't hold this group's lock while calling it */
+  if (bKeyChanged)
+    g_PVRChannelGroups->Get(m_bRadio)->InvalidateMemberIndexes();
+
+  return bReturn;
 }
 
 bool CPVRChannelGroupInternal::AddAndUpdateChannels(const CPVRChannelGroup &channels, bool bUseBackendChannelNumbers)
@@ -297,7 +330,8 @@ bool CPVRChannelGroupInternal::AddAndUpdateChannels(const CPVRChannelGroup &chan
   bool bReturn(false);
   CSingleLock lock(m_critSection);
 
-  /* go through the channel list and check for updated or new channels */
+  /* go through the channel list and check for updated or new channels.
+     new channels are sorted and renumbered once by UpdateGroupEntries() */
   for (unsigned int iChannelPtr = 0; iChannelPtr < channels.m_members.size(); iChannelPtr++)
   {
     PVRChannelGroupMember member = channels.m_members.at(iChannelPtr);
@@ -318,7 +352,7 @@ bool CPVRChannelGroupInternal::AddAndUpdateChannels(const CPVRChannelGroup &chan
     else
     {
       /* new channel */
-      UpdateFromClient(*member.channel, bUseBackendChannelNumbers ? member.channel->ClientChannelNumber() : 0);
+      UpdateFromClient(*member.channel, bUseBackendChannelNumbers ? member.channel->ClientChannelNumber() : 0, false);
       bReturn = true;
       CLog::Log(LOGINFO,"PVRChannelGroupInternal - %s - added %s channel '%s'", __FUNCTION__, m_bRadio ? "radio" : "TV", member.channel->ChannelName().c_str());
     }
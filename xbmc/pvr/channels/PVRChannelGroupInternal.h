@@ -68,9 +68,10 @@ namespace PVR
     /*!
      * @brief Callback for add-ons to update a channel.
      * @param channel The updated channel.
-     * @return True if the channel has been updated succesfully, false otherwise.
+     * @param iChannelNumber The channel number to use for a new channel or 0 to add it to the back.
+     * @param bSortAndRenumber Set to false to not to sort the group after adding a channel
      */
-    void UpdateFromClient(const CPVRChannel &channel, unsigned int iChannelNumber = 0);
+    void UpdateFromClient(const CPVRChannel &channel, unsigned int iChannelNumber = 0, bool bSortAndRenumber = true);
 
     /*!
      * @see CPVRChannelGroup::IsGroupMember
@@ -158,6 +158,13 @@ void CPVRChannelGroups::RemoveFromAllGroups(const CPVRChannel &channel)
   }
 }
 
+void CPVRChannelGroups::InvalidateMemberIndexes(void)
+{
+  CSingleLock lock(m_critSection);
+  for (std::vector<CPVRChannelGroupPtr>::const_iterator it = m_groups.begin(); it != m_groups.end(); it++)
+    (*it)->InvalidateMemberIndex();
+}
+
 bool CPVRChannelGroups::Update(bool bChannelsOnly /* = false */)
 {
   bool bUpdateAllGroups = !bChannelsOnly && g_guiSettings.GetBool("pvrmanager.syncchannelgroups");
@@ -159,6 +159,11 @@ namespace PVR
      */
     void RemoveFromAllGroups(const CPVRChannel &channel);
 
+    /*!
+     * @brief Mark the member lookup tables of all groups as outdated. Call this after the client ID or unique ID of a channel changed.
+     */
+    void InvalidateMemberIndexes(void);
+
     /*!
      * @brief Persist all changes in channel groups.
      * @return True if everything was persisted, false otherwise.
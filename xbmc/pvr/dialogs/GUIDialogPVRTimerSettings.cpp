@@ -52,16 +52,17 @@ CGUIDialogPVRTimerSettings::CGUIDialogPVRTimerSettings(void)
   m_loadType = LOAD_EVERY_TIME;
 }
 
-void CGUIDialogPVRTimerSettings::AddChannelNames(CFileItemList &channelsList, SETTINGSTRINGS &channelNames, bool bRadio)
+void CGUIDialogPVRTimerSettings::AddChannelNames(SETTINGSTRINGS &channelNames, bool bRadio)
 {
-  g_PVRChannelGroups->GetGroupAll(bRadio)->GetMembers(channelsList);
+  /* only the names are needed, so don't create a file item for every channel */
+  std::vector<CPVRChannelPtr> channels;
+  g_PVRChannelGroups->GetGroupAll(bRadio)->GetChannels(channels);
 
   channelNames.push_back("0 dummy");
-  for (int i = 0; i < channelsList.Size(); i++)
+  for (unsigned int i = 0; i < channels.size(); i++)
   {
     CStdString string;
-    CFileItemPtr item = channelsList[i];
-    const CPVRChannel *channel = item->GetPVRChannelInfoTag();
+    const CPVRChannelPtr &channel = channels.at(i);
     string.Format("%i %s", channel->ChannelNumber(), channel->ChannelName().c_str());
     channelNames.push_back(string);
   }
@@ -150,14 +151,12 @@ void CGUIDialogPVRTimerSettings::CreateSettings()
   /// Channel names
   {
     // For TV
-    CFileItemList channelslist_tv;
     SETTINGSTRINGS channelstrings_tv;
-    AddChannelNames(channelslist_tv, channelstrings_tv, false);
+    AddChannelNames(channelstrings_tv, false);
 
     // For Radio
-    CFileItemList channelslist_radio;
     SETTINGSTRINGS channelstrings_radio;
-    AddChannelNames(channelslist_radio, channelstrings_radio, true);
+    AddChannelNames(channelstrings_radio, true);
   }
 
   /// Day
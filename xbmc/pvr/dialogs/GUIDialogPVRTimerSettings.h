@@ -42,7 +42,7 @@ namespace PVR
     virtual void OnSettingChanged(SettingInfo &setting);
     virtual void OnOkay();
     virtual void OnCancel() { m_cancelled = true; }
-    virtual void AddChannelNames(CFileItemList &channelsList, SETTINGSTRINGS &channelNames, bool bRadio);
+    virtual void AddChannelNames(SETTINGSTRINGS &channelNames, bool bRadio);
     virtual void SetWeekdaySettingFromTimer(const CPVRTimerInfoTag &timer);
     virtual void SetTimerFromWeekdaySetting(CPVRTimerInfoTag &timer);
 
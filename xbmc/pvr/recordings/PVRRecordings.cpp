@@ -37,7 +37,9 @@ using namespace PVR;
 
 CPVRRecordings::CPVRRecordings(void) :
     m_bIsUpdating(false),
-    m_strDirectoryHistory("pvr://recordings/")
+    m_strDirectoryHistory("pvr://recordings/"),
+    m_bDirectoryIndexValid(false),
+    m_bIsSyncing(false)
 {
     m_thumbLoader.SetNumOfWorkers(1); 
 }
@@ -45,8 +47,98 @@ CPVRRecordings::CPVRRecordings(void) :
 void CPVRRecordings::UpdateFromClients(void)
 {
   CSingleLock lock(m_critSection);
-  Clear();
-  g_PVRClients->GetRecordings(this);
+
+  StartSync();
+  std::set<int> failedClients;
+  g_PVRClients->GetRecordings(this, failedClients);
+  FinishSync(failedClients);
+}
+
+void CPVRRecordings::StartSync(void)
+{
+  CSingleLock lock(m_critSection);
+  m_syncedRecordings.clear();
+  m_bIsSyncing = true;
+}
+
+void CPVRRecordings::FinishSync(const std::set<int> &failedClients)
+{
+  CSingleLock lock(m_critSection);
+  m_bIsSyncing = false;
+
+  /* known recordings are updated in place, so only the ones that the clients don't report anymore are removed */
+  if (!failedClients.empty())
+    CLog::Log(LOGERROR, "CPVRRecordings - %s - %u clients didn't return their recordings, keeping their recordings", __FUNCTION__, (unsigned int) failedClients.size());
+  RemoveRecordings(failedClients);
+
+  m_syncedRecordings.clear();
+}
+
+void CPVRRecordings::RemoveRecordings(const std::set<int> &failedClients)
+{
+  unsigned int iKept = 0;
+  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  {
+    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    std::map<int, std::set<CStdString> >::const_iterator synced = m_syncedRecordings.find(current->m_iClientId);
+    if (failedClients.find(current->m_iClientId) != failedClients.end() ||
+        (synced != m_syncedRecordings.end() && synced->second.find(current->m_strRecordingId) != synced->second.end()))
+    {
+      m_recordings[iKept++] = current;
+    }
+    else
+    {
+      m_recordingsById.erase(RecordingKey(current->m_iClientId, current->m_strRecordingId));
+      delete current;
+    }
+  }
+
+  if (iKept < m_recordings.size())
+  {
+    CLog::Log(LOGDEBUG, "CPVRRecordings - %s - %u recordings were removed", __FUNCTION__, (unsigned int) (m_recordings.size() - iKept));
+    m_recordings.resize(iKept);
+    m_bDirectoryIndexValid = false;
+  }
+}
+
+void CPVRRecordings::UpdateDirectoryIndex(void)
+{
+  if (m_bDirectoryIndexValid)
+    return;
+
+  m_recordingsByDirectory.clear();
+  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  {
+    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    CStdString strDirectory = TrimSlashes(current->m_strDirectory);
+    strDirectory.ToLower();
+    m_recordingsByDirectory[strDirectory].push_back(current);
+  }
+
+  m_bDirectoryIndexValid = true;
+}
+
+void CPVRRecordings::GetDirectoryMembers(const CStdString &strDirectory, bool bDirectMember, std::vector<CPVRRecording *> &members)
+{
+  CStdString strUseDirectory = TrimSlashes(strDirectory);
+  strUseDirectory.ToLower();
+
+  /* directories are compared case insensitive. the index is sorted by the lower case
+     name, so all directories that start with the requested one follow each other */
+  UpdateDirectoryIndex();
+  RecordingsByDirectory::const_iterator itDirectory;
+  if (bDirectMember)
+  {
+    itDirectory = m_recordingsByDirectory.find(strUseDirectory);
+    if (itDirectory != m_recordingsByDirectory.end())
+      members.insert(members.end(), itDirectory->second.begin(), itDirectory->second.end());
+    return;
+  }
+
+  for (itDirectory = m_recordingsByDirectory.lower_bound(strUseDirectory);
+      itDirectory != m_recordingsByDirectory.end() && itDirectory->first.Left(strUseDirectory.GetLength()) == strUseDirectory;
+      ++itDirectory)
+    members.insert(members.end(), itDirectory->second.begin(), itDirectory->second.end());
 }
 
 CStdString CPVRRecordings::TrimSlashes(const CStdString &strOrig) const
@@ -85,23 +177,17 @@ const CStdString CPVRRecordings::GetDirectoryFromPath(const CStdString &strPath,
   return TrimSlashes(strReturn);
 }
 
-bool CPVRRecordings::IsDirectoryMember(const CStdString &strDirectory, const CStdString &strEntryDirectory, bool bDirectMember /* = true */) const
+void CPVRRecordings::GetContents(const CStdString &strDirectory, CFileItemList *results)
 {
-  CStdString strUseDirectory = TrimSlashes(strDirectory);
-  CStdString strUseEntryDirectory = TrimSlashes(strEntryDirectory);
+  std::vector<CPVRRecording *> recordings;
+  GetDirectoryMembers(RemoveAllRecordingsPathExtension(strDirectory), !HasAllRecordingsPathExtension(strDirectory), recordings);
 
-  return strUseEntryDirectory.Left(strUseDirectory.GetLength()).Equals(strUseDirectory) &&
-      (!bDirectMember || strUseEntryDirectory.Equals(strUseDirectory));
-}
+  CVideoDatabase db;
+  bool bDatabaseOpen = db.Open();
 
-void CPVRRecordings::GetContents(const CStdString &strDirectory, CFileItemList *results)
-{
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  for (unsigned int iRecordingPtr = 0; iRecordingPtr < recordings.size(); iRecordingPtr++)
   {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
-    bool directMember = !HasAllRecordingsPathExtension(strDirectory);
-    if (!IsDirectoryMember(RemoveAllRecordingsPathExtension(strDirectory), current->m_strDirectory, directMember))
-      continue;
+    CPVRRecording *current = recordings.at(iRecordingPtr);
 
     CFileItemPtr pFileItem(new CFileItem(*current));
     pFileItem->SetLabel2(current->RecordingTimeAsLocalTime().GetAsLocalizedDateTime(true, false));
@@ -122,10 +208,8 @@ void CPVRRecordings::GetContents(const CStdString &strDirectory, CFileItemList *
     {
       pFileItem->GetPVRRecordingInfoTag()->m_playCount=pFileItem->GetPVRRecordingInfoTag()->m_iRecPlayCount;
     }
-    else
+    else if (bDatabaseOpen)
     {
-      CVideoDatabase db;
-      if (db.Open())
       pFileItem->GetPVRRecordingInfoTag()->m_playCount=db.GetPlayCount(*pFileItem);
     }
     pFileItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, pFileItem->GetPVRRecordingInfoTag()->m_playCount > 0);
@@ -140,16 +224,11 @@ void CPVRRecordings::GetContents(const CStdString &strDirectory, CFileItemList *
       bookmark.totalTimeInSeconds = (double)current->GetDuration();
       pFileItem->GetPVRRecordingInfoTag()->m_resumePoint = bookmark;
     }
-    else if (positionInSeconds < 0)
+    else if (positionInSeconds < 0 && bDatabaseOpen)
     {
-      CVideoDatabase db;
-      if (db.Open())
-      {
-        CBookmark bookmark;
-        if (db.GetResumeBookMark(current->m_strFileNameAndPath, bookmark))
-          pFileItem->GetPVRRecordingInfoTag()->m_resumePoint = bookmark;
-        db.Close();
-      }
+      CBookmark bookmark;
+      if (db.GetResumeBookMark(current->m_strFileNameAndPath, bookmark))
+        pFileItem->GetPVRRecordingInfoTag()->m_resumePoint = bookmark;
     }
 
     results->Add(pFileItem);
@@ -161,10 +240,21 @@ void CPVRRecordings::GetSubDirectories(const CStdString &strBase, CFileItemList
   CStdString strUseBase = TrimSlashes(strBase);
 
   std::set<CStdString> unwatchedFolders;
+  std::map<CStdString, CFileItemPtr> folders;
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  /* only recordings below the base directory can add a sub directory */
+  std::vector<CPVRRecording *> recordings;
+  if (strUseBase.IsEmpty())
+    GetDirectoryMembers(strUseBase, false, recordings);
+  else
+    GetDirectoryMembers(strUseBase + "/", false, recordings);
+
+  CVideoDatabase db;
+  bool bDatabaseOpen = db.Open();
+
+  for (unsigned int iRecordingPtr = 0; iRecordingPtr < recordings.size(); iRecordingPtr++)
   {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    CPVRRecording *current = recordings.at(iRecordingPtr);
     const CStdString strCurrent = GetDirectoryFromPath(current->m_strDirectory, strUseBase);
     if (strCurrent.IsEmpty())
       continue;
@@ -175,7 +265,8 @@ void CPVRRecordings::GetSubDirectories(const CStdString &strBase, CFileItemList
     else
       strFilePath.Format("pvr://recordings/%s/%s/", strUseBase.c_str(), strCurrent.c_str());
 
-    if (!results->Contains(strFilePath))
+    std::map<CStdString, CFileItemPtr>::iterator itFolder = folders.find(strFilePath);
+    if (itFolder == folders.end())
     {
       CFileItemPtr pFileItem;
       pFileItem.reset(new CFileItem(strCurrent, true));
@@ -185,10 +276,9 @@ void CPVRRecordings::GetSubDirectories(const CStdString &strBase, CFileItemList
       pFileItem->m_dateTime = current->RecordingTimeAsLocalTime();
 
       // Initialize folder overlay from play count (either directly from client or from video database)
-      CVideoDatabase db;
       bool supportsPlayCount = g_PVRClients->SupportsRecordingPlayCount(current->m_iClientId);
       if ((supportsPlayCount && current->m_iRecPlayCount > 0) ||
-          (!supportsPlayCount && db.Open() && db.GetPlayCount(*pFileItem) > 0))
+          (!supportsPlayCount && bDatabaseOpen && db.GetPlayCount(*pFileItem) > 0))
       {
         pFileItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_WATCHED, false);
       }
@@ -198,19 +288,18 @@ void CPVRRecordings::GetSubDirectories(const CStdString &strBase, CFileItemList
       }
 
       results->Add(pFileItem);
+      folders.insert(std::make_pair(strFilePath, pFileItem));
     }
     else
     {
-      CFileItemPtr pFileItem;
-      pFileItem=results->Get(strFilePath);
+      CFileItemPtr pFileItem = itFolder->second;
       if (pFileItem->m_dateTime<current->RecordingTimeAsLocalTime())
         pFileItem->m_dateTime  = current->RecordingTimeAsLocalTime();
 
       // Unset folder overlay if recording is unwatched
       if (unwatchedFolders.find(strFilePath) == unwatchedFolders.end()) {
-        CVideoDatabase db;
         bool supportsPlayCount = g_PVRClients->SupportsRecordingPlayCount(current->m_iClientId);
-        if ((supportsPlayCount && current->m_iRecPlayCount == 0) || (!supportsPlayCount && db.Open() && db.GetPlayCount(*pFileItem) == 0))
+        if ((supportsPlayCount && current->m_iRecPlayCount == 0) || (!supportsPlayCount && bDatabaseOpen && db.GetPlayCount(*pFileItem) == 0))
         {
           pFileItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, false);
           unwatchedFolders.insert(strFilePath);
@@ -439,7 +528,6 @@ bool CPVRRecordings::SetRecordingsPlayCount(const CFileItemPtr &item, int count)
 bool CPVRRecordings::GetDirectory(const CStdString& strPath, CFileItemList &items)
 {
   bool bSuccess(false);
-  CFileItemList files;
 
   {
     CSingleLock lock(m_critSection);
@@ -451,19 +539,18 @@ bool CPVRRecordings::GetDirectory(const CStdString& strPath, CFileItemList &item
     if (strFileName.Left(10) == "recordings")
     {
       strFileName.erase(0, 10);
+      /* this adds the recordings of the directory too */
       GetSubDirectories(strFileName, &items, true);
-      GetContents(strFileName, &files);
       bSuccess = true;
     }
   }
 
   if(bSuccess)
   {
-    for (int i = 0; i < files.Size(); i++)
+    for (int i = 0; i < items.Size(); i++)
     {
-      CFileItemPtr pFileItem = files.Get(i);
-      CFileItemPtr pThumbItem = items.Get(pFileItem->GetPath());
-      if (!pThumbItem->HasThumbnail())
+      CFileItemPtr pThumbItem = items.Get(i);
+      if (!pThumbItem->m_bIsFolder && !pThumbItem->HasThumbnail())
         m_thumbLoader.LoadItem(pThumbItem.get());
     }
   }
@@ -478,15 +565,9 @@ void CPVRRecordings::SetPlayCount(const CFileItem &item, int iPlayCount)
 
   const CPVRRecording *recording = item.GetPVRRecordingInfoTag();
   CSingleLock lock(m_critSection);
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
-  {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
-    if (*current == *recording)
-    {
-      current->SetPlayCount(iPlayCount);
-      break;
-    }
-  }
+  std::map<RecordingKey, CPVRRecording *>::iterator it = m_recordingsById.find(RecordingKey(recording->m_iClientId, recording->m_strRecordingId));
+  if (it != m_recordingsById.end() && *it->second == *recording)
+    it->second->SetPlayCount(iPlayCount);
 }
 
 void CPVRRecordings::GetAll(CFileItemList &items)
@@ -549,29 +630,33 @@ void CPVRRecordings::Clear()
   for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
     delete m_recordings.at(iRecordingPtr);
   m_recordings.erase(m_recordings.begin(), m_recordings.end());
+  m_recordingsById.clear();
+  m_recordingsByDirectory.clear();
+  m_bDirectoryIndexValid = false;
 }
 
 void CPVRRecordings::UpdateEntry(const CPVRRecording &tag)
 {
-  bool bFound = false;
   CSingleLock lock(m_critSection);
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  RecordingKey key(tag.m_iClientId, tag.m_strRecordingId);
+  if (m_bIsSyncing)
+    m_syncedRecordings[tag.m_iClientId].insert(tag.m_strRecordingId);
+
+  std::map<RecordingKey, CPVRRecording *>::iterator it = m_recordingsById.find(key);
+  if (it != m_recordingsById.end())
   {
-    CPVRRecording *currentTag = m_recordings.at(iRecordingPtr);
-    if (currentTag->m_iClientId == tag.m_iClientId &&
-        currentTag->m_strRecordingId.Equals(tag.m_strRecordingId))
-    {
-      currentTag->Update(tag);
-      bFound = true;
-      break;
-    }
+    CPVRRecording *currentTag = it->second;
+    if (!currentTag->m_strDirectory.Equals(tag.m_strDirectory))
+      m_bDirectoryIndexValid = false;
+    currentTag->Update(tag);
   }
-
-  if (!bFound)
+  else
   {
     CPVRRecording *newTag = new CPVRRecording();
     newTag->Update(tag);
     m_recordings.push_back(newTag);
+    m_recordingsById.insert(std::make_pair(key, newTag));
+    m_bDirectoryIndexValid = false;
   }
 }
@@ -25,6 +25,9 @@
 #include "utils/Observer.h"
 #include "ThumbLoader.h"
 
+#include <map>
+#include <set>
+
 #define PVR_ALL_RECORDINGS_PATH_EXTENSION "-1"
 
 namespace PVR
@@ -32,16 +35,25 @@ namespace PVR
   class CPVRRecordings : public Observable
   {
   private:
-    CCriticalSection             m_critSection;
-    bool                         m_bIsUpdating;
-    CStdString                   m_strDirectoryHistory;
-    CVideoThumbLoader            m_thumbLoader;
-    std::vector<CPVRRecording *> m_recordings;
+    typedef std::pair<int, CStdString> RecordingKey; /*!< client id and recording id */
+    typedef std::map<CStdString, std::vector<CPVRRecording *> > RecordingsByDirectory;
+
+    CCriticalSection                         m_critSection;
+    bool                                     m_bIsUpdating;
+    CStdString                               m_strDirectoryHistory;
+    CVideoThumbLoader                        m_thumbLoader;
+    std::vector<CPVRRecording *>             m_recordings;
+    std::map<RecordingKey, CPVRRecording *>  m_recordingsById;         /*!< all recordings by client and recording id */
+    RecordingsByDirectory                    m_recordingsByDirectory;  /*!< all recordings by their lower case directory */
+    bool                                     m_bDirectoryIndexValid;   /*!< false if m_recordingsByDirectory has to be rebuilt */
+    std::map<int, std::set<CStdString> >     m_syncedRecordings;       /*!< recording ids received from each client during the current update */
+    bool                                     m_bIsSyncing;             /*!< true while the clients transfer their recordings */
 
     virtual void UpdateFromClients(void);
+    void RemoveRecordings(const std::set<int> &failedClients);
+    void UpdateDirectoryIndex(void);
     virtual CStdString TrimSlashes(const CStdString &strOrig) const;
     virtual const CStdString GetDirectoryFromPath(const CStdString &strPath, const CStdString &strBase) const;
-    virtual bool IsDirectoryMember(const CStdString &strDirectory, const CStdString &strEntryDirectory, bool bDirectMember = true) const;
     virtual void GetContents(const CStdString &strDirectory, CFileItemList *results);
     virtual void GetSubDirectories(const CStdString &strBase, CFileItemList *results, bool bAutoSkip = true);
 
@@ -49,6 +61,26 @@ namespace PVR
     CStdString AddAllRecordingsPathExtension(const CStdString &strDirectory);
     CStdString RemoveAllRecordingsPathExtension(const CStdString &strDirectory);
 
+  protected:
+    /*!
+     * @brief Start an update. Recordings passed to UpdateEntry() until FinishSync() is called are kept.
+     */
+    void StartSync(void);
+
+    /*!
+     * @brief Finish an update and remove the recordings that weren't received.
+     * @param failedClients The clients that failed to return their recordings. None of their recordings are removed.
+     */
+    void FinishSync(const std::set<int> &failedClients);
+
+    /*!
+     * @brief Get the recordings in a directory.
+     * @param strDirectory The directory, compared case insensitive.
+     * @param bDirectMember True for the recordings in the directory itself, false to include its sub directories.
+     * @param members The recordings.
+     */
+    void GetDirectoryMembers(const CStdString &strDirectory, bool bDirectMember, std::vector<CPVRRecording *> &members);
+
   public:
     CPVRRecordings(void);
     virtual ~CPVRRecordings(void) { Clear(); };
@@ -0,0 +1,160 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "pvr/recordings/PVRRecordings.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace PVR;
+
+/* syncs recordings like the clients would, without a client */
+class CTestPVRRecordings : public CPVRRecordings
+{
+public:
+  void Sync(const std::vector<CPVRRecording> &recordings, const std::set<int> &failedClients = std::set<int>())
+  {
+    StartSync();
+    for (std::vector<CPVRRecording>::const_iterator it = recordings.begin(); it != recordings.end(); ++it)
+      UpdateEntry(*it);
+    FinishSync(failedClients);
+  }
+
+  std::vector<CStdString> GetIds(const CStdString &strDirectory, bool bDirectMember)
+  {
+    std::vector<CPVRRecording *> members;
+    GetDirectoryMembers(strDirectory, bDirectMember, members);
+
+    std::vector<CStdString> ids;
+    for (std::vector<CPVRRecording *>::const_iterator it = members.begin(); it != members.end(); ++it)
+      ids.push_back((*it)->m_strRecordingId);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  CStdString GetTitle(const CStdString &strRecordingId)
+  {
+    CFileItemList items;
+    GetRecordings(&items);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      if (items[i]->GetPVRRecordingInfoTag()->m_strRecordingId == strRecordingId)
+        return items[i]->GetPVRRecordingInfoTag()->m_strTitle;
+    }
+    return "";
+  }
+};
+
+static CPVRRecording CreateRecording(int iClientId, const CStdString &strRecordingId, const CStdString &strDirectory, const CStdString &strTitle)
+{
+  CPVRRecording recording;
+  recording.m_iClientId      = iClientId;
+  recording.m_strRecordingId = strRecordingId;
+  recording.m_strDirectory   = strDirectory;
+  recording.m_strTitle       = strTitle;
+  return recording;
+}
+
+static std::vector<CStdString> Ids(const char *id1 = NULL, const char *id2 = NULL, const char *id3 = NULL)
+{
+  std::vector<CStdString> ids;
+  if (id1) ids.push_back(id1);
+  if (id2) ids.push_back(id2);
+  if (id3) ids.push_back(id3);
+  return ids;
+}
+
+TEST(TestPVRRecordings, AddUpdateRemove)
+{
+  CTestPVRRecordings recordings;
+  std::vector<CPVRRecording> received;
+  received.push_back(CreateRecording(1, "a", "/Movies", "Movie A"));
+  received.push_back(CreateRecording(1, "b", "/Movies", "Movie B"));
+  received.push_back(CreateRecording(2, "c", "/Movies", "Movie C"));
+  recordings.Sync(received);
+  EXPECT_EQ(3, recordings.GetNumRecordings());
+
+  /* a changed recording is updated, a missing one removed */
+  received.clear();
+  received.push_back(CreateRecording(1, "a", "/Movies", "Movie A (director's cut)"));
+  received.push_back(CreateRecording(2, "c", "/Movies", "Movie C"));
+  recordings.Sync(received);
+  EXPECT_EQ(2, recordings.GetNumRecordings());
+  EXPECT_EQ("Movie A (director's cut)", recordings.GetTitle("a"));
+  EXPECT_EQ(Ids("a", "c"), recordings.GetIds("Movies", true));
+
+  /* the same id on another client is another recording */
+  received.push_back(CreateRecording(2, "a", "/Movies", "Other A"));
+  recordings.Sync(received);
+  EXPECT_EQ(3, recordings.GetNumRecordings());
+}
+
+TEST(TestPVRRecordings, FailedClient)
+{
+  CTestPVRRecordings recordings;
+  std::vector<CPVRRecording> received;
+  received.push_back(CreateRecording(1, "a", "/Movies", "Movie A"));
+  received.push_back(CreateRecording(1, "b", "/Movies", "Movie B"));
+  received.push_back(CreateRecording(2, "c", "/Movies", "Movie C"));
+  recordings.Sync(received);
+
+  /* recordings of a failed client are kept, the others are synced */
+  received.clear();
+  received.push_back(CreateRecording(1, "a", "/Movies", "Movie A"));
+  std::set<int> failedClients;
+  failedClients.insert(2);
+  recordings.Sync(received, failedClients);
+  EXPECT_EQ(Ids("a", "c"), recordings.GetIds("Movies", true));
+
+  /* and removed once the client reports they're gone */
+  recordings.Sync(received);
+  EXPECT_EQ(Ids("a"), recordings.GetIds("Movies", true));
+}
+
+TEST(TestPVRRecordings, DirectoryIndex)
+{
+  CTestPVRRecordings recordings;
+  std::vector<CPVRRecording> received;
+  received.push_back(CreateRecording(1, "a", "/Movies", "Movie A"));
+  received.push_back(CreateRecording(1, "b", "/Series/Show", "Episode 1"));
+  received.push_back(CreateRecording(1, "c", "/Series/Show/Season 2", "Episode 2"));
+  recordings.Sync(received);
+
+  EXPECT_EQ(Ids("a"), recordings.GetIds("Movies", true));
+  EXPECT_EQ(Ids("b"), recordings.GetIds("/series/show/", true));
+  EXPECT_EQ(Ids("b", "c"), recordings.GetIds("Series", false));
+  EXPECT_EQ(Ids("a", "b", "c"), recordings.GetIds("", false));
+  EXPECT_TRUE(recordings.GetIds("Series", true).empty());
+
+  /* a recording that moved is listed in its new directory only */
+  received[2] = CreateRecording(1, "c", "/Movies/Show", "Episode 2");
+  recordings.Sync(received);
+  EXPECT_EQ(Ids("b"), recordings.GetIds("Series", false));
+  EXPECT_EQ(Ids("a", "c"), recordings.GetIds("Movies", false));
+  EXPECT_EQ(Ids("c"), recordings.GetIds("Movies/Show", true));
+
+  /* and a removed one isn't listed anymore */
+  received.erase(received.begin() + 1);
+  recordings.Sync(received);
+  EXPECT_TRUE(recordings.GetIds("Series", false).empty());
+  EXPECT_EQ(Ids("a", "c"), recordings.GetIds("", false));
+}
@@ -102,6 +102,7 @@ class CAdvancedSettings
     float m_ac3Gain;
     CStdString m_audioDefaultPlayer;
     float m_audioPlayCountMinimumPercent;
+    int m_audioPreloadTracks;
     bool m_dvdplayerIgnoreDTSinWAV;
     int m_audioResample;
     bool m_allowTranscode44100;
@@ -158,6 +159,9 @@ class CAdvancedSettings
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
     bool m_videoDisableBackgroundDeinterlace;
+    bool m_videoFrameThreading;
+    bool m_videoFastStart;
+    int  m_videoThumbExtractThreads;
     int  m_videoCaptureUseOcclusionQuery;
     bool m_DXVACheckCompatibility;
     bool m_DXVACheckCompatibilityPresent;
@@ -278,6 +282,7 @@ class CAdvancedSettings
     int m_iEpgRetryInterruptedUpdateInterval; // seconds
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
+    int m_iEpgUpdateJobsPerClient;  // tables fetched in parallel from each client
 
     // EDL Commercial Break
     bool m_bEdlMergeShortCommBreaks;
@@ -334,6 +339,8 @@ class CAdvancedSettings
     int m_iPVRMinVideoCacheLevel;      /*!< @brief cache up to this level in the video buffer buffer before resuming playback if the buffers run dry */
     int m_iPVRMinAudioCacheLevel;      /*!< @brief cache up to this level in the audio buffer before resuming playback if the buffers run dry */
     bool m_bPVRCacheInDvdPlayer; /*!< @brief true to use "CACHESTATE_PVR" in CDVDPlayer (default) */
+    int m_iPVRPreopenChannels;         /*!< @brief amount of channels before and after the playing one whose http streams are opened in advance. defaults to 0 (disabled). */
+    int m_iPVRTimeshiftBufferSize;     /*!< @brief size of the local buffer for live streams the backend can't seek in, in MB. 0 to buffer in a temporary file, -1 to disable it. defaults to 20. */
 
     bool m_measureRefreshrate; //when true the videoreferenceclock will measure the refreshrate when direct3d is used
                                //otherwise it will use the windows refreshrate
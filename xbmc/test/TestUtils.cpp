@@ -221,6 +221,11 @@ std::vector<CStdString> &CXBMCTestUtils::getGUISettingsFiles()
   return GUISettingsFiles;
 }
 
+std::vector<CStdString> &CXBMCTestUtils::getTestVideoCodecFiles()
+{
+  return TestVideoCodecFiles;
+}
+
 static const char usage[] =
 "XBMC Test Suite\n"
 "Usage: xbmc-test [options]\n"
@@ -265,6 +270,13 @@ static const char usage[] =
 "    Add multiple GUI settings files from a ',' delimited string of\n"
 "    files to be loaded in test cases that use them.\n"
 "\n"
+"  --add-testvideocodec-file [FILE]\n"
+"    Add a video file to be decoded in the TestDVDVideoCodecFFmpeg tests.\n"
+"\n"
+"  --add-testvideocodec-files [FILES]\n"
+"    Add multiple video files from a ',' delimited string of files to be\n"
+"    decoded in the TestDVDVideoCodecFFmpeg tests.\n"
+"\n"
 "  --set-probability [PROBABILITY]\n"
 "    Set the probability variable used by the file corrupting functions.\n"
 "    The variable should be a double type from 0.0 to 1.0. Values given\n"
@@ -343,6 +355,18 @@ void CXBMCTestUtils::ParseArgs(int argc, char **argv)
       for (it = urls.begin(); it < urls.end(); it++)
         GUISettingsFiles.push_back(*it);
     }
+    else if (arg == "--add-testvideocodec-file")
+    {
+      TestVideoCodecFiles.push_back(argv[++i]);
+    }
+    else if (arg == "--add-testvideocodec-files")
+    {
+      arg = argv[++i];
+      std::vector<std::string> urls = StringUtils::Split(arg, ",");
+      std::vector<std::string>::iterator it;
+      for (it = urls.begin(); it < urls.end(); it++)
+        TestVideoCodecFiles.push_back(*it);
+    }
     else if (arg == "--set-probability")
     {
       probability = atof(argv[++i]);
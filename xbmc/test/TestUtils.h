@@ -75,6 +75,9 @@ public:
   /* Function to get GUI settings files. */
   std::vector<CStdString> &getGUISettingsFiles();
 
+  /* Function to get the video files used in the TestDVDVideoCodecFFmpeg tests. */
+  std::vector<CStdString> &getTestVideoCodecFiles();
+
   /* Function used in creating a corrupted file. The parameters are a URL
    * to the original file to be corrupted and a suffix to append to the
    * path of the newly created file. This will return a XFILE::CFile
@@ -98,6 +101,7 @@ private:
 
   std::vector<CStdString> AdvancedSettingsFiles;
   std::vector<CStdString> GUISettingsFiles;
+  std::vector<CStdString> TestVideoCodecFiles;
 
   double probability;
 };
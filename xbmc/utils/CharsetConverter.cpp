@@ -28,6 +28,12 @@
 #include <errno.h>
 #include <iconv.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #if defined(TARGET_DARWIN)
 #ifdef __POWERPC__
   #define WCHAR_CHARSET "UTF-32BE"
@@ -53,18 +59,76 @@
 #endif
 
 
-static iconv_t m_iconvStringCharsetToFontCharset = (iconv_t)-1;
-static iconv_t m_iconvSubtitleCharsetToW         = (iconv_t)-1;
-static iconv_t m_iconvUtf8ToStringCharset        = (iconv_t)-1;
-static iconv_t m_iconvStringCharsetToUtf8        = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToStringCharset = (iconv_t)-1;
-static iconv_t m_iconvUtf32ToStringCharset       = (iconv_t)-1;
-static iconv_t m_iconvWtoUtf8                    = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoW                 = (iconv_t)-1;
-static iconv_t m_iconvUtf16BEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf8toW                    = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToUtf8          = (iconv_t)-1;
+/*!
+ \brief A pool of iconv handles for one conversion.
+
+ A handle is taken out of the pool for the duration of a single conversion,
+ so threads converting with the same charsets don't serialize on each other.
+ Handles are opened on demand and kept around for reuse.
+ */
+class CIconvPool
+{
+public:
+  CIconvPool() : m_generation(0) {}
+  ~CIconvPool() { Reset(); }
+
+  iconv_t Acquire(unsigned int &generation)
+  {
+    CSingleLock lock(m_critSection);
+    generation = m_generation;
+    if (m_idle.empty())
+      return (iconv_t)-1;
+
+    iconv_t handle = m_idle.back();
+    m_idle.pop_back();
+    return handle;
+  }
+
+  void Release(iconv_t handle, unsigned int generation)
+  {
+    if (handle == (iconv_t)-1)
+      return;
+
+    // drop any shift state left behind by an aborted conversion
+    iconv(handle, NULL, NULL, NULL, NULL);
+
+    CSingleLock lock(m_critSection);
+    // handles opened before the last reset() may use stale charsets
+    if (generation == m_generation && m_idle.size() < ICONV_POOL_SIZE)
+      m_idle.push_back(handle);
+    else
+      iconv_close(handle);
+  }
+
+  void Reset()
+  {
+    CSingleLock lock(m_critSection);
+    for (std::vector<iconv_t>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+      iconv_close(*it);
+    m_idle.clear();
+    m_generation++;
+  }
+
+private:
+  static const unsigned int ICONV_POOL_SIZE = 8;
+
+  CCriticalSection     m_critSection;
+  std::vector<iconv_t> m_idle;
+  unsigned int         m_generation;
+};
+
+static CIconvPool m_iconvStringCharsetToFontCharset;
+static CIconvPool m_iconvSubtitleCharsetToW;
+static CIconvPool m_iconvUtf8ToStringCharset;
+static CIconvPool m_iconvStringCharsetToUtf8;
+static CIconvPool m_iconvUcs2CharsetToStringCharset;
+static CIconvPool m_iconvUtf32ToStringCharset;
+static CIconvPool m_iconvWtoUtf8;
+static CIconvPool m_iconvUtf16LEtoW;
+static CIconvPool m_iconvUtf16BEtoUtf8;
+static CIconvPool m_iconvUtf16LEtoUtf8;
+static CIconvPool m_iconvUtf8toW;
+static CIconvPool m_iconvUcs2CharsetToUtf8;
 
 #if defined(FRIBIDI_CHAR_SET_NOT_FOUND)
 static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHAR_SET_NOT_FOUND;
@@ -76,6 +140,7 @@ static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHARSET_NOT_FOUND;
 #define FRIBIDI_NOTFOUND FRIBIDI_CHARSET_NOT_FOUND
 #endif
 
+// guards fribidi, which isn't threadsafe, and m_stringFribidiCharset
 static CCriticalSection            m_critSection;
 
 static struct SFribidMapping
@@ -138,7 +203,6 @@ static struct SCharsetMapping
 #define UTF8_DEST_MULTIPLIER 6
 
 #define ICONV_PREPARE(iconv) iconv=(iconv_t)-1
-#define ICONV_SAFE_CLOSE(iconv) if (iconv!=(iconv_t)-1) { iconv_close(iconv); iconv=(iconv_t)-1; }
 
 size_t iconv_const (void* cd, const char** inbuf, size_t *inbytesleft,
                     char* * outbuf, size_t *outbytesleft)
@@ -264,6 +328,16 @@ static bool convert_checked(iconv_t& type, int multiplier, const CStdString& str
   return true;
 }
 
+template<class INPUT,class OUTPUT>
+static bool convert_checked(CIconvPool& pool, int multiplier, const CStdString& strFromCharset, const CStdString& strToCharset, const INPUT& strSource, OUTPUT& strDest)
+{
+  unsigned int generation;
+  iconv_t type = pool.Acquire(generation);
+  bool ret = convert_checked(type, multiplier, strFromCharset, strToCharset, strSource, strDest);
+  pool.Release(type, generation);
+  return ret;
+}
+
 template<class INPUT,class OUTPUT>
 static void convert(iconv_t& type, int multiplier, const CStdString& strFromCharset, const CStdString& strToCharset, const INPUT& strSource,  OUTPUT& strDest)
 {
@@ -271,6 +345,170 @@ static void convert(iconv_t& type, int multiplier, const CStdString& strFromChar
     strDest = strSource;
 }
 
+template<class INPUT,class OUTPUT>
+static void convert(CIconvPool& pool, int multiplier, const CStdString& strFromCharset, const CStdString& strToCharset, const INPUT& strSource,  OUTPUT& strDest)
+{
+  if(!convert_checked(pool, multiplier, strFromCharset, strToCharset, strSource, strDest))
+    strDest = strSource;
+}
+
+/*!
+ \brief Length of the run of 7-bit ASCII bytes at the start of buf.
+
+ Tags and filenames are mostly plain ASCII, so this is checked 16 bytes at a
+ time where SIMD is available and a machine word at a time otherwise.
+ */
+static size_t asciiPrefixLength(const unsigned char *buf, size_t len)
+{
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i chunk = _mm_loadu_si128((const __m128i*)(buf + i));
+    if (_mm_movemask_epi8(chunk))
+      break;
+  }
+#elif defined(__ARM_NEON__)
+  for (; i + 16 <= len; i += 16)
+  {
+    uint8x16_t chunk = vld1q_u8(buf + i);
+    uint8x8_t folded = vorr_u8(vget_low_u8(chunk), vget_high_u8(chunk));
+    if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL)
+      break;
+  }
+#else
+  for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t))
+  {
+    uint32_t word;
+    memcpy(&word, buf + i, sizeof(word));
+    if (word & 0x80808080)
+      break;
+  }
+#endif
+  while (i < len && buf[i] < 0x80)
+    i++;
+  return i;
+}
+
+static bool isAsciiLine(const CStdStringA& str)
+{
+  for (const unsigned char *c = (const unsigned char*)str.c_str(); *c; c++)
+  {
+    if (*c >= 0x80 || *c == '\n')
+      return false;
+  }
+  return true;
+}
+
+/*!
+ \brief Decode UTF-8 to wchar_t without going through iconv.
+ \return false if the input isn't strictly valid UTF-8 (or, on Darwin, not
+ plain ASCII), in which case iconv has to do the job.
+ */
+static bool utf8ToWFast(const CStdStringA& strSource, CStdStringW& strDest)
+{
+  const unsigned char *src = (const unsigned char*)strSource.c_str();
+  const unsigned char *end = src + strlen((const char*)src);
+  std::wstring dest;
+  dest.reserve(end - src);
+
+  while (src < end)
+  {
+    size_t ascii = asciiPrefixLength(src, end - src);
+    dest.append(src, src + ascii);
+    src += ascii;
+    if (src == end)
+      break;
+
+    uint32_t c = *src++;
+    if (c >= 0x80)
+    {
+#if defined(TARGET_DARWIN)
+      // UTF-8-MAC also normalizes decomposed characters, leave that to iconv
+      return false;
+#endif
+      int trailing;
+      uint32_t min;
+      if ((c & 0xe0) == 0xc0)      { trailing = 1; min = 0x80;    c &= 0x1f; }
+      else if ((c & 0xf0) == 0xe0) { trailing = 2; min = 0x800;   c &= 0x0f; }
+      else if ((c & 0xf8) == 0xf0) { trailing = 3; min = 0x10000; c &= 0x07; }
+      else
+        return false;
+
+      for (; trailing > 0; trailing--)
+      {
+        if ((*src & 0xc0) != 0x80)
+          return false;
+        c = (c << 6) | (*src++ & 0x3f);
+      }
+
+      // reject overlong forms, surrogates and anything beyond unicode
+      if (c < min || (c >= 0xd800 && c <= 0xdfff) || c > 0x10ffff)
+        return false;
+
+      if (sizeof(wchar_t) == 2 && c >= 0x10000)
+      {
+        c -= 0x10000;
+        dest.push_back((wchar_t)(0xd800 | (c >> 10)));
+        c = 0xdc00 | (c & 0x3ff);
+      }
+    }
+    dest.push_back((wchar_t)c);
+  }
+
+  strDest = dest.c_str();
+  return true;
+}
+
+/*!
+ \brief Encode wchar_t to UTF-8 without going through iconv.
+ \return false on unpaired surrogates or invalid code points, in which case
+ iconv has to do the job.
+ */
+static bool wToUTF8Fast(const CStdStringW& strSource, CStdStringA& strDest)
+{
+  const wchar_t *src = strSource.c_str();
+  std::string dest;
+  dest.reserve(strSource.length());
+
+  while (*src)
+  {
+    uint32_t c = (uint32_t)*src++;
+    if (c >= 0xd800 && c <= 0xdfff)
+    {
+      if (sizeof(wchar_t) != 2 || c >= 0xdc00 || ((uint32_t)*src & 0xfc00) != 0xdc00)
+        return false;
+      c = 0x10000 + (((c & 0x3ff) << 10) | ((uint32_t)*src++ & 0x3ff));
+    }
+
+    if (c < 0x80)
+      dest.push_back((char)c);
+    else if (c < 0x800)
+    {
+      dest.push_back((char)(0xc0 | (c >> 6)));
+      dest.push_back((char)(0x80 | (c & 0x3f)));
+    }
+    else if (c < 0x10000)
+    {
+      dest.push_back((char)(0xe0 | (c >> 12)));
+      dest.push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+      dest.push_back((char)(0x80 | (c & 0x3f)));
+    }
+    else if (c <= 0x10ffff)
+    {
+      dest.push_back((char)(0xf0 | (c >> 18)));
+      dest.push_back((char)(0x80 | ((c >> 12) & 0x3f)));
+      dest.push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+      dest.push_back((char)(0x80 | (c & 0x3f)));
+    }
+    else
+      return false;
+  }
+
+  strDest = dest.c_str();
+  return true;
+}
+
 using namespace std;
 
 static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
@@ -388,17 +626,18 @@ void CCharsetConverter::reset(void)
 {
   CSingleLock lock(m_critSection);
 
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToFontCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvSubtitleCharsetToW);
-  ICONV_SAFE_CLOSE(m_iconvWtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16BEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16LEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf32ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8toW);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToUtf8);
+  m_iconvStringCharsetToFontCharset.Reset();
+  m_iconvUtf8ToStringCharset.Reset();
+  m_iconvStringCharsetToUtf8.Reset();
+  m_iconvUcs2CharsetToStringCharset.Reset();
+  m_iconvSubtitleCharsetToW.Reset();
+  m_iconvWtoUtf8.Reset();
+  m_iconvUtf16BEtoUtf8.Reset();
+  m_iconvUtf16LEtoUtf8.Reset();
+  m_iconvUtf32ToStringCharset.Reset();
+  m_iconvUtf8toW.Reset();
+  m_iconvUcs2CharsetToUtf8.Reset();
+  m_iconvUtf16LEtoW.Reset();
 
 
   m_stringFribidiCharset = FRIBIDI_NOTFOUND;
@@ -416,25 +655,27 @@ void CCharsetConverter::reset(void)
 void CCharsetConverter::utf8ToW(const CStdStringA& utf8String, CStdStringW &wString, bool bVisualBiDiFlip/*=true*/, bool forceLTRReadingOrder /*=false*/, bool* bWasFlipped/*=NULL*/)
 {
   // Try to flip hebrew/arabic characters, if any
-  if (bVisualBiDiFlip)
+  if (bVisualBiDiFlip && !isAsciiLine(utf8String))
   {
     CStdStringA strFlipped;
     FriBidiCharType charset = forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF;
     logicalToVisualBiDi(utf8String, strFlipped, FRIBIDI_UTF8, charset, bWasFlipped);
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
+    if (!utf8ToWFast(strFlipped, wString))
+      convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
+    return;
   }
-  else
-  {
-    CSingleLock lock(m_critSection);
+
+  // a single line of plain ASCII has nothing to flip
+  if (bVisualBiDiFlip && bWasFlipped)
+    *bWasFlipped = false;
+
+  if (!utf8ToWFast(utf8String, wString))
     convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
-  }
 }
 
 void CCharsetConverter::subtitleCharsetToW(const CStdStringA& strSource, CStdStringW& strDest)
 {
   // No need to flip hebrew/arabic as mplayer does the flipping
-  CSingleLock lock(m_critSection);
   convert(m_iconvSubtitleCharsetToW,sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
 }
 
@@ -458,7 +699,6 @@ void CCharsetConverter::toW(const CStdStringA& strSource,
 
 void CCharsetConverter::utf8ToStringCharset(const CStdStringA& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
   convert(m_iconvUtf8ToStringCharset,1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
 }
 
@@ -520,21 +760,19 @@ void CCharsetConverter::unknownToUTF8(const CStdStringA &source, CStdStringA &de
   if (isValidUtf8(source))
     dest = source;
   else
-  {
-    CSingleLock lock(m_critSection);
     convert(m_iconvStringCharsetToUtf8, UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
-  }
 }
 
 void CCharsetConverter::wToUTF8(const CStdStringW& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
+  if (wToUTF8Fast(strSource, strDest))
+    return;
+
   convert(m_iconvWtoUtf8,UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
 }
 
 void CCharsetConverter::utf16BEtoUTF8(const CStdString16& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
   if(!convert_checked(m_iconvUtf16BEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
     strDest.clear();
 }
@@ -542,21 +780,18 @@ void CCharsetConverter::utf16BEtoUTF8(const CStdString16& strSource, CStdStringA
 void CCharsetConverter::utf16LEtoUTF8(const CStdString16& strSource,
                                       CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
   if(!convert_checked(m_iconvUtf16LEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::ucs2ToUTF8(const CStdString16& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
   if(!convert_checked(m_iconvUcs2CharsetToUtf8,UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoW(const CStdString16& strSource, CStdStringW &strDest)
 {
-  CSingleLock lock(m_critSection);
   if(!convert_checked(m_iconvUtf16LEtoW,sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
     strDest.clear();
 }
@@ -578,22 +813,22 @@ void CCharsetConverter::ucs2CharsetToStringCharset(const CStdStringW& strSource,
       s++;
     }
   }
-  CSingleLock lock(m_critSection);
   convert(m_iconvUcs2CharsetToStringCharset,4,"UTF-16LE",
           g_langInfo.GetGuiCharSet(),strCopy,strDest);
 }
 
 void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
+  unsigned int generation;
+  iconv_t iconvString = m_iconvUtf32ToStringCharset.Acquire(generation);
 
-  if (m_iconvUtf32ToStringCharset == (iconv_t) - 1)
+  if (iconvString == (iconv_t) - 1)
   {
     CStdString strCharset=g_langInfo.GetGuiCharSet();
-    m_iconvUtf32ToStringCharset = iconv_open(strCharset.c_str(), "UTF-32LE");
+    iconvString = iconv_open(strCharset.c_str(), "UTF-32LE");
   }
 
-  if (m_iconvUtf32ToStringCharset != (iconv_t) - 1)
+  if (iconvString != (iconv_t) - 1)
   {
     const unsigned long* ptr=strSource;
     while (*ptr) ptr++;
@@ -603,24 +838,23 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
     char *dst = strDest.GetBuffer(inBytes);
     size_t outBytes = inBytes;
 
-    if (iconv_const(m_iconvUtf32ToStringCharset, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
+    if (iconv_const(iconvString, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
       strDest.ReleaseBuffer();
       strDest = (const char *)strSource;
-      return;
     }
-
-    if (iconv(m_iconvUtf32ToStringCharset, NULL, NULL, &dst, &outBytes) == (size_t)-1)
+    else if (iconv(iconvString, NULL, NULL, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed cleanup", __FUNCTION__);
       strDest.ReleaseBuffer();
       strDest = (const char *)strSource;
-      return;
     }
-
-    strDest.ReleaseBuffer();
+    else
+      strDest.ReleaseBuffer();
   }
+
+  m_iconvUtf32ToStringCharset.Release(iconvString, generation);
 }
 
 void CCharsetConverter::utf8ToSystem(CStdStringA& strSourceDest)
@@ -639,6 +873,13 @@ bool CCharsetConverter::isValidUtf8(const char *buf, unsigned int len)
 
   while ((unsigned char*)buf != endbuf)
   {
+    if (!trailing && (*buf & 0x80) == 0)
+    {
+      // skip over runs of plain ASCII in bulk
+      buf += asciiPrefixLength((const unsigned char*)buf, endbuf - (const unsigned char*)buf);
+      continue;
+    }
+
     c = *buf++;
     if (trailing)
       if ((c & 0xc0) == 0x80) // does trailing byte follow UTF-8 format ?
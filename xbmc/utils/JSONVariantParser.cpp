@@ -186,15 +186,24 @@ int CJSONVariantParser::ParseArrayEnd(void * ctx)
 
 void CJSONVariantParser::PushObject(CVariant variant)
 {
+  PARSE_STATUS status = ParseVariable;
+  if (variant.isObject())
+    status = ParseObject;
+  else if (variant.isArray())
+    status = ParseArray;
+
+  // hand the value over with swap() rather than copying it into the tree
   if (m_status == ParseObject)
   {
-    (*m_parse[m_parse.size() - 1])[m_key] = variant;
-    m_parse.push_back(&(*m_parse[m_parse.size() - 1])[m_key]);
+    CVariant *temp = &(*m_parse[m_parse.size() - 1])[m_key];
+    temp->swap(variant);
+    m_parse.push_back(temp);
   }
   else if (m_status == ParseArray)
   {
     CVariant *temp = m_parse[m_parse.size() - 1];
-    temp->push_back(variant);
+    temp->push_back(CVariant::VariantTypeNull);
+    (*temp)[temp->size() - 1].swap(variant);
     m_parse.push_back(&(*temp)[temp->size() - 1]);
   }
   else if (m_parse.size() == 0)
@@ -202,12 +211,7 @@ void CJSONVariantParser::PushObject(CVariant variant)
     m_parse.push_back(new CVariant(variant));
   }
 
-  if (variant.isObject())
-    m_status = ParseObject;
-  else if (variant.isArray())
-    m_status = ParseArray;
-  else
-    m_status = ParseVariable;
+  m_status = status;
 }
 
 void CJSONVariantParser::PopObject()
@@ -39,7 +39,7 @@ public:
 class CSimpleParseCallback : public IParseCallback
 {
 public:
-  virtual void onParsed(CVariant *variant) { m_parsed = *variant; }
+  virtual void onParsed(CVariant *variant) { m_parsed.swap(*variant); }
   CVariant &GetOutput() { return m_parsed; }
 
 private:
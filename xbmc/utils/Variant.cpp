@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sstream>
+#include <new>
 
 #include "Variant.h"
 
@@ -129,10 +130,10 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new string();
+      new (m_data.string) string;
       break;
     case VariantTypeWideString:
-      m_data.wstring = new wstring();
+      new (m_data.wstring) wstring;
       break;
     case VariantTypeArray:
       m_data.array = new VariantArray();
@@ -191,37 +192,37 @@ CVariant::CVariant(bool boolean)
 CVariant::CVariant(const char *str)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str);
+  new (m_data.string) string(str);
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str, length);
+  new (m_data.string) string(str, length);
 }
 
 CVariant::CVariant(const string &str)
 {
   m_type = VariantTypeString;
-  m_data.string = new string(str);
+  new (m_data.string) string(str);
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new wstring(str);
+  new (m_data.wstring) wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new wstring(str, length);
+  new (m_data.wstring) wstring(str, length);
 }
 
 CVariant::CVariant(const wstring &str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new wstring(str);
+  new (m_data.wstring) wstring(str);
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
@@ -247,9 +248,9 @@ CVariant::~CVariant()
 void CVariant::cleanup()
 {
   if (m_type == VariantTypeString)
-    delete m_data.string;
+    stringData()->~string();
   else if (m_type == VariantTypeWideString)
-    delete m_data.wstring;
+    wstringData()->~wstring();
   else if (m_type == VariantTypeArray)
     delete m_data.array;
   else if (m_type == VariantTypeObject)
@@ -318,9 +319,9 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(*stringData(), fallback);
     case VariantTypeWideString:
-      return str2int64(*m_data.wstring, fallback);
+      return str2int64(*wstringData(), fallback);
     default:
       return fallback;
   }
@@ -339,9 +340,9 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(*stringData(), fallback);
     case VariantTypeWideString:
-      return str2uint64(*m_data.wstring, fallback);
+      return str2uint64(*wstringData(), fallback);
     default:
       return fallback;
   }
@@ -360,9 +361,9 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(*stringData(), fallback);
     case VariantTypeWideString:
-      return str2double(*m_data.wstring, fallback);
+      return str2double(*wstringData(), fallback);
     default:
       return fallback;
   }
@@ -381,9 +382,9 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(*stringData(), fallback);
     case VariantTypeWideString:
-      return (float)str2double(*m_data.wstring, fallback);
+      return (float)str2double(*wstringData(), fallback);
     default:
       return fallback;
   }
@@ -404,11 +405,11 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+      if (stringData()->empty() || stringData()->compare("0") == 0 || stringData()->compare("false") == 0)
         return false;
       return true;
     case VariantTypeWideString:
-      if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
+      if (wstringData()->empty() || wstringData()->compare(L"0") == 0 || wstringData()->compare(L"false") == 0)
         return false;
       return true;
     default:
@@ -423,7 +424,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return *stringData();
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -451,7 +452,7 @@ std::wstring CVariant::asWideString(const std::wstring &fallback /* = L"" */) co
   switch (m_type)
   {
     case VariantTypeWideString:
-      return *m_data.wstring;
+      return *wstringData();
     case VariantTypeBoolean:
       return m_data.boolean ? L"true" : L"false";
     case VariantTypeInteger:
@@ -516,7 +517,7 @@ const CVariant &CVariant::operator[](unsigned int position) const
 
 CVariant &CVariant::operator=(const CVariant &rhs)
 {
-  if (m_type == VariantTypeConstNull)
+  if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
   cleanup();
@@ -538,10 +539,10 @@ CVariant &CVariant::operator=(const CVariant &rhs)
     m_data.dvalue = rhs.m_data.dvalue;
     break;
   case VariantTypeString:
-    m_data.string = new string(*rhs.m_data.string);
+    new (m_data.string) string(*rhs.stringData());
     break;
   case VariantTypeWideString:
-    m_data.wstring = new wstring(*rhs.m_data.wstring);
+    new (m_data.wstring) wstring(*rhs.wstringData());
     break;
   case VariantTypeArray:
     m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
@@ -571,9 +572,9 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return *stringData() == *rhs.stringData();
     case VariantTypeWideString:
-      return *m_data.wstring == *rhs.m_data.wstring;
+      return *wstringData() == *rhs.wstringData();
     case VariantTypeArray:
       return *m_data.array == *rhs.m_data.array;
     case VariantTypeObject:
@@ -595,7 +596,21 @@ void CVariant::push_back(const CVariant &variant)
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(variant);
+  {
+    VariantArray &array = *m_data.array;
+    if (array.size() == array.capacity())
+    {
+      // letting the vector grow itself would deep copy every element,
+      // hand them over to the bigger one with swap() instead
+      VariantArray grown;
+      grown.reserve(array.empty() ? 4 : array.size() * 2);
+      grown.resize(array.size());
+      for (unsigned int index = 0; index < array.size(); index++)
+        grown[index].swap(array[index]);
+      array.swap(grown);
+    }
+    array.push_back(variant);
+  }
 }
 
 void CVariant::append(const CVariant &variant)
@@ -606,21 +621,42 @@ void CVariant::append(const CVariant &variant)
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData()->c_str();
   else
     return NULL;
 }
 
 void CVariant::swap(CVariant &rhs)
 {
-  VariantType  temp_type = m_type;
-  VariantUnion temp_data = m_data;
-
-  m_type = rhs.m_type;
-  m_data = rhs.m_data;
+  CVariant temp;
+  temp.takeFrom(*this);
+  takeFrom(rhs);
+  rhs.takeFrom(temp);
+}
 
-  rhs.m_type = temp_type;
-  rhs.m_data = temp_data;
+void CVariant::takeFrom(CVariant &variant)
+{
+  // only ever called on a null variant, so nothing needs cleaning up here.
+  // arrays and objects are handed over by pointer, strings can't be copied
+  // bitwise as they may point into themselves so they are swapped instead
+  m_type = variant.m_type;
+  switch (m_type)
+  {
+  case VariantTypeString:
+    new (m_data.string) string;
+    stringData()->swap(*variant.stringData());
+    variant.cleanup();
+    break;
+  case VariantTypeWideString:
+    new (m_data.wstring) wstring;
+    wstringData()->swap(*variant.wstringData());
+    variant.cleanup();
+    break;
+  default:
+    m_data = variant.m_data;
+    variant.m_type = VariantTypeNull;
+    break;
+  }
 }
 
 CVariant::iterator_array CVariant::begin_array()
@@ -694,9 +730,9 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringData()->size();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->size();
+    return wstringData()->size();
   else
     return 0;
 }
@@ -708,9 +744,9 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringData()->empty();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->empty();
+    return wstringData()->empty();
   else
     return true;
 }
@@ -722,9 +758,9 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+    stringData()->clear();
   else if (m_type == VariantTypeWideString)
-    m_data.wstring->clear();
+    wstringData()->clear();
 }
 
 void CVariant::erase(const std::string &key)
@@ -134,14 +134,24 @@ public:
 
 private:
   void cleanup();
+  void takeFrom(CVariant &variant);
+
+  // strings are constructed in place inside the union instead of being
+  // heap allocated, short ones then don't allocate at all
+  std::string *stringData() { return reinterpret_cast<std::string *>(m_data.string); }
+  const std::string *stringData() const { return reinterpret_cast<const std::string *>(m_data.string); }
+  std::wstring *wstringData() { return reinterpret_cast<std::wstring *>(m_data.wstring); }
+  const std::wstring *wstringData() const { return reinterpret_cast<const std::wstring *>(m_data.wstring); }
+
   union VariantUnion
   {
     int64_t integer;
     uint64_t unsignedinteger;
     bool boolean;
     double dvalue;
-    std::string *string;
-    std::wstring *wstring;
+    void *alignment;
+    char string[sizeof(std::string)];
+    char wstring[sizeof(std::wstring)];
     VariantArray *array;
     VariantMap *map;
   };
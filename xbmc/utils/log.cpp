@@ -22,6 +22,7 @@
 #include "log.h"
 #include "stdio_utf8.h"
 #include "stat_utf8.h"
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
@@ -34,14 +35,55 @@
 
 #define critSec XBMC_GLOBAL_USE(CLog::CLogGlobals).critSec
 #define m_file XBMC_GLOBAL_USE(CLog::CLogGlobals).m_file
+#define m_bOpen XBMC_GLOBAL_USE(CLog::CLogGlobals).m_bOpen
 #define m_repeatCount XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatCount
 #define m_repeatLogLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLogLevel
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
+#define m_queue XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queue
+#define m_queueLength XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queueLength
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
+#define m_writeEvent XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writeEvent
+#define m_path XBMC_GLOBAL_USE(CLog::CLogGlobals).m_path
+#define m_fileSize XBMC_GLOBAL_USE(CLog::CLogGlobals).m_fileSize
+#define m_maxFileSize XBMC_GLOBAL_USE(CLog::CLogGlobals).m_maxFileSize
+
+/* queued lines are written this long after the first of them, or as soon as this many are queued */
+#define LOG_WRITE_INTERVAL   100
+#define LOG_WRITE_QUEUE_SIZE 64
 
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
+struct CLog::LogLine
+{
+  LogLine*   next;
+  SYSTEMTIME time;
+  uint64_t   threadId;
+  int        logLevel;
+  CStdString data;
+};
+
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("CLogWriter") {}
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      /* sleep until a line is queued, then give more lines a moment to come in */
+      if (m_queueLength == 0)
+        AbortableWait(m_writeEvent);
+      if (m_queueLength < LOG_WRITE_QUEUE_SIZE)
+        AbortableWait(m_writeEvent, LOG_WRITE_INTERVAL);
+      CLog::WriteQueue();
+    }
+  }
+};
+
 CLog::CLog()
 {}
 
@@ -50,8 +92,10 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  
+  StopWriter();
+
   CSingleLock waitLock(critSec);
+  m_bOpen = false;
   if (m_file)
   {
     fclose(m_file);
@@ -60,78 +104,166 @@ void CLog::Close()
   m_repeatLine.clear();
 }
 
+void CLog::StopWriter()
+{
+  /* the writer has to be stopped without holding the lock, it needs it to write */
+  CLogWriter* writer;
+  {
+    CSingleLock waitLock(critSec);
+    writer = m_writer;
+    m_writer = NULL;
+  }
+  if (writer)
+  {
+    writer->StopThread();
+    delete writer;
+  }
+
+  /* lines logged from now on are written by the callers */
+  WriteQueue();
+}
+
 void CLog::Log(int loglevel, const char *format, ... )
 {
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
+  /* nothing is formatted or locked for lines that aren't written anyway */
 #if !(defined(_DEBUG) || defined(PROFILE))
-  if (m_logLevel > LOG_LEVEL_NORMAL ||
-     (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
+  if (!(m_logLevel > LOG_LEVEL_NORMAL ||
+       (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE)))
+    return;
 #endif
+  if (!m_bOpen)
+    return;
+
+  LogLine* line = new LogLine;
+  GetLocalTime(&line->time);
+  line->threadId = (uint64_t)CThread::GetCurrentThreadId();
+  line->logLevel = loglevel;
+
+  va_list va;
+  va_start(va, format);
+  line->data.FormatV(format, va);
+  va_end(va);
+
+  /* push the line on the queue without locking. lines are only removed by WriteQueue(),
+     which always takes the whole queue, so a push can't link to a line that is gone */
+  do
+  {
+    line->next = (LogLine*)m_queue;
+  } while (cas(&m_queue, (long)line->next, (long)line) != (long)line->next);
+  long queueLength = AtomicIncrement(&m_queueLength);
+
+  /* errors are written right away, so they are in the log if the application crashes next */
+  if (!m_writer || loglevel >= LOGERROR)
+    WriteQueue();
+  else if (queueLength == 1 || queueLength >= LOG_WRITE_QUEUE_SIZE)
+    m_writeEvent.Set();
+}
+
+void CLog::WriteQueue()
+{
+  CSingleLock waitLock(critSec);
+
+  /* take all queued lines and restore the order they were logged in */
+  long queue;
+  do
   {
-    if (!m_file)
-      return;
+    queue = m_queue;
+  } while (cas(&m_queue, queue, 0) != queue);
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
+  LogLine* lines = NULL;
+  long count = 0;
+  for (LogLine* line = (LogLine*)queue; line; count++)
+  {
+    LogLine* next = line->next;
+    line->next = lines;
+    lines = line;
+    line = next;
+  }
 
-    CStdString strPrefix, strData;
+  if (!count)
+    return;
+  AtomicSubtract(&m_queueLength, count);
 
-    strData.reserve(16384);
-    va_list va;
-    va_start(va, format);
-    strData.FormatV(format,va);
-    va_end(va);
+  while (lines)
+  {
+    LogLine* next = lines->next;
+    if (m_file)
+      WriteLine(*lines);
+    delete lines;
+    lines = next;
+  }
 
-    if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
-    {
-      m_repeatCount++;
-      return;
-    }
-    else if (m_repeatCount)
-    {
-      CStdString strData2;
-      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[m_repeatLogLevel]);
-
-      strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
-      fputs(strPrefix.c_str(), m_file);
-      fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
-      m_repeatCount = 0;
-    }
-    
-    m_repeatLine      = strData;
-    m_repeatLogLevel  = loglevel;
+  if (!m_file)
+    return;
+  fflush(m_file);
 
-    unsigned int length = 0;
-    while ( length != strData.length() )
+  if (m_maxFileSize > 0 && m_fileSize >= m_maxFileSize)
+  {
+    fclose(m_file);
+    m_file = NULL;
+    if (OpenFile(true))
     {
-      length = strData.length();
-      strData.TrimRight(" ");
-      strData.TrimRight('\n');
-      strData.TrimRight("\r");
+      unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
+      fwrite(BOM, sizeof(BOM), 1, m_file);
     }
+  }
+}
+
+void CLog::WriteLine(const LogLine& line)
+{
+  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
+
+  CStdString strPrefix, strData(line.data);
+
+  if (m_repeatLogLevel == line.logLevel && m_repeatLine == strData)
+  {
+    m_repeatCount++;
+    return;
+  }
+  else if (m_repeatCount)
+  {
+    CStdString strData2;
+    strPrefix.Format(prefixFormat, line.time.wHour, line.time.wMinute, line.time.wSecond, line.threadId, levelNames[m_repeatLogLevel]);
 
-    if (!length)
-      return;
-    
-    OutputDebugString(strData);
+    strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
+    fputs(strPrefix.c_str(), m_file);
+    fputs(strData2.c_str(), m_file);
+    m_fileSize += strPrefix.length() + strData2.length();
+    OutputDebugString(strData2);
+    m_repeatCount = 0;
+  }
 
-    /* fixup newline alignment, number of spaces should equal prefix length */
-    strData.Replace("\n", LINE_ENDING"                                            ");
-    strData += LINE_ENDING;
+  m_repeatLine      = strData;
+  m_repeatLogLevel  = line.logLevel;
 
-    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[loglevel]);
+  unsigned int length = 0;
+  while ( length != strData.length() )
+  {
+    length = strData.length();
+    strData.TrimRight(" ");
+    strData.TrimRight('\n');
+    strData.TrimRight("\r");
+  }
+
+  if (!length)
+    return;
+
+  OutputDebugString(strData);
+
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  strData.Replace("\n", LINE_ENDING"                                            ");
+  strData += LINE_ENDING;
+
+  strPrefix.Format(prefixFormat, line.time.wHour, line.time.wMinute, line.time.wSecond, line.threadId, levelNames[line.logLevel]);
 
 //print to adb
 #if defined(TARGET_ANDROID) && defined(_DEBUG)
   CXBMCApp::android_printf("%s%s",strPrefix.c_str(), strData.c_str());
 #endif
 
-    fputs(strPrefix.c_str(), m_file);
-    fputs(strData.c_str(), m_file);
-    fflush(m_file);
-  }
+  fputs(strPrefix.c_str(), m_file);
+  fputs(strData.c_str(), m_file);
+  m_fileSize += strPrefix.length() + strData.length();
 }
 
 bool CLog::Init(const char* path)
@@ -141,36 +273,93 @@ bool CLog::Init(const char* path)
   {
     // g_settings.m_logFolder is initialized in the CSettings constructor
     // and changed in CApplication::Create()
-    CStdString strLogFile, strLogFileOld;
+    m_path = path;
+    if (!OpenFile(false))
+      return false;
+  }
+
+  if (m_file)
+  {
+    unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
+    fwrite(BOM, sizeof(BOM), 1, m_file);
+  }
+
+  if (m_file && !m_writer)
+  {
+    m_writer = new CLogWriter();
+    m_writer->Create();
+  }
+
+  m_bOpen = m_file != NULL;
+  return m_file != NULL;
+}
+
+bool CLog::OpenFile(bool bRotate)
+{
+  CStdString strLogFile, strLogFileOld, strLogFileFirst, strLogFileLast;
 
-    strLogFile.Format("%sxbmc.log", path);
-    strLogFileOld.Format("%sxbmc.old.log", path);
+  strLogFile.Format("%sxbmc.log", m_path.c_str());
+  strLogFileFirst.Format("%sxbmc.log.1", m_path.c_str());
+  strLogFileLast.Format("%sxbmc.log.2", m_path.c_str());
 
 #if defined(TARGET_WINDOWS)
-    // the appdata folder might be redirected to an unc share
-    // convert smb to unc path that stat and fopen can handle it
-    strLogFile = CWIN32Util::SmbToUnc(strLogFile);
-    strLogFileOld = CWIN32Util::SmbToUnc(strLogFileOld);
+  // the appdata folder might be redirected to an unc share
+  // convert smb to unc path that stat and fopen can handle it
+  strLogFile = CWIN32Util::SmbToUnc(strLogFile);
+  strLogFileFirst = CWIN32Util::SmbToUnc(strLogFileFirst);
+  strLogFileLast = CWIN32Util::SmbToUnc(strLogFileLast);
 #endif
 
-    struct stat64 info;
-    if (stat64_utf8(strLogFileOld.c_str(),&info) == 0 &&
-        remove_utf8(strLogFileOld.c_str()) != 0)
-      return false;
-    if (stat64_utf8(strLogFile.c_str(),&info) == 0 &&
-        rename_utf8(strLogFile.c_str(),strLogFileOld.c_str()) != 0)
-      return false;
+  struct stat64 info;
+  if (bRotate)
+  {
+    /* the first part of the session keeps the startup header in xbmc.log.1,
+       later parts replace each other in xbmc.log.2 */
+    if (stat64_utf8(strLogFileFirst.c_str(),&info) == 0)
+      strLogFileOld = strLogFileLast;
+    else
+      strLogFileOld = strLogFileFirst;
+  }
+  else
+  {
+    strLogFileOld.Format("%sxbmc.old.log", m_path.c_str());
+#if defined(TARGET_WINDOWS)
+    strLogFileOld = CWIN32Util::SmbToUnc(strLogFileOld);
+#endif
 
-    m_file = fopen64_utf8(strLogFile.c_str(),"wb");
+    /* parts of the previous session's log, its end is kept in xbmc.old.log */
+    if (stat64_utf8(strLogFileFirst.c_str(),&info) == 0)
+      remove_utf8(strLogFileFirst.c_str());
+    if (stat64_utf8(strLogFileLast.c_str(),&info) == 0)
+      remove_utf8(strLogFileLast.c_str());
   }
 
-  if (m_file)
+  bool bMoved = true;
+  if (stat64_utf8(strLogFileOld.c_str(),&info) == 0 &&
+      remove_utf8(strLogFileOld.c_str()) != 0)
+    bMoved = false;
+  else if (stat64_utf8(strLogFile.c_str(),&info) == 0 &&
+      rename_utf8(strLogFile.c_str(),strLogFileOld.c_str()) != 0)
+    bMoved = false;
+
+  if (!bMoved && !bRotate)
+    return false;
+
+  /* if the log can't be rotated, keep writing to it rather than losing the rest of the session */
+  m_file = fopen64_utf8(strLogFile.c_str(), bMoved ? "wb" : "ab");
+  m_fileSize = 0;
+
+  if (m_file && !bMoved)
   {
-    unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
-    fwrite(BOM, sizeof(BOM), 1, m_file);
+    LogLine line;
+    GetLocalTime(&line.time);
+    line.threadId = (uint64_t)CThread::GetCurrentThreadId();
+    line.logLevel = LOGERROR;
+    line.data.Format("CLog::OpenFile - unable to move the log to %s, continuing in this file", strLogFileOld.c_str());
+    WriteLine(line);
   }
 
-  return m_file != NULL;
+  return m_file != NULL && bMoved;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -218,6 +407,12 @@ int CLog::GetLogLevel()
   return m_logLevel;
 }
 
+void CLog::SetMaxFileSize(unsigned int size)
+{
+  CSingleLock waitLock(critSec);
+  m_maxFileSize = size;
+}
+
 void CLog::OutputDebugString(const std::string& line)
 {
 #if defined(_DEBUG) || defined(PROFILE)
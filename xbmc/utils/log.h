@@ -25,6 +25,7 @@
 
 #include "commons/ilog.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "utils/GlobalsHandling.h"
 
 #ifdef __GNUC__
@@ -33,6 +34,8 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
@@ -40,13 +43,22 @@ public:
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG) {}
+    CLogGlobals() : m_file(NULL), m_bOpen(false), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG),
+      m_queue(0), m_queueLength(0), m_writer(NULL), m_fileSize(0), m_maxFileSize(0) {}
     FILE*       m_file;
+    volatile bool m_bOpen;       // true from Init() until Close(), also while the file is being rotated
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
     CCriticalSection critSec;
+    volatile long m_queue;       // lines that weren't written yet, newest first. only changed with cas()
+    volatile long m_queueLength;
+    CLogWriter* m_writer;        // thread that writes the queued lines, NULL if the callers write them
+    CEvent      m_writeEvent;
+    std::string m_path;
+    unsigned int m_fileSize;
+    unsigned int m_maxFileSize; // size at which the log is moved to xbmc.log.1 or xbmc.log.2, 0 to never do that
   };
 
   CLog();
@@ -57,7 +69,15 @@ public:
   static bool Init(const char* path);
   static void SetLogLevel(int level);
   static int  GetLogLevel();
+  static void SetMaxFileSize(unsigned int size);
+  static void StopWriter();
 private:
+  friend class CLogWriter;
+  struct LogLine;
+
+  static bool OpenFile(bool bRotate);
+  static void WriteQueue();
+  static void WriteLine(const LogLine& line);
   static void OutputDebugString(const std::string& line);
 };
 
@@ -20,6 +20,8 @@
 
 #include "settings/GUISettings.h"
 #include "utils/CharsetConverter.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 
 #include "gtest/gtest.h"
 
@@ -122,6 +124,29 @@ TEST_F(TestCharsetConverter, utf8ToW)
   EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
 }
 
+TEST_F(TestCharsetConverter, utf8ToW_NonBMP)
+{
+  refstra1 = "ｔｅｓｔ＿🐭🐮";
+  refstrw1 = L"ｔｅｓｔ＿🐭🐮";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+
+  varstra1.clear();
+  g_charsetConverter.wToUTF8(varstrw1, varstra1);
+  EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_Invalid)
+{
+  /* invalid sequences are handed to iconv, which skips them */
+  refstra1 = "test\xc0\x80utf8ToW";
+  refstrw1 = L"testutf8ToW";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+}
+
 TEST_F(TestCharsetConverter, utf16LEtoW)
 {
   refstrw1 = L"ｔｅｓｔ＿ｕｔｆ１６ＬＥｔｏｗ";
@@ -229,6 +254,21 @@ TEST_F(TestCharsetConverter, isValidUtf8_4)
                                               sizeof(refutf16LE3)));
 }
 
+TEST_F(TestCharsetConverter, isValidUtf8_LongAscii)
+{
+  /* long enough to exercise the bulk ASCII scan on either side of the
+   * multibyte characters */
+  refstra1 = "A long plain ASCII prefix for the bulk scan - "
+             "ｔｅｓｔ＿ｉｓＶａｌｉｄＵｔｆ８ - and an ASCII tail as well";
+  EXPECT_TRUE(g_charsetConverter.isValidUtf8(refstra1));
+
+  refstra1 = "A long plain ASCII prefix for the bulk scan - \xe2\x82";
+  EXPECT_FALSE(g_charsetConverter.isValidUtf8(refstra1));
+
+  refstra1 = "A long plain ASCII prefix for the bulk scan - \xe9t\xe9";
+  EXPECT_FALSE(g_charsetConverter.isValidUtf8(refstra1));
+}
+
 /* TODO: Resolve correct input/output for this function */
 // TEST_F(TestCharsetConverter, ucs2CharsetToStringCharset)
 // {
@@ -393,3 +433,54 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+class CharsetConverterWorker : public IRunnable
+{
+public:
+  CharsetConverterWorker() : mismatches(0) {}
+
+  virtual void Run()
+  {
+    CStdStringA utf8 = "ｔｅｓｔ＿ｔｈｒｏｕｇｈｐｕｔ plain ascii";
+    CStdStringW wide;
+    CStdStringA back;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+      g_charsetConverter.utf8ToW(utf8, wide, false);
+      g_charsetConverter.wToUTF8(wide, back);
+      if (back != utf8)
+        mismatches++;
+
+      /* goes through the pooled iconv handles */
+      g_charsetConverter.subtitleCharsetToW(utf8, wide);
+    }
+  }
+
+  static const unsigned int iterations = 20000;
+  unsigned int mismatches;
+};
+
+TEST_F(TestCharsetConverter, Throughput)
+{
+  const unsigned int numThreads = 4;
+  CharsetConverterWorker workers[numThreads];
+  CThread *threads[numThreads];
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < numThreads; i++)
+  {
+    threads[i] = new CThread(&workers[i], "CharsetConverterWorker");
+    threads[i]->Create();
+  }
+  for (unsigned int i = 0; i < numThreads; i++)
+  {
+    threads[i]->WaitForThreadExit((unsigned int)-1);
+    delete threads[i];
+    EXPECT_EQ(0U, workers[i].mismatches);
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  std::cout << "Conversions: " <<
+    testing::PrintToString(numThreads * CharsetConverterWorker::iterations * 3) <<
+    " in " << testing::PrintToString(elapsed) << " ms\n";
+}
@@ -19,6 +19,8 @@
  */
 
 #include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
@@ -31,3 +33,33 @@ TEST(TestJSONVariantParser, Parse)
   variant = CJSONVariantParser::Parse(buf, sizeof(buf));
   EXPECT_TRUE(variant.isNull());
 }
+
+TEST(TestJSONVariantParser, Benchmark)
+{
+  const unsigned int items = 10000;
+  CVariant response;
+  for (unsigned int i = 0; i < items; i++)
+  {
+    CVariant song;
+    song["songid"] = i;
+    song["label"] = "Some Song Title";
+    song["file"] = "smb://server/music/Some Artist/Some Album/01 - Some Song Title.flac";
+    song["artist"].push_back("Some Artist");
+    song["duration"] = 241;
+    response["songs"].push_back(song);
+  }
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  std::string json = CJSONVariantWriter::Write(response, true);
+  unsigned int written = XbmcThreads::SystemClockMillis();
+  CVariant parsed = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+  unsigned int parsedTime = XbmcThreads::SystemClockMillis();
+
+  ASSERT_EQ(items, parsed["songs"].size());
+  EXPECT_STREQ("Some Song Title", parsed["songs"][items - 1]["label"].c_str());
+
+  std::cout << "Serialize " << testing::PrintToString(items) << " items: " <<
+    testing::PrintToString(written - start) << " ms\n";
+  std::cout << "Parse " << testing::PrintToString(items) << " items: " <<
+    testing::PrintToString(parsedTime - written) << " ms\n";
+}
@@ -19,6 +19,7 @@
  */
 
 #include "utils/Variant.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
@@ -323,3 +324,58 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+TEST(TestVariant, swapStrings)
+{
+  CVariant a("a short string"), b((int)1);
+  a.swap(b);
+  EXPECT_TRUE(a.isInteger());
+  EXPECT_EQ((int64_t)1, a.asInteger());
+  EXPECT_STREQ("a short string", b.c_str());
+
+  CVariant c(L"a wide string that is too long for any small string buffer");
+  b.swap(c);
+  EXPECT_STREQ(L"a wide string that is too long for any small string buffer",
+               b.asWideString().c_str());
+  EXPECT_STREQ("a short string", c.c_str());
+}
+
+static void FillLibraryResponse(CVariant &response, unsigned int items)
+{
+  for (unsigned int i = 0; i < items; i++)
+  {
+    CVariant song;
+    song["songid"] = i;
+    song["label"] = "Some Song Title";
+    song["file"] = "smb://server/music/Some Artist/Some Album/01 - Some Song Title.flac";
+    song["artist"].push_back("Some Artist");
+    song["genre"].push_back("Rock");
+    song["year"] = 1999;
+    song["rating"] = 3;
+    song["duration"] = 241;
+    response["songs"].push_back(song);
+  }
+  response["limits"]["start"] = 0;
+  response["limits"]["end"] = items;
+  response["limits"]["total"] = items;
+}
+
+TEST(TestVariant, Benchmark)
+{
+  const unsigned int items = 10000;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CVariant response;
+  FillLibraryResponse(response, items);
+  unsigned int built = XbmcThreads::SystemClockMillis();
+  CVariant copy(response);
+  unsigned int copied = XbmcThreads::SystemClockMillis();
+
+  EXPECT_EQ(items, copy["songs"].size());
+  EXPECT_TRUE(copy == response);
+
+  std::cout << "Build " << testing::PrintToString(items) << " items: " <<
+    testing::PrintToString(built - start) << " ms\n";
+  std::cout << "Copy " << testing::PrintToString(items) << " items: " <<
+    testing::PrintToString(copied - built) << " ms\n";
+}
@@ -20,13 +20,18 @@
 
 #include "utils/log.h"
 #include "utils/RegExp.h"
+#include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 
 #include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+
 class Testlog : public testing::Test
 {
 protected:
@@ -35,10 +40,30 @@ protected:
   {
     /* Reset globals used by CLog after each test. */
     g_log_globalsRef->m_file = NULL;
+    g_log_globalsRef->m_bOpen = false;
     g_log_globalsRef->m_repeatCount = 0;
     g_log_globalsRef->m_repeatLogLevel = -1;
     g_log_globalsRef->m_logLevel = LOG_LEVEL_DEBUG;
+    g_log_globalsRef->m_maxFileSize = 0;
+  }
+};
+
+#define LOG_THREADS           4
+#define LOG_LINES_PER_THREAD  5000
+
+class LogRunner : public IRunnable
+{
+public:
+  LogRunner(int id) : m_id(id) {}
+
+  virtual void Run()
+  {
+    for (int i = 0; i < LOG_LINES_PER_THREAD; i++)
+      CLog::Log(LOGDEBUG, "runner %d line %d", m_id, i);
   }
+
+private:
+  int m_id;
 };
 
 TEST_F(Testlog, Log)
@@ -146,3 +171,154 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, LogFromThreads)
+{
+  CStdString logfile, logstring;
+  char buf[4096];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+
+  LogRunner *runners[LOG_THREADS];
+  CThread *threads[LOG_THREADS];
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < LOG_THREADS; i++)
+  {
+    runners[i] = new LogRunner(i);
+    threads[i] = new CThread(runners[i], "LogRunner");
+    threads[i]->Create();
+  }
+  for (int i = 0; i < LOG_THREADS; i++)
+  {
+    threads[i]->StopThread();
+    delete threads[i];
+    delete runners[i];
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+  RecordProperty("CallsPerSecond", (int)(1000LL * LOG_THREADS * LOG_LINES_PER_THREAD / std::max(elapsed, 1u)));
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  /* every line of every thread is written, in the order it was logged */
+  for (int i = 0; i < LOG_THREADS; i++)
+  {
+    size_t pos = 0;
+    for (int j = 0; j < LOG_LINES_PER_THREAD; j++)
+    {
+      CStdString line;
+      line.Format("runner %d line %d" LINE_ENDING, i, j);
+      pos = logstring.find(line, pos);
+      ASSERT_NE(std::string::npos, pos);
+    }
+  }
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+static CStdString ReadLogFile(const CStdString &logfile)
+{
+  CStdString logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  if (file.Open(logfile))
+  {
+    while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+    {
+      buf[bytesread] = '\0';
+      logstring.append(buf);
+    }
+    file.Close();
+  }
+  return logstring;
+}
+
+TEST_F(Testlog, SetMaxFileSize)
+{
+  CStdString logfile, oldlogfile, firstlogfile, lastlogfile;
+  struct __stat64 info;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  oldlogfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.old.log";
+  firstlogfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log.1";
+  lastlogfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log.2";
+
+  /* a previous session */
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  CLog::Log(LOGDEBUG, "previous session");
+  CLog::Close();
+
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  /* every line is written and checked for rotation on its own */
+  CLog::StopWriter();
+  CLog::Log(LOGDEBUG, "session start");
+  CLog::SetMaxFileSize(1024);
+  for (int i = 0; i < 100; i++)
+    CLog::Log(LOGDEBUG, "line %d", i);
+  CLog::Close();
+
+  /* the log of the previous session is kept */
+  EXPECT_NE(std::string::npos, ReadLogFile(oldlogfile).find("previous session"));
+
+  /* the first full part keeps the start of the session, later ones replace each other */
+  EXPECT_EQ(0, XFILE::CFile::Stat(firstlogfile, &info));
+  EXPECT_LE(1024, info.st_size);
+  EXPECT_NE(std::string::npos, ReadLogFile(firstlogfile).find("session start"));
+  EXPECT_EQ(0, XFILE::CFile::Stat(lastlogfile, &info));
+  EXPECT_LE(1024, info.st_size);
+  EXPECT_EQ(0, XFILE::CFile::Stat(logfile, &info));
+  EXPECT_GT(1024, info.st_size);
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(oldlogfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(firstlogfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(lastlogfile));
+}
+
+TEST_F(Testlog, RotateFailure)
+{
+  CStdString logfile, firstlogdir, lastlogdir, logstring;
+  XFILE::CFile file;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  firstlogdir = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log.1";
+  lastlogdir = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log.2";
+
+  /* directories that aren't empty can't be replaced by the log */
+  EXPECT_TRUE(XFILE::CDirectory::Create(firstlogdir));
+  EXPECT_TRUE(file.OpenForWrite(firstlogdir + "/keep", true));
+  file.Close();
+  EXPECT_TRUE(XFILE::CDirectory::Create(lastlogdir));
+  EXPECT_TRUE(file.OpenForWrite(lastlogdir + "/keep", true));
+  file.Close();
+
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  CLog::StopWriter();
+  CLog::SetMaxFileSize(1024);
+  for (int i = 0; i < 100; i++)
+    CLog::Log(LOGDEBUG, "line %d", i);
+  CLog::Close();
+
+  /* logging goes on in the same file */
+  logstring = ReadLogFile(logfile);
+  EXPECT_NE(std::string::npos, logstring.find("line 0" LINE_ENDING));
+  EXPECT_NE(std::string::npos, logstring.find("unable to move the log"));
+  EXPECT_NE(std::string::npos, logstring.find("line 99" LINE_ENDING));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(firstlogdir + "/keep"));
+  EXPECT_TRUE(XFILE::CDirectory::Remove(firstlogdir));
+  EXPECT_TRUE(XFILE::CFile::Delete(lastlogdir + "/keep"));
+  EXPECT_TRUE(XFILE::CDirectory::Remove(lastlogdir));
+}
@@ -111,6 +111,10 @@ bool CVideoDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE stacktimes (idFile integer, times text)\n");
     m_pDS->exec("CREATE UNIQUE INDEX ix_stacktimes ON stacktimes ( idFile )\n");
 
+    CLog::Log(LOGINFO, "create keyframes table");
+    m_pDS->exec("CREATE TABLE keyframes (idFile integer, keyframes text)\n");
+    m_pDS->exec("CREATE UNIQUE INDEX ix_keyframes ON keyframes ( idFile )\n");
+
     CLog::Log(LOGINFO, "create genre table");
     m_pDS->exec("CREATE TABLE genre ( idGenre integer primary key, strGenre text)\n");
 
@@ -3123,6 +3127,28 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 
   return retVal;
 }
+
+bool CVideoDatabase::GetStreamDetailsForFile(const CStdString& strFileNameAndPath, CStreamDetails& details)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CVideoInfoTag tag;
+    tag.m_iFileId = GetFileId(strFileNameAndPath);
+    if (!GetStreamDetails(tag))
+      return false;
+
+    details = tag.m_streamDetails;
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strFileNameAndPath.c_str());
+  }
+  return false;
+}
  
 bool CVideoDatabase::GetResumePoint(CVideoInfoTag& tag)
 {
@@ -3717,6 +3743,53 @@ void CVideoDatabase::SetStackTimes(const CStdString& filePath, vector<int> &time
   }
 }
 
+/// \brief Gets the keyframe index dvdplayer stored for a file
+bool CVideoDatabase::GetKeyframeIndex(const CStdString &filePath, CStdString &index)
+{
+  try
+  {
+    int idFile = GetFileId(filePath);
+    if (idFile < 0) return false;
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString strSQL=PrepareSQL("select keyframes from keyframes where idFile=%i\n", idFile);
+    m_pDS->query( strSQL.c_str() );
+    if (m_pDS->num_rows() > 0)
+    {
+      index = m_pDS->fv("keyframes").get_asString();
+      m_pDS->close();
+      return !index.IsEmpty();
+    }
+    m_pDS->close();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, filePath.c_str());
+  }
+  return false;
+}
+
+/// \brief Sets the keyframe index of a file
+void CVideoDatabase::SetKeyframeIndex(const CStdString &filePath, const CStdString &index)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return ;
+    if (NULL == m_pDS.get()) return ;
+    int idFile = AddFile(filePath);
+    if (idFile < 0)
+      return;
+
+    m_pDS->exec( PrepareSQL("delete from keyframes where idFile=%i", idFile) );
+    m_pDS->exec( PrepareSQL("insert into keyframes (idFile,keyframes) values (%i,'%s')\n", idFile, index.c_str()) );
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, filePath.c_str());
+  }
+}
+
 void CVideoDatabase::RemoveContentForPath(const CStdString& strPath, CGUIDialogProgress *progress /* = NULL */)
 {
   if(URIUtils::IsMultiPath(strPath))
@@ -4101,6 +4174,11 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     }
     m_pDS->exec("DROP TABLE IF EXISTS setlinkmovie");
   }
+  if (iVersion < 70)
+  {
+    m_pDS->exec("CREATE TABLE keyframes (idFile integer, keyframes text)");
+    m_pDS->exec("CREATE UNIQUE INDEX ix_keyframes ON keyframes ( idFile )");
+  }
   // always recreate the view after any table change
   CreateViews();
   return true;
@@ -7665,6 +7743,10 @@ void CVideoDatabase::CleanDatabase(IVideoInfoScannerObserver* pObserver, const s
       CLog::Log(LOGDEBUG, "%s: Cleaning stacktimes table", __FUNCTION__);
       sql = "delete from stacktimes where idFile in " + filesToDelete;
       m_pDS->exec(sql.c_str());
+
+      CLog::Log(LOGDEBUG, "%s: Cleaning keyframes table", __FUNCTION__);
+      sql = "delete from keyframes where idFile in " + filesToDelete;
+      m_pDS->exec(sql.c_str());
     }
 
     if ( ! moviesToDelete.IsEmpty() )
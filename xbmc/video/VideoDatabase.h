@@ -468,6 +468,8 @@ public:
 
   bool GetStackTimes(const CStdString &filePath, std::vector<int> &times);
   void SetStackTimes(const CStdString &filePath, std::vector<int> &times);
+  bool GetKeyframeIndex(const CStdString &filePath, CStdString &index);
+  void SetKeyframeIndex(const CStdString &filePath, const CStdString &index);
 
   void GetBookMarksForFile(const CStdString& strFilenameAndPath, VECBOOKMARKS& bookmarks, CBookmark::EType type = CBookmark::STANDARD, bool bAppend=false, long partNumber=0);
   void AddBookMarkToFile(const CStdString& strFilenameAndPath, const CBookmark &bookmark, CBookmark::EType type = CBookmark::STANDARD);
@@ -481,6 +483,13 @@ public:
   bool GetResumePoint(CVideoInfoTag& tag);
   bool GetStreamDetails(CVideoInfoTag& tag) const;
 
+  /*! \brief Get the stream details stored for a file
+   \param strFileNameAndPath full path to the file
+   \param details the stream details of the file
+   \return true if the file has stream details in the db.
+   */
+  bool GetStreamDetailsForFile(const CStdString& strFileNameAndPath, CStreamDetails& details);
+
   // scraper settings
   void SetScraperForPath(const CStdString& filePath, const ADDON::ScraperPtr& info, const VIDEO::SScanSettings& settings);
   ADDON::ScraperPtr GetScraperForPath(const CStdString& strPath);
@@ -804,7 +813,7 @@ private:
    */
   bool LookupByFolders(const CStdString &path, bool shows = false);
 
-  virtual int GetMinVersion() const { return 69; };
+  virtual int GetMinVersion() const { return 70; };
   virtual int GetExportVersion() const { return 1; };
   const char *GetBaseDBName() const { return "MyVideos"; };
 
@@ -1771,6 +1771,9 @@ bool CGUIWindowVideoBase::Update(const CStdString &strDirectory)
     return false;
 
   m_thumbLoader.Load(*m_unfilteredItems);
+  int first, last;
+  if (m_viewControl.GetVisibleItems(first, last))
+    m_thumbLoader.Prioritize(*m_vecItems, first, last);
 
   return true;
 }